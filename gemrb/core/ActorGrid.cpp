@@ -0,0 +1,156 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#include "ActorGrid.h"
+
+#include "Scriptable/Actor.h"
+
+#include <algorithm>
+
+namespace GemRB {
+
+constexpr int ActorGrid::CELL_SIZE;
+
+void ActorGrid::Resize(const Size& mapSize)
+{
+	gridSize.w = std::max(1, (mapSize.w + CELL_SIZE - 1) / CELL_SIZE);
+	gridSize.h = std::max(1, (mapSize.h + CELL_SIZE - 1) / CELL_SIZE);
+
+	std::vector<Slot> slots;
+	for (const auto& bucket : buckets) {
+		slots.insert(slots.end(), bucket.begin(), bucket.end());
+	}
+	buckets.clear();
+	buckets.resize(gridSize.Area());
+	// keep the ordering, the sequence numbers are still valid
+	for (const Slot& slot : slots) {
+		size_t bucket = BucketIndex(slot.actor->Pos);
+		buckets[bucket].push_back(slot);
+		entries[slot.actor].bucket = bucket;
+	}
+}
+
+// actors can stray outside the map, those end up in the edge buckets
+size_t ActorGrid::BucketIndex(const Point& p) const
+{
+	int x = Clamp(p.x / CELL_SIZE, 0, gridSize.w - 1);
+	int y = Clamp(p.y / CELL_SIZE, 0, gridSize.h - 1);
+	return y * gridSize.w + x;
+}
+
+void ActorGrid::RemoveFromBucket(size_t bucket, const Movable* actor)
+{
+	std::vector<Slot>& slots = buckets[bucket];
+	for (auto it = slots.begin(); it != slots.end(); ++it) {
+		if (it->actor == actor) {
+			*it = slots.back();
+			slots.pop_back();
+			return;
+		}
+	}
+}
+
+void ActorGrid::Insert(Actor* actor)
+{
+	if (buckets.empty()) {
+		Resize(Size());
+	}
+	if (entries.count(actor)) {
+		Update(actor);
+		return;
+	}
+
+	size_t bucket = BucketIndex(actor->Pos);
+	buckets[bucket].push_back(Slot { actor, nextSeq });
+	entries[actor] = Entry { nextSeq, bucket };
+	nextSeq++;
+	maxCircleSize = std::max(maxCircleSize, actor->circleSize);
+}
+
+void ActorGrid::Remove(const Movable* actor)
+{
+	auto it = entries.find(actor);
+	if (it == entries.end()) return;
+
+	RemoveFromBucket(it->second.bucket, actor);
+	entries.erase(it);
+}
+
+void ActorGrid::Update(const Movable* actor)
+{
+	auto it = entries.find(actor);
+	if (it == entries.end()) return;
+
+	maxCircleSize = std::max(maxCircleSize, actor->circleSize);
+	size_t bucket = BucketIndex(actor->Pos);
+	if (bucket == it->second.bucket) return;
+
+	RemoveFromBucket(it->second.bucket, actor);
+	// the entry is ours, so the const_cast only restores what Insert was given
+	buckets[bucket].push_back(Slot { static_cast<Actor*>(const_cast<Movable*>(actor)), it->second.seq });
+	it->second.bucket = bucket;
+}
+
+void ActorGrid::Clear()
+{
+	for (auto& bucket : buckets) {
+		bucket.clear();
+	}
+	entries.clear();
+	maxCircleSize = 0;
+}
+
+bool ActorGrid::CellRange(const Region& box, Point& minCell, Point& maxCell) const
+{
+	if (buckets.empty()) return false;
+
+	minCell.x = Clamp(box.x / CELL_SIZE, 0, gridSize.w - 1);
+	minCell.y = Clamp(box.y / CELL_SIZE, 0, gridSize.h - 1);
+	maxCell.x = Clamp((box.x + box.w) / CELL_SIZE, 0, gridSize.w - 1);
+	maxCell.y = Clamp((box.y + box.h) / CELL_SIZE, 0, gridSize.h - 1);
+	return true;
+}
+
+void ActorGrid::Query(const Region& box, std::vector<Actor*>& found) const
+{
+	Point minCell;
+	Point maxCell;
+	if (!CellRange(box, minCell, maxCell)) return;
+
+	std::vector<Slot> hits;
+	for (int y = minCell.y; y <= maxCell.y; y++) {
+		for (int x = minCell.x; x <= maxCell.x; x++) {
+			for (const Slot& slot : buckets[y * gridSize.w + x]) {
+				const Point& pos = slot.actor->Pos;
+				if (pos.x < box.x || pos.y < box.y || pos.x > box.x + box.w || pos.y > box.y + box.h) continue;
+				hits.push_back(slot);
+			}
+		}
+	}
+
+	std::sort(hits.begin(), hits.end(), [](const Slot& a, const Slot& b) {
+		return a.seq < b.seq;
+	});
+	for (const Slot& slot : hits) {
+		found.push_back(slot.actor);
+	}
+}
+
+}
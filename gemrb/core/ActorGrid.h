@@ -0,0 +1,104 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef ACTORGRID_H
+#define ACTORGRID_H
+
+#include "exports.h"
+
+#include "Region.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace GemRB {
+
+class Actor;
+class Movable;
+
+// Uniform grid of the actors on a map, bucketed by their position, so the
+// map can answer proximity queries without scanning all of its actors.
+// Every actor also gets a sequence number when inserted, so that query
+// results can be returned in the same order as the map's actor list.
+class GEM_EXPORT ActorGrid {
+public:
+	static constexpr int CELL_SIZE = 128; // in navmap pixels
+
+private:
+	struct Slot {
+		Actor* actor;
+		size_t seq;
+	};
+	struct Entry {
+		size_t seq;
+		size_t bucket;
+	};
+
+	Size gridSize;
+	std::vector<std::vector<Slot>> buckets;
+	std::unordered_map<const Movable*, Entry> entries;
+	size_t nextSeq = 0;
+	int maxCircleSize = 0;
+
+	size_t BucketIndex(const Point& p) const;
+	// the cells overlapping the box, false if there are none
+	bool CellRange(const Region& box, Point& minCell, Point& maxCell) const;
+	void RemoveFromBucket(size_t bucket, const Movable* actor);
+
+public:
+	// sets up the buckets for a map of the given size in navmap pixels
+	void Resize(const Size& mapSize);
+	void Insert(Actor* actor);
+	void Remove(const Movable* actor);
+	// rebuckets the actor if it moved to another cell, ignores unknown ones
+	void Update(const Movable* actor);
+	void Clear();
+
+	// collects the actors whose position is inside the box, in insertion order
+	void Query(const Region& box, std::vector<Actor*>& found) const;
+	// the first actor in insertion order that passes test, out of those in the
+	// cells overlapping the box; test has to check the position itself. Saves
+	// collecting and sorting the candidates when only one is needed
+	template <typename Pred>
+	Actor* FindFirst(const Region& box, Pred test) const
+	{
+		Point minCell;
+		Point maxCell;
+		if (!CellRange(box, minCell, maxCell)) return nullptr;
+
+		const Slot* best = nullptr;
+		for (int y = minCell.y; y <= maxCell.y; y++) {
+			for (int x = minCell.x; x <= maxCell.x; x++) {
+				for (const Slot& slot : buckets[y * gridSize.w + x]) {
+					if (best && slot.seq > best->seq) continue;
+					if (test(slot.actor)) best = &slot;
+				}
+			}
+		}
+		return best ? best->actor : nullptr;
+	}
+	// the largest circle of any indexed actor, used for queries that depend on it
+	int MaxCircleSize() const { return maxCircleSize; }
+	size_t GetActorCount() const { return entries.size(); }
+};
+
+}
+
+#endif
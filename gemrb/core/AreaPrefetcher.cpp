@@ -0,0 +1,288 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#include "AreaPrefetcher.h"
+
+#include "GameData.h"
+#include "Interface.h"
+#include "ResourceDesc.h"
+#include "Logging/Logging.h"
+#include "Streams/MemoryStream.h"
+#include "Strings/StringConversion.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace GemRB {
+
+// the header fields we need, see AREImporter and WEDImporter
+#define ARE_WED_OFFSET 0x08
+#define ARE_ACTORS_OFFSET 0x54
+#define ARE_ACTOR_SIZE 0x110
+#define ARE_ACTOR_FLAGS 0x28
+#define ARE_ACTOR_CRE 0x80
+#define ARE_ACTOR_CREOFFSET 0x88
+#define WED_OVERLAYS_OFFSET 0x08
+#define WED_OVERLAY_SIZE 0x18
+#define WED_OVERLAY_TIS 0x04
+
+static ieDword GetDword(const std::vector<char>& buf, size_t pos)
+{
+	if (pos + 4 > buf.size()) return 0;
+	const unsigned char* p = reinterpret_cast<const unsigned char*>(&buf[pos]);
+	return p[0] | (p[1] << 8) | (p[2] << 16) | (ieDword(p[3]) << 24);
+}
+
+static ieWord GetWord(const std::vector<char>& buf, size_t pos)
+{
+	if (pos + 2 > buf.size()) return 0;
+	const unsigned char* p = reinterpret_cast<const unsigned char*>(&buf[pos]);
+	return ieWord(p[0] | (p[1] << 8));
+}
+
+static ResRef GetResRef(const std::vector<char>& buf, size_t pos)
+{
+	if (pos + 8 > buf.size()) return ResRef();
+	char tmp[9] {};
+	memcpy(tmp, &buf[pos], 8);
+	return ResRef(tmp);
+}
+
+AreaPrefetcher::AreaPrefetcher(size_t budget)
+	: budget(budget)
+{
+	description = "Area prefetcher";
+	worker = std::thread(&AreaPrefetcher::Run, this);
+}
+
+AreaPrefetcher::~AreaPrefetcher()
+{
+	Stop();
+	for (const Entry& entry : entries) {
+		free(entry.data);
+	}
+}
+
+void AreaPrefetcher::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+		queue.clear();
+	}
+	wakeUp.notify_all();
+	if (worker.joinable()) {
+		worker.join();
+	}
+}
+
+void AreaPrefetcher::Prefetch(const std::vector<ResRef>& areas, bool urgent)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (stopping) return;
+		for (const ResRef& area : areas) {
+			if (area.IsEmpty() || std::find(queue.begin(), queue.end(), area) != queue.end()) {
+				continue;
+			}
+			if (urgent) {
+				queue.push_front(area);
+			} else {
+				queue.push_back(area);
+			}
+		}
+	}
+	wakeUp.notify_one();
+}
+
+void AreaPrefetcher::Release(const ResRef& area)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = entries.begin();
+	while (it != entries.end()) {
+		auto next = std::next(it);
+		if (it->area == area) {
+			Drop(it);
+		}
+		it = next;
+	}
+}
+
+void AreaPrefetcher::Run()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		wakeUp.wait(lock, [this]() { return stopping || !queue.empty(); });
+		if (stopping) return;
+
+		ResRef area = queue.front();
+		queue.pop_front();
+		lock.unlock();
+		FetchArea(area);
+		lock.lock();
+	}
+}
+
+void AreaPrefetcher::FetchArea(const ResRef& area)
+{
+	std::vector<char> are;
+	if (!Fetch(area, area, IE_ARE_CLASS_ID, &are)) return;
+
+	size_t bigheader;
+	if (are.size() >= 8 && !strncmp(are.data(), "AREAV1.0", 8)) {
+		bigheader = 0;
+	} else if (are.size() >= 8 && !strncmp(are.data(), "AREAV9.1", 8)) {
+		bigheader = 16;
+	} else {
+		return;
+	}
+
+	// the tile map goes first, it's needed first and is the bulk of the data
+	// only the day versions are read, the night ones are rarely needed
+	ResRef wedRef = GetResRef(are, ARE_WED_OFFSET);
+	std::vector<char> wed;
+	if (Fetch(area, wedRef, IE_WED_CLASS_ID, &wed)) {
+		ieDword overlayCount = GetDword(wed, WED_OVERLAYS_OFFSET);
+		ieDword overlayOffset = GetDword(wed, WED_OVERLAYS_OFFSET + 8);
+		for (ieDword i = 0; i < overlayCount && overlayOffset + i * WED_OVERLAY_SIZE < wed.size(); i++) {
+			Fetch(area, GetResRef(wed, overlayOffset + i * WED_OVERLAY_SIZE + WED_OVERLAY_TIS), IE_TIS_CLASS_ID);
+		}
+	}
+
+	ResRef mapRef;
+	for (const char* suffix : { "LM", "SR", "HT" }) {
+		mapRef.SNPrintF("%.6s%s", wedRef.CString(), suffix);
+		Fetch(area, mapRef, IE_BMP_CLASS_ID);
+	}
+	Fetch(area, wedRef, IE_MOS_CLASS_ID);
+
+	// creatures that aren't embedded in the area
+	ieDword actorOffset = GetDword(are, ARE_ACTORS_OFFSET + bigheader);
+	ieWord actorCount = GetWord(are, ARE_ACTORS_OFFSET + bigheader + 4);
+	for (ieWord i = 0; i < actorCount; i++) {
+		size_t actor = actorOffset + i * ARE_ACTOR_SIZE;
+		if (actor + ARE_ACTOR_SIZE > are.size()) break;
+		if (GetDword(are, actor + ARE_ACTOR_CREOFFSET) && !(GetDword(are, actor + ARE_ACTOR_FLAGS) & 1)) {
+			continue;
+		}
+		Fetch(area, GetResRef(are, actor + ARE_ACTOR_CRE), IE_CRE_CLASS_ID);
+	}
+}
+
+// reads a resource into memory, keeping a copy in keep if asked to
+// returns false if there was nothing to read
+bool AreaPrefetcher::Fetch(const ResRef& area, const ResRef& name, SClass_ID type, std::vector<char>* keep)
+{
+	if (name.IsEmpty()) return false;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (stopping) return false;
+		auto it = Find(name, type);
+		if (it != entries.end()) {
+			if (keep) keep->assign(it->data, it->data + it->size);
+			return true;
+		}
+	}
+
+	// the lookup goes through our own GetResource as well, but we just
+	// checked that we don't have it
+	DataStream* str = gamedata->GetResource(name, type, true);
+	if (!str) return false;
+
+	strpos_t size = str->Size();
+	char* data = static_cast<char*>(malloc(size));
+	strret_t read = str->Read(data, size);
+	delete str;
+	if (read < 0 || strpos_t(read) != size) {
+		free(data);
+		return false;
+	}
+	if (keep) keep->assign(data, data + size);
+
+	// areas can change (they come from the saves), so they're never handed out
+	std::lock_guard<std::mutex> lock(mutex);
+	if (type == IE_ARE_CLASS_ID || size > budget || stopping || Find(name, type) != entries.end()) {
+		free(data);
+		return true;
+	}
+	entries.push_back({ area, name, type, data, size });
+	cachedBytes += size;
+	while (cachedBytes > budget) {
+		Drop(entries.begin());
+	}
+	return true;
+}
+
+std::list<AreaPrefetcher::Entry>::iterator AreaPrefetcher::Find(const ResRef& name, SClass_ID type)
+{
+	return std::find_if(entries.begin(), entries.end(), [&](const Entry& entry) {
+		return entry.type == type && entry.name == name;
+	});
+}
+
+void AreaPrefetcher::Drop(std::list<Entry>::iterator entry)
+{
+	cachedBytes -= entry->size;
+	free(entry->data);
+	entries.erase(entry);
+}
+
+bool AreaPrefetcher::Open(const char*, const char*)
+{
+	return true;
+}
+
+bool AreaPrefetcher::HasResource(const char* resname, SClass_ID type)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return Find(resname, type) != entries.end();
+}
+
+bool AreaPrefetcher::HasResource(const char* resname, const ResourceDesc& type)
+{
+	return HasResource(resname, type.GetKeyType());
+}
+
+DataStream* AreaPrefetcher::GetResource(const char* resname, SClass_ID type)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (entries.empty()) return nullptr;
+
+	auto it = Find(resname, type);
+	if (it == entries.end()) return nullptr;
+
+	std::string filename = fmt::format("{}.{}", it->name, core->TypeExt(type));
+	StringToLower(filename);
+	DataStream* str = new MemoryStream(filename.c_str(), it->data, it->size);
+	// the stream owns the data now
+	cachedBytes -= it->size;
+	entries.erase(it);
+	served++;
+	return str;
+}
+
+DataStream* AreaPrefetcher::GetResource(const char* resname, const ResourceDesc& type)
+{
+	return GetResource(resname, type.GetKeyType());
+}
+
+}
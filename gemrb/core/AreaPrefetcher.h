@@ -0,0 +1,100 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef AREAPREFETCHER_H
+#define AREAPREFETCHER_H
+
+#include "exports.h"
+
+#include "Resource.h"
+#include "ResourceSource.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace GemRB {
+
+/**
+ * @class AreaPrefetcher
+ * Reads the bulky resources of areas (WED, TIS, the light, search and height
+ * maps, the minimap and the creatures) on a background thread, so loading
+ * the area later only has to parse them. It sits first in the search path
+ * and hands each prefetched resource out once. Only resources that don't
+ * change while playing are kept, so the ARE itself is always read anew.
+ */
+
+class GEM_EXPORT AreaPrefetcher : public ResourceSource {
+private:
+	struct Entry {
+		ResRef area;
+		ResRef name;
+		SClass_ID type;
+		char* data;
+		size_t size;
+	};
+
+	// oldest first, this is also the eviction order
+	std::list<Entry> entries;
+	size_t cachedBytes = 0;
+	size_t budget;
+	std::deque<ResRef> queue;
+
+	std::mutex mutex;
+	std::condition_variable wakeUp;
+	bool stopping = false;
+	std::thread worker;
+	std::atomic<unsigned int> served { 0 };
+
+	void Run();
+	void FetchArea(const ResRef& area);
+	bool Fetch(const ResRef& area, const ResRef& name, SClass_ID type, std::vector<char>* keep = nullptr);
+	std::list<Entry>::iterator Find(const ResRef& name, SClass_ID type);
+	void Drop(std::list<Entry>::iterator entry);
+
+public:
+	explicit AreaPrefetcher(size_t budget);
+	AreaPrefetcher(const AreaPrefetcher&) = delete;
+	~AreaPrefetcher() override;
+	AreaPrefetcher& operator=(const AreaPrefetcher&) = delete;
+
+	/** Queues areas for reading, urgent ones go before anything waiting */
+	void Prefetch(const std::vector<ResRef>& areas, bool urgent = false);
+	/** Drops everything still kept for an area */
+	void Release(const ResRef& area);
+	/** Finishes the current area and ends the worker, nothing is read after this */
+	void Stop();
+	/** How many resources were handed out so far */
+	unsigned int GetServedCount() const { return served; }
+
+	bool Open(const char* filename, const char* description) override;
+	bool HasResource(const char* resname, SClass_ID type) override;
+	bool HasResource(const char* resname, const ResourceDesc& type) override;
+	DataStream* GetResource(const char* resname, SClass_ID type) override;
+	DataStream* GetResource(const char* resname, const ResourceDesc& type) override;
+};
+
+}
+
+#endif
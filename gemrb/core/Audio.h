@@ -21,6 +21,7 @@
 #ifndef AUDIO_H_INCLUDED
 #define AUDIO_H_INCLUDED
 
+#include <string>
 #include <vector>
 
 #include "globals.h"
@@ -124,6 +125,8 @@ public:
 	virtual void QueueBuffer(int stream, unsigned short bits,
 				int channels, short* memory, int size, int samplerate) = 0;
 	virtual void UpdateMapAmbient(MapReverb&) {};
+	/** Starts decoding sounds likely to be played soon in the background, most likely first */
+	virtual void Preload(const std::vector<std::string>& /*sounds*/) {};
 
 	unsigned int CreateChannel(const char *name);
 	void SetChannelVolume(const char *name, int volume);
@@ -80,7 +80,7 @@ static EffectDesc* FindEffect(const char* effectname)
 /** The available effects should already be registered by the effect plugins */
 
 struct Globals {
-	static constexpr int MAX_EFFECTS = 512;
+	static constexpr int MAX_EFFECTS = EffectQueue::MAX_OPCODES;
 	EffectDesc Opcodes[MAX_EFFECTS];
 	
 	int pstflags = false;
@@ -423,6 +423,7 @@ Effect *EffectQueue::CreateUnsummonEffect(const Effect *fx)
 
 void EffectQueue::AddEffect(Effect* fx, bool insert)
 {
+	IndexOpcode(fx->Opcode);
 	if (insert) {
 		effects.push_front(std::move(*fx));
 	} else {
@@ -437,6 +438,7 @@ bool EffectQueue::RemoveEffect(const Effect* fx)
 {
 	for (auto f = effects.begin(); f != effects.end(); ++f) {
 		if (*fx == *f) {
+			UnindexOpcode(f->Opcode);
 			effects.erase(f);
 			return true;
 		}
@@ -452,12 +454,18 @@ void EffectQueue::ApplyAllEffects(Actor* target)
 	const auto& Opcodes = Globals::Get().Opcodes;
 
 	for (auto& fx : effects) {
+		ieDword opcode = fx.Opcode;
 		if (Opcodes[fx.Opcode].Flags & EFFECT_REINIT_ON_LOAD) {
 			// pretend to be the first application (FirstApply==1)
 			ApplyEffect(target, &fx, 1);
 		} else {
 			ApplyEffect(target, &fx, 0);
 		}
+		// a few effects turn into another opcode when applied
+		if (fx.Opcode != opcode) {
+			UnindexOpcode(opcode);
+			IndexOpcode(fx.Opcode);
+		}
 	}
 }
 
@@ -465,6 +473,7 @@ void EffectQueue::Cleanup()
 {
 	for (auto f = effects.begin(); f != effects.end(); ) {
 		if (f->TimingMode == FX_DURATION_JUST_EXPIRED) {
+			UnindexOpcode(f->Opcode);
 			f = effects.erase(f);
 		} else {
 			++f;
@@ -1312,6 +1321,7 @@ static inline bool IsLive(ieByte timingmode)
 //will be killed along with it
 void EffectQueue::RemoveAllEffects(ieDword opcode)
 {
+	if (!MayHaveOpcode(opcode)) return;
 	for (auto& fx : effects) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
@@ -1423,6 +1433,7 @@ void EffectQueue::RemoveAllEffects(EffectRef &effect_reference)
 //Removes all effects with a matching resource field
 void EffectQueue::RemoveAllEffectsWithResource(ieDword opcode, const ResRef &resource)
 {
+	if (!MayHaveOpcode(opcode)) return;
 	for (auto& fx : effects) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
@@ -1442,6 +1453,7 @@ void EffectQueue::RemoveAllEffectsWithResource(EffectRef &effect_reference, cons
 //Removes all effects with a matching resource field
 void EffectQueue::RemoveAllEffectsWithSource(ieDword opcode, const ResRef &source, int mode)
 {
+	if (!MayHaveOpcode(opcode)) return;
 	for (auto& fx : effects) {
 		MATCH_OPCODE()
 		if (fx.SourceRef != source) continue;
@@ -1473,6 +1485,7 @@ void EffectQueue::RemoveAllEffectsWithSource(EffectRef &effectReference, const R
 //(works only if a higher stat means good for the target)
 void EffectQueue::RemoveAllDetrimentalEffects(ieDword opcode, ieDword current)
 {
+	if (!MayHaveOpcode(opcode)) return;
 	for (auto& fx : effects) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
@@ -1507,6 +1520,7 @@ void EffectQueue::RemoveAllDetrimentalEffects(EffectRef &effect_reference, ieDwo
 //opcode need to be removed (see removal of portrait icon)
 void EffectQueue::RemoveAllEffectsWithParam(ieDword opcode, ieDword param2)
 {
+	if (!MayHaveOpcode(opcode)) return;
 	for (auto& fx : effects) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
@@ -1526,6 +1540,7 @@ void EffectQueue::RemoveAllEffectsWithParam(EffectRef &effect_reference, ieDword
 //Removes all effects with a matching resource field
 void EffectQueue::RemoveAllEffectsWithParamAndResource(ieDword opcode, ieDword param2, const ResRef &resource)
 {
+	if (!MayHaveOpcode(opcode)) return;
 	for (auto& fx : effects) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
@@ -1639,6 +1654,7 @@ void EffectQueue::DispelEffects(const Effect *dispeller, ieDword level)
 
 const Effect *EffectQueue::HasOpcode(ieDword opcode) const
 {
+	if (!MayHaveOpcode(opcode)) return nullptr;
 	for (const auto& fx : effects) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
@@ -1659,6 +1675,7 @@ const Effect *EffectQueue::HasEffect(EffectRef &effect_reference) const
 
 Effect *EffectQueue::HasOpcode(ieDword opcode)
 {
+	if (!MayHaveOpcode(opcode)) return nullptr;
 	for (auto& fx : effects) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
@@ -1679,6 +1696,7 @@ Effect *EffectQueue::HasEffect(EffectRef &effect_reference)
 
 const Effect *EffectQueue::HasOpcodeWithParam(ieDword opcode, ieDword param2) const
 {
+	if (!MayHaveOpcode(opcode)) return nullptr;
 	for (auto& fx : effects) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
@@ -1704,6 +1722,7 @@ const Effect *EffectQueue::HasEffectWithParam(EffectRef &effect_reference, ieDwo
 
 const Effect *EffectQueue::HasOpcodeWithParamPair(ieDword opcode, ieDword param1, ieDword param2) const
 {
+	if (!MayHaveOpcode(opcode)) return nullptr;
 	for (auto& fx : effects) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
@@ -1731,6 +1750,7 @@ const Effect *EffectQueue::HasEffectWithParamPair(EffectRef &effect_reference, i
 //this could be used for stoneskins and mirror images as well
 void EffectQueue::DecreaseParam1OfEffect(ieDword opcode, ieDword amount)
 {
+	if (!MayHaveOpcode(opcode)) return;
 	for (auto& fx : effects) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
@@ -1762,6 +1782,7 @@ void EffectQueue::DecreaseParam1OfEffect(EffectRef &effect_reference, ieDword am
 //returns the damage amount NOT soaked
 int EffectQueue::DecreaseParam3OfEffect(ieDword opcode, ieDword amount, ieDword param2)
 {
+	if (!MayHaveOpcode(opcode)) return amount;
 	for (auto& fx : effects) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
@@ -1800,6 +1821,7 @@ static const int ids_stats[9]={IE_FACTION, IE_TEAM, IE_EA, IE_GENERAL, IE_RACE,
 //0,1 and 9 are only in GemRB
 int EffectQueue::BonusAgainstCreature(ieDword opcode, const Actor *actor) const
 {
+	if (!MayHaveOpcode(opcode)) return 0;
 	ieDword sum = 0;
 	for (const auto& fx : effects) {
 		MATCH_OPCODE()
@@ -1852,6 +1874,7 @@ int EffectQueue::BonusAgainstCreature(EffectRef &effect_reference, const Actor *
 
 int EffectQueue::BonusForParam2(ieDword opcode, ieDword param2) const
 {
+	if (!MayHaveOpcode(opcode)) return 0;
 	int sum = 0;
 	for (const auto& fx : effects) {
 		MATCH_OPCODE()
@@ -1873,6 +1896,7 @@ int EffectQueue::BonusForParam2(EffectRef &effect_reference, ieDword param2) con
 
 int EffectQueue::MaxParam1(ieDword opcode, bool positive) const
 {
+	if (!MayHaveOpcode(opcode)) return 0;
 	int max = 0;
 	ieDwordSigned param1 = 0;
 	for (const auto& fx : effects) {
@@ -1898,6 +1922,7 @@ int EffectQueue::MaxParam1(EffectRef &effect_reference, bool positive) const
 
 bool EffectQueue::WeaponImmunity(ieDword opcode, int enchantment, ieDword weapontype) const
 {
+	if (!MayHaveOpcode(opcode)) return false;
 	for (const auto& fx : effects) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
@@ -1936,6 +1961,7 @@ void EffectQueue::AddWeaponEffects(EffectQueue* fxqueue, EffectRef& fx_ref, ieDw
 	}
 
 	ieDword opcode = fx_ref.opcode;
+	if (!MayHaveOpcode(opcode)) return;
 	Point p(-1,-1);
 
 	for (const auto& fx : effects) {
@@ -1955,6 +1981,7 @@ int EffectQueue::SumDamageReduction(EffectRef &effect_reference, ieDword weaponE
 {
 	Globals::ResolveEffectRef(effect_reference);
 	ieDword opcode = effect_reference.opcode;
+	if (!MayHaveOpcode(opcode)) return -1;
 	int remaining = 0;
 	int count = 0;
 
@@ -1979,6 +2006,7 @@ int EffectQueue::SumDamageReduction(EffectRef &effect_reference, ieDword weaponE
 //useful for immunity vs spell, can't use item, etc.
 const Effect *EffectQueue::HasOpcodeWithResource(ieDword opcode, const ResRef &resource) const
 {
+	if (!MayHaveOpcode(opcode)) return nullptr;
 	for (auto& fx : effects) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
@@ -2004,6 +2032,7 @@ const Effect *EffectQueue::HasEffectWithPower(EffectRef &effect_reference, ieDwo
 
 const Effect *EffectQueue::HasOpcodeWithPower(ieDword opcode, ieDword power) const
 {
+	if (!MayHaveOpcode(opcode)) return nullptr;
 	for (const auto& fx : effects) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
@@ -2032,6 +2061,7 @@ const Effect *EffectQueue::HasSource(const ResRef &removed) const
 //used in contingency/sequencer code (cannot have the same contingency twice)
 const Effect *EffectQueue::HasOpcodeWithSource(ieDword opcode, const ResRef &removed) const
 {
+	if (!MayHaveOpcode(opcode)) return nullptr;
 	for (auto& fx : effects) {
 		MATCH_OPCODE()
 		MATCH_LIVE_FX()
@@ -2116,6 +2146,7 @@ Effect *EffectQueue::GetNextEffect(queue_t::iterator &f)
 
 ieDword EffectQueue::CountEffects(ieDword opcode, ieDword param1, ieDword param2, const ResRef &resource) const
 {
+	if (!MayHaveOpcode(opcode)) return 0;
 	ieDword cnt = 0;
 
 	for (const auto& fx : effects) {
@@ -2146,6 +2177,7 @@ unsigned int EffectQueue::GetEffectOrder(EffectRef& effect_reference, const Effe
 
 void EffectQueue::ModifyEffectPoint(ieDword opcode, ieDword x, ieDword y)
 {
+	if (!MayHaveOpcode(opcode)) return;
 	for (auto& fx : effects) {
 		MATCH_OPCODE()
 		fx.Pos = Point(x, y);
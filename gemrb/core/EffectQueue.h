@@ -35,6 +35,7 @@
 
 #include "Logging/Logging.h"
 
+#include <array>
 #include <cstdlib>
 #include <list>
 
@@ -213,13 +214,36 @@ bool IsColorslotEffect(int opcode);
  */
 
 class GEM_EXPORT EffectQueue {
+public:
+	/** opcodes are limited to this by effects.ids handling */
+	static constexpr ieDword MAX_OPCODES = 512;
+
 private:
-	/** List of Effects applied on the Actor */
+	/** List of Effects applied on the Actor
+	 *  Effects keep being added while the queue is walked (and pointers
+	 *  to them are held), so this needs the stability of a list. */
 	using queue_t = std::list<Effect>;
 	queue_t effects;
+	/** How many effects of each opcode are queued (live or not), so that
+	 *  the lookups for opcodes that aren't present can skip the walk. */
+	std::array<ieWord, MAX_OPCODES> opcodeCounts {};
 	/** Actor which is target of the Effects */
 	Scriptable* Owner = nullptr;
 
+	void IndexOpcode(ieDword opcode)
+	{
+		if (opcode < MAX_OPCODES) opcodeCounts[opcode]++;
+	}
+	void UnindexOpcode(ieDword opcode)
+	{
+		if (opcode < MAX_OPCODES && opcodeCounts[opcode]) opcodeCounts[opcode]--;
+	}
+	// out of range opcodes are not indexed, so they always need the walk
+	bool MayHaveOpcode(ieDword opcode) const
+	{
+		return opcode >= MAX_OPCODES || opcodeCounts[opcode];
+	}
+
 public:
 	EffectQueue() noexcept {};
 	
@@ -0,0 +1,245 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#include "FrameProfiler.h"
+
+#include "Logging/Logging.h"
+#include "Streams/FileStream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace GemRB {
+
+bool FrameProfiler::enabled = false;
+// std::min takes it by reference, so it needs a definition
+const int FrameProfiler::FRAME_HISTORY;
+
+namespace {
+
+struct Event {
+	FrameProfiler::Clock::time_point start;
+	FrameProfiler::Clock::duration length;
+	FrameProfiler::Section section;
+	uint8_t depth;
+};
+
+const char* const sectionNames[FrameProfiler::SectionCount] = {
+	"GameLoop", "Scripts", "Fog", "DrawMap", "DrawWindows", "Pathfinding", "Python"
+};
+
+std::thread::id mainThread;
+int budgetMS = 0;
+
+FrameProfiler::Frame frames[FrameProfiler::FRAME_HISTORY];
+// the count of finished frames, the next one goes to frameCount % FRAME_HISTORY
+int frameCount = 0;
+FrameProfiler::Frame current;
+FrameProfiler::Frame total;
+bool frameOpen = false;
+
+// a ring as well, allocated on first use
+std::vector<Event> events;
+size_t eventCount = 0;
+uint8_t depth = 0;
+
+double ToMS(FrameProfiler::Clock::duration time)
+{
+	return std::chrono::duration<double, std::milli>(time).count();
+}
+
+void LogOverBudget(const FrameProfiler::Frame& frame)
+{
+	std::string breakdown;
+	for (int i = 0; i < FrameProfiler::SectionCount; i++) {
+		if (!frame.calls[i]) continue;
+		if (!breakdown.empty()) breakdown += ", ";
+		breakdown += fmt::format("{} {:.2f}ms", sectionNames[i], ToMS(frame.sections[i]));
+		if (frame.calls[i] > 1) {
+			breakdown += fmt::format(" ({}x)", frame.calls[i]);
+		}
+	}
+	Log(WARNING, "FrameProfiler", "Frame took {:.2f}ms, over the {}ms budget: {}",
+		ToMS(frame.length), budgetMS, breakdown);
+}
+
+}
+
+FrameProfiler::Scope::Scope(Section section)
+	: section(section), active(enabled && std::this_thread::get_id() == mainThread)
+{
+	if (!active) return;
+	depth++;
+	start = Clock::now();
+}
+
+FrameProfiler::Scope::~Scope()
+{
+	// also covers being disabled while running
+	if (!active || !enabled) return;
+
+	Clock::duration length = Clock::now() - start;
+	if (depth) depth--;
+	current.sections[section] += length;
+	current.calls[section]++;
+	events[eventCount % EVENT_HISTORY] = { start, length, section, depth };
+	eventCount++;
+}
+
+void FrameProfiler::Enable(bool enable)
+{
+	if (enable && !enabled) {
+		mainThread = std::this_thread::get_id();
+		events.resize(EVENT_HISTORY);
+		eventCount = 0;
+		frameCount = 0;
+		total = Frame();
+		frameOpen = false;
+		depth = 0;
+	}
+	enabled = enable;
+}
+
+void FrameProfiler::SetBudget(int ms)
+{
+	budgetMS = std::max(ms, 0);
+}
+
+void FrameProfiler::NextFrame()
+{
+	if (!enabled) return;
+
+	Clock::time_point now = Clock::now();
+	if (frameOpen) {
+		current.length = now - current.start;
+		frames[frameCount % FRAME_HISTORY] = current;
+		frameCount++;
+		total.length += current.length;
+		for (int s = 0; s < SectionCount; s++) {
+			total.sections[s] += current.sections[s];
+			total.calls[s] += current.calls[s];
+		}
+		if (budgetMS && current.length > std::chrono::milliseconds(budgetMS)) {
+			LogOverBudget(current);
+		}
+	}
+	current = Frame();
+	current.start = now;
+	frameOpen = true;
+}
+
+const char* FrameProfiler::GetSectionName(Section section)
+{
+	return section < SectionCount ? sectionNames[section] : "";
+}
+
+const FrameProfiler::Frame* FrameProfiler::GetFrame(int i)
+{
+	if (i < 0 || i >= std::min(frameCount, FRAME_HISTORY)) {
+		return nullptr;
+	}
+	return &frames[(frameCount - 1 - i) % FRAME_HISTORY];
+}
+
+FrameProfiler::Frame FrameProfiler::GetAverage(int count)
+{
+	Frame average;
+	count = std::min(count, std::min(frameCount, FRAME_HISTORY));
+	if (count <= 0) return average;
+
+	for (int i = 0; i < count; i++) {
+		const Frame* frame = GetFrame(i);
+		average.length += frame->length;
+		for (int s = 0; s < SectionCount; s++) {
+			average.sections[s] += frame->sections[s];
+			average.calls[s] += frame->calls[s];
+		}
+	}
+	average.start = GetFrame(count - 1)->start;
+	average.length /= count;
+	for (int s = 0; s < SectionCount; s++) {
+		average.sections[s] /= count;
+		average.calls[s] /= count;
+	}
+	return average;
+}
+
+const FrameProfiler::Frame& FrameProfiler::GetTotal()
+{
+	return total;
+}
+
+int FrameProfiler::GetFrameCount()
+{
+	return frameCount;
+}
+
+bool FrameProfiler::ExportTrace(const char* path)
+{
+	int kept = std::min(frameCount, FRAME_HISTORY);
+	if (!kept) {
+		Log(WARNING, "FrameProfiler", "No frames recorded, nothing to export.");
+		return false;
+	}
+
+	FileStream fs;
+	if (!fs.Create(path)) {
+		Log(ERROR, "FrameProfiler", "Cannot create {}.", path);
+		return false;
+	}
+
+	Clock::time_point origin = GetFrame(kept - 1)->start;
+	auto micros = [origin](Clock::time_point time) {
+		return std::chrono::duration<double, std::micro>(time - origin).count();
+	};
+	const char* separator = "";
+	auto write = [&fs, &separator](const std::string& entry) {
+		fs.Write(separator, strlen(separator));
+		fs.Write(entry.c_str(), entry.size());
+		separator = ",\n";
+	};
+
+	std::string header = "{\"traceEvents\":[\n";
+	fs.Write(header.c_str(), header.size());
+	for (int i = kept - 1; i >= 0; i--) {
+		const Frame* frame = GetFrame(i);
+		write(fmt::format("{{\"name\":\"Frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":{:.3f},\"dur\":{:.3f}}}",
+			micros(frame->start), std::chrono::duration<double, std::micro>(frame->length).count()));
+	}
+	// the oldest events may already be gone, they're also skipped if they predate the kept frames
+	size_t first = eventCount > size_t(EVENT_HISTORY) ? eventCount - EVENT_HISTORY : 0;
+	for (size_t i = first; i < eventCount; i++) {
+		const Event& event = events[i % EVENT_HISTORY];
+		if (event.start < origin) continue;
+		write(fmt::format("{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":{:.3f},\"dur\":{:.3f},\"args\":{{\"depth\":{}}}}}",
+			sectionNames[event.section], micros(event.start),
+			std::chrono::duration<double, std::micro>(event.length).count(), event.depth));
+	}
+	std::string footer = "\n]}\n";
+	fs.Write(footer.c_str(), footer.size());
+
+	Log(MESSAGE, "FrameProfiler", "Wrote {} frames to {}.", kept, path);
+	return true;
+}
+
+}
@@ -0,0 +1,107 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef FRAMEPROFILER_H
+#define FRAMEPROFILER_H
+
+#include "config.h"
+#include "exports.h"
+
+#include <chrono>
+#include <cstdint>
+
+namespace GemRB {
+
+// Times the big parts of every frame on the main thread. The last frames
+// are kept for the overlay and the trace export, and frames going over the
+// budget are logged with their breakdown. Instrument code with
+// PROFILE_SCOPE(Section), which compiles to nothing without USE_PROFILER and
+// costs a flag check while the profiler is disabled.
+class GEM_EXPORT FrameProfiler {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	enum Section : uint8_t {
+		GameLoop,
+		Scripts,
+		Fog,
+		DrawMap,
+		DrawWindows,
+		Pathfinding,
+		Python,
+		SectionCount
+	};
+
+	static const int FRAME_HISTORY = 256;
+	static const int EVENT_HISTORY = 1 << 16;
+
+	struct Frame {
+		Clock::time_point start;
+		Clock::duration length {};
+		// inclusive times, so nested sections are counted in their parents too
+		Clock::duration sections[SectionCount] {};
+		uint32_t calls[SectionCount] {};
+	};
+
+	class Scope {
+		Section section;
+		Clock::time_point start;
+		bool active;
+
+	public:
+		explicit Scope(Section section);
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+		~Scope();
+	};
+
+	static bool IsEnabled() { return enabled; }
+	static void Enable(bool enable);
+	// frames longer than this are logged, 0 disables the check
+	static void SetBudget(int ms);
+	// closes the current frame and opens the next one
+	static void NextFrame();
+
+	static const char* GetSectionName(Section section);
+	// i = 0 is the last finished frame, returns nullptr past the kept ones
+	static const Frame* GetFrame(int i);
+	// average of the last count finished frames
+	static Frame GetAverage(int count);
+	// the sum of all the frames finished since enabling and their count
+	static const Frame& GetTotal();
+	static int GetFrameCount();
+	// writes the kept frames in the Chrome trace event format (chrome://tracing)
+	static bool ExportTrace(const char* path);
+
+private:
+	static bool enabled;
+};
+
+#ifdef USE_PROFILER
+#define PROFILE_SCOPE_NAME2(line) profileScope ## line
+#define PROFILE_SCOPE_NAME(line) PROFILE_SCOPE_NAME2(line)
+#define PROFILE_SCOPE(section) FrameProfiler::Scope PROFILE_SCOPE_NAME(__LINE__)(FrameProfiler::section)
+#else
+#define PROFILE_SCOPE(section)
+#endif
+
+}
+
+#endif
@@ -42,13 +42,28 @@ Label::Label(const Region& frame, Font* font, const String& string)
 /** Draws the Control on the Output Display */
 void Label::DrawSelf(const Region& rgn, const Region& /*clip*/)
 {
-	if (font && Text.length()) {
+	if (!font || !Text.length()) return;
+
+	if (core->InDebugMode(ID_FONTS)) {
+		// Print draws the layout helpers
 		if (flags & UseColor) {
 			font->Print(rgn, Text, Alignment, colors);
 		} else {
 			font->Print(rgn, Text, Alignment);
 		}
+		return;
+	}
+
+	if (!layoutValid) {
+		layout = font->LayoutText(rgn.size, Text, Alignment);
+		layoutValid = true;
 	}
+	font->DrawRun(layout, rgn.origin, (flags & UseColor) ? &colors : nullptr);
+}
+
+void Label::SizeChanged(const Size& /*oldSize*/)
+{
+	layoutValid = false;
 }
 /** This function sets the actual Label Text */
 void Label::SetText(String string)
@@ -58,6 +73,7 @@ void Label::SetText(String string)
 		&& core->HasFeature( GF_LOWER_LABEL_TEXT )) {
 		StringToLower(Text);
 	}
+	layoutValid = false;
 	MarkDirty();
 }
 
@@ -80,6 +96,7 @@ void Label::SetAlignment(unsigned char newAlignment)
 	if (newAlignment == IE_FONT_ALIGN_CENTER && core->HasFeature(GF_LOWER_LABEL_TEXT)) {
 		StringToLower(Text);
 	}
+	layoutValid = false;
 	MarkDirty();
 }
 
@@ -47,6 +47,7 @@ class GEM_EXPORT Label : public Control {
 private:
 	/** Draws the Control on the Output Display */
 	void DrawSelf(const Region& drawFrame, const Region& clip) override;
+	void SizeChanged(const Size& oldSize) override;
 
 public:
 	enum LabelFlags {
@@ -60,7 +61,7 @@ public:
 	/** Sets the Foreground Font Color */
 	void SetColors(const Color& col, const Color& bg);
 	/** Set the font being used */
-	void SetFont(Font* newFont) { font = newFont; }
+	void SetFont(Font* newFont) { font = newFont; layoutValid = false; }
 	/** Sets the Alignment of Text */
 	void SetAlignment(unsigned char newAlignment);
 	/** Simply returns the pointer to the text, don't modify it! */
@@ -72,6 +73,9 @@ private: // Private attributes
 	/** Font for Text Writing */
 	Font* font;
 	Font::PrintColors colors;
+	/** The laid out Text, kept until anything it depends on changes */
+	Font::GlyphRun layout;
+	bool layoutValid = false;
 
 	/** Alignment Variable */
 	unsigned char Alignment;
@@ -29,6 +29,7 @@
 #include <cwctype>
 #include <utility>
 
+#define MAX_CACHED_RUNS 1024
 
 namespace GemRB {
 
@@ -253,7 +254,7 @@ const Glyph& Font::GetGlyph(ieWord chr) const
 }
 
 size_t Font::RenderText(const String& string, Region& rgn, ieByte alignment, const PrintColors* colors,
-						Point* point, ieByte** canvas, bool grow) const
+						Point* point, ieByte** canvas, bool grow, GlyphRun* run) const
 {
 	// NOTE: vertical alignment is not handled here.
 	// it should have been calculated previously and passed in via the "point" parameter
@@ -317,7 +318,8 @@ size_t Font::RenderText(const String& string, Region& rgn, ieByte alignment, con
 			// check to see if the line is on screen
 			// TODO: technically we could be *even more* optimized by passing lineRgn, but this breaks dropcaps
 			// this isn't a big deal ATM, because the big text containers do line-by-line layout
-			if (!sclip.IntersectsRegion(rgn)) {
+			// runs are drawn later and wherever, so they always need the whole layout
+			if (!run && !sclip.IntersectsRegion(rgn)) {
 				// offscreen, optimize by bypassing RenderLine, we pre-calculated linePos above
 				// alignment is completely irrelevant here since the width is the same for all alignments
 				linePoint.x = lineSize.w;
@@ -350,12 +352,12 @@ size_t Font::RenderText(const String& string, Region& rgn, ieByte alignment, con
 						linePoint.x /= 2;
 					}
 				}
-				if (core->InDebugMode(ID_FONTS)) {
+				if (!run && core->InDebugMode(ID_FONTS)) {
 					core->GetVideoDriver()->DrawRect(lineRgn, ColorGreen, false);
 					core->GetVideoDriver()->DrawRect(Region(linePoint + lineRgn.origin,
 												 Size(lineSize.w, LineHeight)), ColorWhite, false);
 				}
-				linePos = RenderLine(line, lineRgn, linePoint, colors, canvas);
+				linePos = RenderLine(line, lineRgn, linePoint, colors, canvas, run);
 			}
 			if (linePos == 0) {
 				break; // if linePos == 0 then we would loop till we are out of bounds so just stop here
@@ -408,7 +410,7 @@ size_t Font::RenderText(const String& string, Region& rgn, ieByte alignment, con
 }
 
 size_t Font::RenderLine(const String& line, const Region& lineRgn,
-						Point& dp, const PrintColors* colors, ieByte** canvas) const
+						Point& dp, const PrintColors* colors, ieByte** canvas, GlyphRun* run) const
 {
 	assert(lineRgn.h == LineHeight);
 
@@ -462,7 +464,7 @@ size_t Font::RenderLine(const String& line, const Region& lineRgn,
 			Point blitPoint = dp + lineRgn.origin + curGlyph.pos;
 			// use intersection because some rare glyphs can sometimes overlap lines
 			if (!lineRgn.IntersectsRegion(Region(blitPoint, curGlyph.size))) {
-				if (core->InDebugMode(ID_FONTS)) {
+				if (!run && core->InDebugMode(ID_FONTS)) {
 					core->GetVideoDriver()->DrawRect(lineRgn, ColorRed, false);
 				}
 				assert(metrics.forceBreak == false || dp.x > 0);
@@ -470,7 +472,15 @@ size_t Font::RenderLine(const String& line, const Region& lineRgn,
 				break;
 			}
 
-			if (canvas) {
+			if (run) {
+				Region glyphRgn(blitPoint, curGlyph.size);
+				if (run->glyphs.empty()) {
+					run->bounds = glyphRgn;
+				} else {
+					run->bounds.ExpandToRegion(glyphRgn);
+				}
+				run->glyphs.push_back({ static_cast<ieWord>(currChar), blitPoint, curGlyph.size });
+			} else if (canvas) {
 				BlitGlyphToCanvas(curGlyph, blitPoint, *canvas, lineRgn.size);
 			} else {
 				size_t pageIdx = AtlasIndex[currChar].pageIdx;
@@ -572,11 +582,8 @@ size_t Font::Print(const Region& rgn, const String& string, ieByte alignment, co
 	return Print(rgn, string, alignment, &colors, point);
 }
 
-size_t Font::Print(Region rgn, const String& string, ieByte alignment, const PrintColors* colors, Point* point) const
+Point Font::AlignedStart(const Size& size, const String& string, ieByte alignment, Point p) const
 {
-	if (rgn.size.IsInvalid()) return 0;
-
-	Point p = point ? *point : Point();
 	if (alignment&(IE_FONT_ALIGN_MIDDLE|IE_FONT_ALIGN_BOTTOM)) {
 		// we assume that point will be an offset from midde/bottom position
 		Size stringSize;
@@ -584,24 +591,92 @@ size_t Font::Print(Region rgn, const String& string, ieByte alignment, const Pri
 			// we can optimize single lines without StringSize()
 			stringSize.h = LineHeight;
 		} else {
-			stringSize = rgn.size;
+			stringSize = size;
 			StringSizeMetrics metrics = {stringSize, 0, 0, true};
 			stringSize = StringSize(string, &metrics);
 			if (alignment&IE_FONT_NO_CALC && metrics.numChars < string.length()) {
 				// PST GUISTORE, not sure what else
-				stringSize.h = rgn.h;
+				stringSize.h = size.h;
 			}
 		}
 
 		// important: we must do this adjustment even if it leads to -p.y!
 		// some labels depend on this behavior (BG2 GUIINV) :/
 		if (alignment&IE_FONT_ALIGN_MIDDLE) {
-			p.y += (rgn.h - stringSize.h) / 2;
+			p.y += (size.h - stringSize.h) / 2;
 		} else { // bottom alignment
-			p.y += rgn.h - stringSize.h;
+			p.y += size.h - stringSize.h;
+		}
+	}
+	return p;
+}
+
+Font::GlyphRun Font::LayoutText(const Size& size, const String& string, ieByte alignment, const Point& start) const
+{
+	GlyphRun run;
+	if (size.IsInvalid()) return run;
+
+	Point p = AlignedStart(size, string, alignment, start);
+	Region rgn(Point(), size);
+	run.numPrinted = RenderText(string, rgn, alignment, nullptr, &p, nullptr, false, &run);
+	run.end = p;
+	return run;
+}
+
+const Font::GlyphRun& Font::CachedLayout(const Size& size, const String& string, ieByte alignment, const Point& start) const
+{
+	size_t hash = std::hash<String>()(string);
+	for (int value : { size.w, size.h, int(alignment), start.x, start.y }) {
+		hash ^= std::hash<int>()(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	}
+
+	auto range = runCache.equal_range(hash);
+	for (auto it = range.first; it != range.second; ++it) {
+		const CachedRun& cached = it->second;
+		if (cached.size == size && cached.alignment == alignment && cached.start == start && cached.text == string) {
+			return cached.run;
+		}
+	}
+
+	// the message log alone prints a few hundred different strings
+	if (runCache.size() >= MAX_CACHED_RUNS) {
+		runCache.clear();
+	}
+	CachedRun cached = { string, size, alignment, start, LayoutText(size, string, alignment, start) };
+	return runCache.emplace(hash, std::move(cached))->second.run;
+}
+
+void Font::DrawRun(const GlyphRun& run, const Point& origin, const PrintColors* colors) const
+{
+	if (run.glyphs.empty()) return;
+
+	const Region& sclip = core->GetVideoDriver()->GetScreenClip();
+	if (!sclip.IntersectsRegion(Region(run.bounds.origin + origin, run.bounds.size))) {
+		return;
+	}
+
+	for (const GlyphRun::Entry& glyph : run.glyphs) {
+		GlyphAtlasPage* page = Atlas[AtlasIndex[glyph.chr].pageIdx];
+		page->Draw(glyph.chr, Region(glyph.pos + origin, glyph.size), colors);
+	}
+}
+
+size_t Font::Print(Region rgn, const String& string, ieByte alignment, const PrintColors* colors, Point* point) const
+{
+	if (rgn.size.IsInvalid()) return 0;
+
+	Point p = point ? *point : Point();
+	if (!core->InDebugMode(ID_FONTS)) {
+		const GlyphRun& run = CachedLayout(rgn.size, string, alignment, p);
+		DrawRun(run, rgn.origin, colors);
+		if (point) {
+			*point = run.end;
 		}
+		return run.numPrinted;
 	}
 
+	// uncached, so the layout gets drawn too
+	p = AlignedStart(rgn.size, string, alignment, p);
 	size_t ret = RenderText(string, rgn, alignment, colors, &p);
 
 	if (point) {
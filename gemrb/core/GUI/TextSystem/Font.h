@@ -40,6 +40,8 @@
 
 #include <deque>
 #include <map>
+#include <unordered_map>
+#include <vector>
 
 namespace GemRB {
 
@@ -110,6 +112,20 @@ public:
 		bool forceBreak;// whether or not a break can occur without whitespace; updated to false if initially true and no force break occured
 	};
 
+	// a laid out string: where each glyph goes relative to the region it was laid out for
+	struct GlyphRun {
+		struct Entry {
+			ieWord chr;
+			Point pos;
+			Size size;
+		};
+		std::vector<Entry> glyphs;
+		Region bounds;
+		size_t numPrinted = 0;
+		// the point inside the region where the string ends, as Print returns it
+		Point end;
+	};
+
 private:
 	class GlyphAtlasPage : public SpriteSheet<ieWord> {
 		private:
@@ -155,6 +171,17 @@ private:
 	GlyphIndex AtlasIndex;
 	GlyphAtlas Atlas;
 
+	struct CachedRun {
+		String text;
+		Size size;
+		ieByte alignment;
+		Point start;
+		GlyphRun run;
+	};
+	// the layouts of recently printed strings by a hash of their parameters,
+	// so printing the same thing again only has to blit the glyphs
+	mutable std::unordered_multimap<size_t, CachedRun> runCache;
+
 protected:
 	PaletteHolder palette;
 	bool background = false;
@@ -166,11 +193,15 @@ public:
 private:
 	void CreateGlyphIndex(ieWord chr, ieWord pageIdx, const Glyph*);
 	// Blit to the sprite or screen if canvas is NULL
+	// or only record the glyphs in run
 	size_t RenderText(const String&, Region&, ieByte alignment, const PrintColors*,
-					  Point* = NULL, ieByte** canvas = NULL, bool grow = false) const;
+					  Point* = NULL, ieByte** canvas = NULL, bool grow = false, GlyphRun* run = nullptr) const;
 	// render a single line of text. called by RenderText()
 	size_t RenderLine(const String& string, const Region& rgn,
-					  Point& dp, const PrintColors*, ieByte** canvas = NULL) const;
+					  Point& dp, const PrintColors*, ieByte** canvas = NULL, GlyphRun* run = nullptr) const;
+	// applies the vertical alignment to the start point
+	Point AlignedStart(const Size& size, const String& string, ieByte alignment, Point start) const;
+	const GlyphRun& CachedLayout(const Size& size, const String& string, ieByte alignment, const Point& start) const;
 	
 	size_t Print(Region rgn, const String& string, ieByte Alignment, const PrintColors* colors, Point* point = nullptr) const;
 
@@ -203,6 +234,11 @@ public:
 	size_t Print(Region rgn, const String& string,
 				 PaletteHolder hicolor, ieByte Alignment, Point* point = nullptr) const;
 
+	// lays the string out like Print would for a region of that size, without drawing it
+	GlyphRun LayoutText(const Size& size, const String& string, ieByte alignment, const Point& start = Point()) const;
+	// draws a run of this font with the region origin at origin
+	void DrawRun(const GlyphRun& run, const Point& origin, const PrintColors* colors = nullptr) const;
+
 	/** Returns size of the string rendered in this font in pixels */
 	Size StringSize(const String&, StringSizeMetrics* metrics = NULL) const;
 
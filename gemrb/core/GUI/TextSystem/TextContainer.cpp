@@ -378,6 +378,11 @@ void ContentContainer::DrawSelf(const Region& drawFrame, const Region& clip)
 
 void ContentContainer::DrawContents(const Layout& contentLayout, Point point)
 {
+	// most of a long message log is scrolled out of view
+	const Region& sclip = core->GetVideoDriver()->GetScreenClip();
+	if (!sclip.IntersectsRegion(Region(contentLayout.bounds.origin + point, contentLayout.bounds.size))) {
+		return;
+	}
 	contentLayout.content->DrawContentsInRegions(contentLayout.regions, point);
 }
 
@@ -515,7 +520,7 @@ const ContentContainer::Layout* ContentContainer::LayoutAtPoint(const Point& p)
 
 Region ContentContainer::BoundingBoxForContent(const Content* c) const
 {
-	return BoundingBoxForLayout(LayoutForContent(c).regions);
+	return LayoutForContent(c).bounds;
 }
 
 Region ContentContainer::BoundingBoxForLayout(const LayoutRegions& layoutRgns) const
@@ -534,8 +539,9 @@ Region ContentContainer::BoundingBoxForLayout(const LayoutRegions& layoutRgns) c
 
 const ContentContainer::Layout& ContentContainer::LayoutForContent(const Content* c) const
 {
-	ContentLayout::const_iterator it = std::find(layout.begin(), layout.end(), c);
-	if (it != layout.end()) {
+	// usually asked about the content laid out last
+	auto it = std::find(layout.rbegin(), layout.rend(), c);
+	if (it != layout.rend()) {
 		return *it;
 	}
 	static Layout NullLayout(nullptr, LayoutRegions());
@@ -544,7 +550,15 @@ const ContentContainer::Layout& ContentContainer::LayoutForContent(const Content
 
 const Region* ContentContainer::ContentRegionForRect(const Region& r) const
 {
-	for (const auto& layoutRgn : layout) {
+	// skip the layouts that end above the rect, so appending to a long
+	// log doesn't have to look at all of it for every new line
+	auto it = std::upper_bound(layout.begin(), layout.end(), r.y, [](int y, const Layout& l) {
+		return y < l.maxBottom;
+	});
+	for (; it != layout.end(); ++it) {
+		const Layout& layoutRgn = *it;
+		if (!layoutRgn.bounds.IntersectsRegion(r)) continue;
+
 		for (const auto& lrgn : layoutRgn.regions) {
 			const Region& rect = lrgn->region;
 			if (rect.IntersectsRegion(r)) {
@@ -576,7 +590,11 @@ void ContentContainer::LayoutContentsFrom(ContentList::const_iterator it)
 	}
 
 	// clear the existing layout, but only for "it" and onward
+	// nothing to do when appending, since the previous content was laid out last
 	ContentList::const_iterator clearit = it;
+	if (exContent && !layout.empty() && layout.back().content == exContent) {
+		clearit = contents.end();
+	}
 	for (; clearit != contents.end(); ++clearit) {
 		ContentLayout::iterator i = std::find(layout.begin(), layout.end(), *clearit);
 		if (i != layout.end()) {
@@ -625,7 +643,10 @@ void ContentContainer::LayoutContentsFrom(ContentList::const_iterator it)
 			assert(exContent != content);
 		}
 		const LayoutRegions& rgns = content->LayoutForPointInRegion(layoutPoint, layoutFrame);
+		int maxBottom = layout.empty() ? INT_MIN : layout.back().maxBottom;
 		layout.emplace_back(content, rgns);
+		Layout& contentLayout = layout.back();
+		contentLayout.maxBottom = std::max(maxBottom, contentLayout.bounds.y + contentLayout.bounds.h);
 		exContent = content;
 
 		ieDword flags = Flags();
@@ -157,10 +157,18 @@ protected:
 	struct Layout {
 		const Content* content;
 		LayoutRegions regions;
+		Region bounds;
+		// the lowest bottom edge of this and all the preceding layouts
+		int maxBottom = 0;
 		
 		Layout(const Content* c, LayoutRegions rgns)
 		: content(c), regions(std::move(rgns)) {
 			assert(!regions.empty());
+			if (regions.empty()) return;
+			bounds = regions.front()->region;
+			for (const auto& layoutRegion : regions) {
+				bounds.ExpandToRegion(layoutRegion->region);
+			}
 		}
 
 		bool operator==(const Content* c) const {
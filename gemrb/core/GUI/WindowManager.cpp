@@ -18,6 +18,7 @@
 
 #include "WindowManager.h"
 
+#include "FrameProfiler.h"
 #include "GameData.h"
 #include "Interface.h"
 #include "ImageMgr.h"
@@ -571,6 +572,7 @@ WindowManager::HUDLock WindowManager::DrawHUD() const
 
 void WindowManager::DrawWindows() const
 {
+	PROFILE_SCOPE(DrawWindows);
 	HUDBuf->Clear();
 
 	if (windows.empty()) {
@@ -25,7 +25,9 @@
 #include "defsounds.h"
 #include "strrefs.h"
 
+#include "AreaPrefetcher.h"
 #include "DisplayMessage.h"
+#include "FrameProfiler.h"
 #include "GameData.h"
 #include "Interface.h"
 #include "IniSpawn.h"
@@ -36,14 +38,18 @@
 #include "ScriptEngine.h"
 #include "Spell.h"
 #include "TableMgr.h"
+#include "TileMap.h"
+#include "WorldMap.h"
 #include "GameScript/GameScript.h"
 #include "GameScript/GSUtils.h"
 #include "GUI/GameControl.h"
+#include "Scriptable/InfoPoint.h"
 #include "Video/Pixels.h"
 #include "Streams/DataStream.h"
 #include "MapReverb.h"
 
 #include <algorithm>
+#include <chrono>
 #include <iterator>
 #include <utility>
 #include <vector>
@@ -425,8 +431,8 @@ void Game::InitActorPos(Actor *actor) const
 	const char *area = start->QueryField(mode[playmode],"AREA");
 	const char *rot = start->QueryField(mode[playmode],"ROT");
 
-	actor->Pos.x = actor->Destination.x = atoi(strta->QueryField(strta->GetRowIndex(xpos), ip));
-	actor->Pos.y = actor->Destination.y = atoi(strta->QueryField(strta->GetRowIndex(ypos), ip));
+	actor->SetPos(Point(atoi(strta->QueryField(strta->GetRowIndex(xpos), ip)), atoi(strta->QueryField(strta->GetRowIndex(ypos), ip))));
+	actor->Destination = actor->Pos;
 	actor->HomeLocation = actor->Pos;
 	actor->SetOrientation(ClampToOrientation(atoi(strta->QueryField(strta->GetRowIndex(rot), ip))), false);
 
@@ -822,6 +828,10 @@ int Game::LoadMap(const ResRef &resRef, bool loadscreen)
 		return index;
 	}
 
+	auto startTime = std::chrono::steady_clock::now();
+	AreaPrefetcher* prefetcher = core->GetAreaPrefetcher();
+	unsigned int prefetched = prefetcher ? prefetcher->GetServedCount() : 0;
+
 	if (loadscreen && sE) {
 		sE->RunFunction("LoadScreen", "StartLoadScreen");
 		sE->RunFunction("LoadScreen", "SetLoadScreen");
@@ -867,11 +877,64 @@ int Game::LoadMap(const ResRef &resRef, bool loadscreen)
 	}
 
 	core->GetAudioDrv()->UpdateMapAmbient(newMap->reverb);
+	core->GetAudioDrv()->Preload(newMap->GetSoundsToPreload());
+
+	if (prefetcher) {
+		prefetched = prefetcher->GetServedCount() - prefetched;
+		// anything not used by now won't be
+		prefetcher->Release(resRef);
+		PrefetchNeighbours(newMap);
+	}
+
+	std::chrono::duration<double, std::milli> loadTime = std::chrono::steady_clock::now() - startTime;
+	areaLoadTimes[resRef].push_back(loadTime.count());
+	Log(MESSAGE, "Game", "Area {} was ready after {:.1f}ms, {} resources were read ahead",
+		resRef, loadTime.count(), prefetched);
 
 	core->LoadProgress(100);
 	return ret;
 }
 
+// queues the areas the party is likely to go next for reading in the
+// background: the travel regions first, then the worldmap links
+void Game::PrefetchNeighbours(const Map* map) const
+{
+	static const size_t MAX_PREFETCHED_AREAS = 6;
+	std::vector<ResRef> areas;
+	auto addArea = [&areas, this](const ResRef& area) {
+		if (area.IsEmpty() || areas.size() >= MAX_PREFETCHED_AREAS || FindMap(area) >= 0) return;
+		if (std::find(areas.begin(), areas.end(), area) == areas.end()) {
+			areas.push_back(area);
+		}
+	};
+
+	const TileMap* tm = map->GetTileMap();
+	for (size_t i = 0; i < tm->GetInfoPointCount(); i++) {
+		const InfoPoint* ip = tm->GetInfoPoint(i);
+		if (ip->Type == ST_TRAVEL) {
+			addArea(ip->Destination);
+		}
+	}
+
+	const WorldMap* worldmap = core->GetWorldMap(map->GetScriptRef());
+	unsigned int index;
+	const WMPAreaEntry* entry = worldmap ? worldmap->GetArea(map->GetScriptRef(), index) : nullptr;
+	if (entry) {
+		for (int dir = 0; dir < 4; dir++) {
+			for (ieDword i = 0; i < entry->AreaLinksCount[dir]; i++) {
+				ieDword linkIndex = entry->AreaLinksIndex[dir] + i;
+				if (linkIndex >= ieDword(worldmap->GetLinkCount())) break;
+				const WMPAreaLink* link = worldmap->GetLink(linkIndex);
+				if (link->AreaIndex < ieDword(worldmap->GetEntryCount())) {
+					addArea(worldmap->GetEntry(link->AreaIndex)->AreaResRef);
+				}
+			}
+		}
+	}
+
+	core->GetAreaPrefetcher()->Prefetch(areas);
+}
+
 // check if the actor is in npclevel.2da and replace accordingly
 bool Game::CheckForReplacementActor(size_t i)
 {
@@ -907,7 +970,7 @@ bool Game::CheckForReplacementActor(size_t i)
 			if (!newact) {
 				error("Game::CheckForReplacementActor", "GetNPC failed: cannot find act!");
 			} else {
-				newact->Pos = act->Pos; // the map is not loaded yet, so no SetPosition
+				newact->SetPos(act->Pos); // the map is not loaded yet, so no SetPosition
 				newact->TalkCount = act->TalkCount;
 				newact->InteractCount = act->InteractCount;
 				newact->Area = act->Area;
@@ -1464,6 +1527,7 @@ bool Game::EveryoneDead() const
 
 void Game::UpdateScripts()
 {
+	PROFILE_SCOPE(Scripts);
 	Update();
 
 	PartyAttack = false;
@@ -1472,6 +1536,12 @@ void Game::UpdateScripts()
 		Maps[idx]->UpdateScripts();
 	}
 
+	// only the area on screen has anything to show
+	Map* map = GetCurrentArea();
+	if (map) {
+		map->UpdateScene();
+	}
+
 	if (PartyAttack) {
 		//ChangeSong will set the battlesong only if CombatCounter is nonzero
 		CombatCounter=150;
@@ -2295,4 +2365,52 @@ void Game::MoveFamiliars(const ResRef& targetArea, const Point& targetPoint, int
 	}
 }
 
+// Piles a late game amount of stacked buffs on every party member and times
+// the full stat refreshes, which reapply all the effects and do plenty of
+// opcode lookups along the way. The original queues are restored after.
+double Game::BenchmarkPartyRefresh(unsigned int buffs, unsigned int rounds) const
+{
+	static EffectRef buffRefs[] = {
+		{ "ACVsDamageTypeModifier", -1 }, { "ToHitModifier", -1 }, { "DamageBonusModifier", -1 },
+		{ "SaveVsDeathModifier", -1 }, { "LuckModifier", -1 }, { "CriticalHitModifier", -1 },
+		{ "BackstabModifier", -1 }, { "CastingLevelModifier", -1 }, { "FireResistanceModifier", -1 },
+		{ "MagicResistanceModifier", -1 }, { "MoraleBreakModifier", -1 }
+	};
+	using Clock = std::chrono::steady_clock;
+
+	if (PCs.empty()) return 0;
+
+	std::vector<EffectQueue> backups;
+	size_t effectCount = 0;
+	for (Actor* pc : PCs) {
+		backups.push_back(pc->fxqueue);
+		for (unsigned int i = 0; i < buffs; i++) {
+			EffectRef& ref = buffRefs[i % (sizeof(buffRefs) / sizeof(buffRefs[0]))];
+			// while equipped, so they are simply reapplied with each refresh
+			Effect* fx = EffectQueue::CreateEffect(ref, 1, 0, FX_DURATION_INSTANT_WHILE_EQUIPPED);
+			if (!fx) continue;
+			pc->fxqueue.AddEffect(fx);
+		}
+		effectCount += pc->fxqueue.GetEffectsCount();
+	}
+
+	auto startTime = Clock::now();
+	for (unsigned int round = 0; round < rounds; round++) {
+		for (Actor* pc : PCs) {
+			pc->RefreshEffects();
+		}
+	}
+	std::chrono::duration<double, std::milli> elapsed = Clock::now() - startTime;
+
+	for (size_t i = 0; i < PCs.size(); i++) {
+		PCs[i]->fxqueue = std::move(backups[i]);
+		PCs[i]->RefreshEffects();
+	}
+
+	double perRefresh = rounds ? elapsed.count() / (rounds * PCs.size()) : 0;
+	Log(MESSAGE, "Game", "{} party members with {} effects in total: {:.3f}ms per refresh, {:.1f}ms for {} rounds",
+		PCs.size(), effectCount, perRefresh, elapsed.count(), rounds);
+	return perRefresh;
+}
+
 }
@@ -489,7 +489,14 @@ public:
 	bool OnlyNPCsSelected() const;
 	void MovePCs(const ResRef& targetArea, const Point& targetPoint, int orientation) const;
 	void MoveFamiliars(const ResRef& targetArea, const Point& targetPoint, int orientation) const;
+	/** Times full stat refreshes of the party, each member carrying extra buffs */
+	double BenchmarkPartyRefresh(unsigned int buffs, unsigned int rounds) const;
+	/** How long each LoadMap took (in ms) until the area was ready, per area */
+	const ResRefMap<std::vector<double>>& GetAreaLoadTimes() const { return areaLoadTimes; }
 private:
+	ResRefMap<std::vector<double>> areaLoadTimes;
+
+	void PrefetchNeighbours(const Map* map) const;
 	bool DetermineStartPosType(const TableMgr *strta) const;
 	ResRef *GetDream(Map *area);
 	void CastOnRest() const;
@@ -49,6 +49,9 @@
 
 namespace GemRB {
 
+// the templates are dropped all at once past this
+#define MAX_VFX_TEMPLATES 512
+
 static void ReleaseItem(void *poi)
 {
 	delete ((Item *) poi);
@@ -82,6 +85,9 @@ void GameData::ClearCaches()
 	SpellCache.RemoveAll(ReleaseSpell);
 	EffectCache.RemoveAll(ReleaseEffect);
 	PaletteCache.clear ();
+	vvcTemplates[0].clear();
+	vvcTemplates[1].clear();
+	vefTemplates.clear();
 	colors.clear();
 
 	while (!stores.empty()) {
@@ -311,6 +317,14 @@ void GameData::FreeEffect(const Effect *eff, const ResRef &name, bool free)
 //create a vvc for it!
 ScriptedAnimation* GameData::GetScriptedAnimation(const ResRef &effect, bool doublehint)
 {
+	auto& templates = vvcTemplates[doublehint];
+	auto cached = templates.find(effect);
+	if (cached != templates.end()) {
+		vfxStats.hits++;
+		return cached->second->Clone();
+	}
+	vfxStats.misses++;
+
 	ScriptedAnimation *ret = NULL;
 
 	if (Exists( effect, IE_VVC_CLASS_ID, true ) ) {
@@ -324,33 +338,62 @@ ScriptedAnimation* GameData::GetScriptedAnimation(const ResRef &effect, bool dou
 			ret->LoadAnimationFactory( af, doublehint?2:0);
 		}
 	}
-	if (ret) {
-		ret->ResName = effect;
+	if (!ret) {
+		return nullptr;
 	}
-	return ret;
+
+	ret->ResName = effect;
+	if (templates.size() >= MAX_VFX_TEMPLATES) {
+		templates.clear();
+	}
+	templates.emplace(effect, std::unique_ptr<ScriptedAnimation>(ret));
+	return ret->Clone();
 }
 
 VEFObject* GameData::GetVEFObject(const ResRef& vefRef, bool doublehint)
 {
-	VEFObject* ret = nullptr;
+	auto cached = vefTemplates.find(vefRef);
+	if (cached == vefTemplates.end()) {
+		VEFObject* vef = nullptr;
+		if (Exists(vefRef, IE_VEF_CLASS_ID, true)) {
+			DataStream* ds = GetResource(vefRef, IE_VEF_CLASS_ID);
+			vef = new VEFObject();
+			vef->ResName = vefRef;
+			vef->LoadVEF(ds);
+		} else if (Exists(vefRef, IE_2DA_CLASS_ID, true)) {
+			vef = new VEFObject();
+			vef->Load2DA(vefRef);
+		}
 
-	if (Exists(vefRef, IE_VEF_CLASS_ID, true)) {
-		DataStream* ds = GetResource(vefRef, IE_VEF_CLASS_ID);
-		ret = new VEFObject();
-		ret->ResName = vefRef;
-		ret->LoadVEF(ds);
-	} else {
-		if (Exists(vefRef, IE_2DA_CLASS_ID, true)) {
-			ret = new VEFObject();
-			ret->Load2DA(vefRef);
-		} else {
-			ScriptedAnimation* sca = GetScriptedAnimation(vefRef, doublehint);
-			if (sca) {
-				ret = new VEFObject(sca);
-			}
+		if (vefTemplates.size() >= MAX_VFX_TEMPLATES) {
+			vefTemplates.clear();
+		}
+		cached = vefTemplates.emplace(vefRef, std::unique_ptr<VEFObject>(vef)).first;
+		if (vef) {
+			vfxStats.misses++;
+			return vef->Clone();
 		}
+	} else if (cached->second) {
+		vfxStats.hits++;
+		return cached->second->Clone();
+	}
+
+	// the vvc cache does the counting
+	ScriptedAnimation* sca = GetScriptedAnimation(vefRef, doublehint);
+	if (sca) {
+		return new VEFObject(sca);
+	}
+	return nullptr;
+}
+
+GameData::VisualEffectStats GameData::GetVisualEffectStats() const
+{
+	VisualEffectStats stats = vfxStats;
+	stats.templates = vvcTemplates[0].size() + vvcTemplates[1].size();
+	for (const auto& vef : vefTemplates) {
+		if (vef.second) stats.templates++;
 	}
-	return ret;
+	return stats;
 }
 
 // Return single BAM frame as a sprite. Use if you want one frame only,
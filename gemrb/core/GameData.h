@@ -33,6 +33,7 @@
 #include "TableMgr.h"
 
 #include <map>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -88,6 +89,12 @@ struct ItemUseType {
 class GEM_EXPORT GameData : public ResourceManager
 {
 public:
+	struct VisualEffectStats {
+		size_t hits = 0;
+		size_t misses = 0;
+		size_t templates = 0;
+	};
+
 	GameData();
 	GameData(const GameData&) = delete;
 	~GameData();
@@ -123,6 +130,8 @@ public:
 
 	/** creates a composite vef/2da animation */
 	VEFObject* GetVEFObject(const ResRef& vefRef, bool doublehint);
+	/** how well the two above are served by their templates */
+	VisualEffectStats GetVisualEffectStats() const;
 
 	/** returns a single sprite (not cached) from a BAM resource */
 	Holder<Sprite2D> GetBAMSprite(const ResRef &resRef, int cycle, int frame, bool silent=false);
@@ -185,6 +194,11 @@ private:
 	Cache SpellCache;
 	Cache EffectCache;
 	ResRefMap<PaletteHolder> PaletteCache;
+	// parsed once, instances are copies; by doublehint for the bams
+	ResRefMap<std::unique_ptr<ScriptedAnimation>> vvcTemplates[2];
+	// empty for those that turned out to be plain vvcs or bams
+	ResRefMap<std::unique_ptr<VEFObject>> vefTemplates;
+	VisualEffectStats vfxStats;
 	Factory* factory;
 	ResRefMap<AutoTable> tables;
 	using StoreMap = std::map<ResRef, Store*>;
@@ -0,0 +1,291 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#include "GameScript/CompiledScript.h"
+
+#include "Streams/DataStream.h"
+
+#include <cstring>
+
+namespace GemRB {
+
+// the arrays are written as they are in memory, so the cache is only good
+// for machines with the same byte order
+static const char CacheSignature[4] = { 'G', 'S', 'C', '1' };
+static const uint32_t ByteOrderMark = 0x01020304;
+
+CompiledScript::CompiledScript(const Script& script, uint64_t key)
+	: key(key)
+{
+	strings.push_back('\0');
+
+	for (const ResponseBlock* rB : script.responseBlocks) {
+		BlockRecord block {};
+		if (rB->condition) {
+			block.flags |= HasCondition;
+			block.firstTrigger = uint32_t(triggers.size());
+			for (const Trigger* tR : rB->condition->triggers) {
+				TriggerRecord trigger {};
+				trigger.id = tR->triggerID;
+				trigger.int0 = tR->int0Parameter;
+				trigger.flags = tR->flags;
+				trigger.int1 = tR->int1Parameter;
+				trigger.int2 = tR->int2Parameter;
+				trigger.x = tR->pointParameter.x;
+				trigger.y = tR->pointParameter.y;
+				trigger.object = AddObject(tR->objectParameter);
+				trigger.string0 = AddString(tR->string0Parameter.CString());
+				trigger.string1 = AddString(tR->string1Parameter.CString());
+				triggers.push_back(trigger);
+			}
+			block.triggerCount = uint32_t(triggers.size()) - block.firstTrigger;
+		}
+
+		if (rB->responseSet) {
+			block.flags |= HasResponseSet;
+			block.firstResponse = uint32_t(responses.size());
+			for (const Response* rE : rB->responseSet->responses) {
+				ResponseRecord response {};
+				response.weight = rE->weight;
+				response.firstAction = uint32_t(actions.size());
+				for (const Action* aC : rE->actions) {
+					ActionRecord action {};
+					action.id = aC->actionID;
+					for (int i = 0; i < 3; i++) {
+						action.objects[i] = AddObject(aC->objects[i]);
+					}
+					action.int0 = aC->int0Parameter;
+					action.x = aC->pointParameter.x;
+					action.y = aC->pointParameter.y;
+					action.int1 = aC->int1Parameter;
+					action.int2 = aC->int2Parameter;
+					action.string0 = AddString(aC->string0Parameter.CString());
+					action.string1 = AddString(aC->string1Parameter.CString());
+					actions.push_back(action);
+				}
+				response.actionCount = uint32_t(actions.size()) - response.firstAction;
+				responses.push_back(response);
+			}
+			block.responseCount = uint32_t(responses.size()) - block.firstResponse;
+		}
+		blocks.push_back(block);
+	}
+}
+
+uint32_t CompiledScript::AddObject(const Object* object)
+{
+	if (!object) return NONE;
+
+	ObjectRecord record {};
+	std::copy(std::begin(object->objectFields), std::end(object->objectFields), record.fields);
+	std::copy(std::begin(object->objectFilters), std::end(object->objectFilters), record.filters);
+	record.rect[0] = object->objectRect.x;
+	record.rect[1] = object->objectRect.y;
+	record.rect[2] = object->objectRect.w;
+	record.rect[3] = object->objectRect.h;
+	record.name = AddString(object->objectName.CString());
+	objects.push_back(record);
+	return uint32_t(objects.size() - 1);
+}
+
+uint32_t CompiledScript::AddString(const char* str)
+{
+	if (!str[0]) return 0;
+
+	uint32_t offset = uint32_t(strings.size());
+	strings.insert(strings.end(), str, str + strlen(str) + 1);
+	return offset;
+}
+
+const char* CompiledScript::GetString(uint32_t offset) const
+{
+	return &strings[offset];
+}
+
+Object* CompiledScript::MakeObject(uint32_t idx) const
+{
+	if (idx == NONE) return nullptr;
+
+	const ObjectRecord& record = objects[idx];
+	Object* oB = new Object();
+	std::copy(std::begin(record.fields), std::end(record.fields), oB->objectFields);
+	std::copy(std::begin(record.filters), std::end(record.filters), oB->objectFilters);
+	oB->objectRect = Region(record.rect[0], record.rect[1], record.rect[2], record.rect[3]);
+	oB->objectName = GetString(record.name);
+	return oB;
+}
+
+Script* CompiledScript::Instantiate() const
+{
+	Script* script = new Script();
+	script->responseBlocks.reserve(blocks.size());
+
+	for (const BlockRecord& block : blocks) {
+		ResponseBlock* rB = new ResponseBlock();
+		if (block.flags & HasCondition) {
+			rB->condition = new Condition();
+			rB->condition->triggers.reserve(block.triggerCount);
+			for (uint32_t i = block.firstTrigger; i < block.firstTrigger + block.triggerCount; i++) {
+				const TriggerRecord& record = triggers[i];
+				Trigger* tR = new Trigger();
+				tR->triggerID = static_cast<unsigned short>(record.id);
+				tR->int0Parameter = record.int0;
+				tR->flags = record.flags;
+				tR->int1Parameter = record.int1;
+				tR->int2Parameter = record.int2;
+				tR->pointParameter = Point(record.x, record.y);
+				tR->objectParameter = MakeObject(record.object);
+				tR->string0Parameter = GetString(record.string0);
+				tR->string1Parameter = GetString(record.string1);
+				rB->condition->triggers.push_back(tR);
+			}
+		}
+
+		if (block.flags & HasResponseSet) {
+			rB->responseSet = new ResponseSet();
+			rB->responseSet->responses.reserve(block.responseCount);
+			for (uint32_t r = block.firstResponse; r < block.firstResponse + block.responseCount; r++) {
+				const ResponseRecord& response = responses[r];
+				Response* rE = new Response();
+				rE->weight = static_cast<unsigned char>(response.weight);
+				rE->actions.reserve(response.actionCount);
+				for (uint32_t i = response.firstAction; i < response.firstAction + response.actionCount; i++) {
+					const ActionRecord& record = actions[i];
+					//not autofreed, because it is referenced by the Script
+					Action* aC = new Action(false);
+					aC->actionID = static_cast<unsigned short>(record.id);
+					for (int o = 0; o < 3; o++) {
+						aC->objects[o] = MakeObject(record.objects[o]);
+					}
+					aC->int0Parameter = record.int0;
+					aC->pointParameter = Point(record.x, record.y);
+					aC->int1Parameter = record.int1;
+					aC->int2Parameter = record.int2;
+					aC->string0Parameter = GetString(record.string0);
+					aC->string1Parameter = GetString(record.string1);
+					rE->actions.push_back(aC);
+				}
+				rB->responseSet->responses.push_back(rE);
+			}
+		}
+		script->responseBlocks.push_back(rB);
+	}
+	return script;
+}
+
+size_t CompiledScript::GetMemoryUsage() const
+{
+	return sizeof(*this) + blocks.size() * sizeof(BlockRecord) + triggers.size() * sizeof(TriggerRecord)
+		+ responses.size() * sizeof(ResponseRecord) + actions.size() * sizeof(ActionRecord)
+		+ objects.size() * sizeof(ObjectRecord) + strings.size();
+}
+
+template <typename T>
+static bool WriteArray(DataStream* stream, const std::vector<T>& array)
+{
+	strpos_t len = array.size() * sizeof(T);
+	return !len || stream->Write(array.data(), len) == strret_t(len);
+}
+
+template <typename T>
+static bool ReadArray(DataStream* stream, std::vector<T>& array, uint32_t count)
+{
+	// don't trust the count with the allocation
+	if (count > stream->Remains() / sizeof(T)) return false;
+
+	array.resize(count);
+	strpos_t len = count * sizeof(T);
+	return !len || stream->Read(array.data(), len) == strret_t(len);
+}
+
+bool CompiledScript::Save(DataStream* stream) const
+{
+	uint32_t counts[6] = {
+		uint32_t(blocks.size()), uint32_t(triggers.size()), uint32_t(responses.size()),
+		uint32_t(actions.size()), uint32_t(objects.size()), uint32_t(strings.size())
+	};
+	if (stream->Write(CacheSignature, sizeof(CacheSignature)) != sizeof(CacheSignature)) return false;
+	if (stream->Write(&ByteOrderMark, sizeof(ByteOrderMark)) != sizeof(ByteOrderMark)) return false;
+	if (stream->Write(&key, sizeof(key)) != sizeof(key)) return false;
+	if (stream->Write(counts, sizeof(counts)) != sizeof(counts)) return false;
+
+	return WriteArray(stream, blocks) && WriteArray(stream, triggers) && WriteArray(stream, responses)
+		&& WriteArray(stream, actions) && WriteArray(stream, objects) && WriteArray(stream, strings);
+}
+
+bool CompiledScript::Load(DataStream* stream, uint64_t wanted)
+{
+	char signature[sizeof(CacheSignature)];
+	uint32_t mark = 0;
+	uint64_t storedKey = 0;
+	uint32_t counts[6];
+	if (stream->Read(signature, sizeof(signature)) != sizeof(signature)) return false;
+	if (memcmp(signature, CacheSignature, sizeof(signature)) != 0) return false;
+	if (stream->Read(&mark, sizeof(mark)) != sizeof(mark) || mark != ByteOrderMark) return false;
+	if (stream->Read(&storedKey, sizeof(storedKey)) != sizeof(storedKey) || storedKey != wanted) return false;
+	if (stream->Read(counts, sizeof(counts)) != sizeof(counts)) return false;
+
+	bool read = ReadArray(stream, blocks, counts[0]) && ReadArray(stream, triggers, counts[1])
+		&& ReadArray(stream, responses, counts[2]) && ReadArray(stream, actions, counts[3])
+		&& ReadArray(stream, objects, counts[4]) && ReadArray(stream, strings, counts[5]);
+	key = storedKey;
+	if (read && Validate()) {
+		return true;
+	}
+
+	*this = CompiledScript();
+	return false;
+}
+
+// a truncated or otherwise damaged cache must not send Instantiate off the arrays
+bool CompiledScript::Validate() const
+{
+	if (strings.empty() || strings.front() || strings.back()) return false;
+
+	auto stringOK = [this](uint32_t offset) {
+		return offset < strings.size();
+	};
+	auto objectOK = [this](uint32_t idx) {
+		return idx == NONE || idx < objects.size();
+	};
+
+	for (const ObjectRecord& object : objects) {
+		if (!stringOK(object.name)) return false;
+	}
+	for (const TriggerRecord& trigger : triggers) {
+		if (!objectOK(trigger.object) || !stringOK(trigger.string0) || !stringOK(trigger.string1)) return false;
+	}
+	for (const ActionRecord& action : actions) {
+		if (!stringOK(action.string0) || !stringOK(action.string1)) return false;
+		for (uint32_t object : action.objects) {
+			if (!objectOK(object)) return false;
+		}
+	}
+	for (const ResponseRecord& response : responses) {
+		if (response.firstAction > actions.size() || response.actionCount > actions.size() - response.firstAction) return false;
+	}
+	for (const BlockRecord& block : blocks) {
+		if (block.firstTrigger > triggers.size() || block.triggerCount > triggers.size() - block.firstTrigger) return false;
+		if (block.firstResponse > responses.size() || block.responseCount > responses.size() - block.firstResponse) return false;
+	}
+	return true;
+}
+
+}
@@ -0,0 +1,130 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef COMPILEDSCRIPT_H
+#define COMPILEDSCRIPT_H
+
+#include "exports.h"
+
+#include "GameScript/GameScript.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace GemRB {
+
+class DataStream;
+
+// A parsed script flattened into a few arrays, with indices in place of
+// pointers and all the strings pooled. It's small enough to keep around
+// after the last GameScript using the script is gone and is written to
+// disk as it is, so getting the script again skips the text parser.
+// Instantiate builds the node tree the triggers and actions run on, in one
+// pass and in script order.
+class GEM_EXPORT CompiledScript {
+public:
+	// index of a missing object
+	static const uint32_t NONE = 0xffffffff;
+
+	struct ObjectRecord {
+		int32_t fields[MAX_OBJECT_FIELDS];
+		int32_t filters[MAX_NESTING];
+		int32_t rect[4];
+		uint32_t name;
+	};
+
+	struct TriggerRecord {
+		uint32_t id;
+		int32_t int0;
+		int32_t flags;
+		int32_t int1;
+		int32_t int2;
+		int32_t x;
+		int32_t y;
+		uint32_t object;
+		uint32_t string0;
+		uint32_t string1;
+	};
+
+	struct ActionRecord {
+		uint32_t id;
+		uint32_t objects[3];
+		int32_t int0;
+		int32_t x;
+		int32_t y;
+		int32_t int1;
+		int32_t int2;
+		uint32_t string0;
+		uint32_t string1;
+	};
+
+	struct ResponseRecord {
+		uint32_t weight;
+		uint32_t firstAction;
+		uint32_t actionCount;
+	};
+
+	enum BlockFlags : uint32_t {
+		HasCondition = 1,
+		HasResponseSet = 2
+	};
+
+	struct BlockRecord {
+		uint32_t flags;
+		uint32_t firstTrigger;
+		uint32_t triggerCount;
+		uint32_t firstResponse;
+		uint32_t responseCount;
+	};
+
+private:
+	std::vector<BlockRecord> blocks;
+	std::vector<TriggerRecord> triggers;
+	std::vector<ResponseRecord> responses;
+	std::vector<ActionRecord> actions;
+	std::vector<ObjectRecord> objects;
+	// nul terminated strings, offset 0 is the empty one
+	std::vector<char> strings;
+	// of the source text and whatever else changes the parse
+	uint64_t key = 0;
+
+	uint32_t AddObject(const Object* object);
+	uint32_t AddString(const char* str);
+	Object* MakeObject(uint32_t idx) const;
+	const char* GetString(uint32_t offset) const;
+	bool Validate() const;
+
+public:
+	CompiledScript() noexcept = default;
+	/** Flattens a freshly parsed script */
+	CompiledScript(const Script& script, uint64_t key);
+
+	Script* Instantiate() const;
+	uint64_t GetKey() const { return key; }
+	size_t GetMemoryUsage() const;
+
+	bool Save(DataStream* stream) const;
+	/** Fails on anything but an intact cache for key */
+	bool Load(DataStream* stream, uint64_t key);
+};
+
+}
+
+#endif
@@ -807,7 +807,7 @@ static Point FindOffScreenPoint(const Scriptable *Sender, int flags, int creatur
 			}
 
 			// Check if walkableStartPoint can traverse to walkableGoal
-			bool isWalkable = map->FindPath(walkableStartPoint, walkableGoal, creatureSize) != nullptr;
+			bool isWalkable = map->SearchPath(walkableStartPoint, walkableGoal, creatureSize);
 
 			if (isPassable && (!(flags & CC_OBJECT) || isWalkable)) {
 				// walkableStartPoint is the final point
@@ -2015,7 +2015,7 @@ bool IsInObjectRect(const Point &pos, const Region &rect)
 	}
 }
 
-static Object *ObjectCopy(const Object *object)
+Object *ObjectCopy(const Object *object)
 {
 	if (!object) return NULL;
 	Object *newObject = new Object();
@@ -2058,6 +2058,21 @@ Action *ParamCopyNoOverride(const Action *parameters)
 	return newAction;
 }
 
+Trigger *TriggerCopy(const Trigger *trigger)
+{
+	Trigger *newTrigger = new Trigger();
+	newTrigger->triggerID = trigger->triggerID;
+	newTrigger->int0Parameter = trigger->int0Parameter;
+	newTrigger->flags = trigger->flags;
+	newTrigger->int1Parameter = trigger->int1Parameter;
+	newTrigger->int2Parameter = trigger->int2Parameter;
+	newTrigger->pointParameter = trigger->pointParameter;
+	newTrigger->string0Parameter = trigger->string0Parameter;
+	newTrigger->string1Parameter = trigger->string1Parameter;
+	newTrigger->objectParameter = ObjectCopy(trigger->objectParameter);
+	return newTrigger;
+}
+
 Trigger *GenerateTriggerCore(const char *src, const char *str, int trIndex, int negate)
 {
 	Trigger *newTrigger = new Trigger();
@@ -114,8 +114,10 @@ GEM_EXPORT Actor *GetNearestEnemyOf(const Map *map, const Actor *origin, int who
 GEM_EXPORT void FreeSrc(const SrcVector *poi, const ResRef& key);
 GEM_EXPORT SrcVector *LoadSrc(const ResRef& resname);
 bool IsInObjectRect(const Point &pos, const Region &rect);
+Object *ObjectCopy(const Object *object);
 Action *ParamCopy(const Action *parameters);
 Action *ParamCopyNoOverride(const Action *parameters);
+Trigger *TriggerCopy(const Trigger *trigger);
 GEM_EXPORT void SetVariable(Scriptable* Sender, const char* VarName, ieDword value, const char* Context = nullptr);
 GEM_EXPORT void SetPointVariable(Scriptable* Sender, const char* VarName, const Point &point, const char* Context = nullptr);
 Point GetEntryPoint(const char *areaname, const char *entryname);
@@ -41,8 +41,11 @@
 
 #include "GameScript/GameScript.h"
 
+#include "GameScript/CompiledScript.h"
+
 #include "GameScript/GSUtils.h"
 #include "GameScript/Matching.h"
+#include "GameScript/ScriptProfiler.h"
 
 #include "Game.h"
 #include "GUI/GameControl.h" // just for DF_POSTPONE_SCRIPTS
@@ -51,8 +54,14 @@
 #include "PluginMgr.h"
 #include "TableMgr.h"
 #include "RNG.h"
+#include "Streams/FileStream.h"
+#include "System/VFS.h"
 
+#include <algorithm>
 #include <cstdarg>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 namespace GemRB {
 
@@ -308,15 +317,15 @@ static const TriggerLink triggernames[] = {
 	{"numbouncingspelllevel", GameScript::NumBouncingSpellLevel, 0},
 	{"numbouncingspelllevelgt", GameScript::NumBouncingSpellLevelGT, 0},
 	{"numbouncingspelllevellt", GameScript::NumBouncingSpellLevelLT, 0},
-	{"numcreature", GameScript::NumCreatures, 0},
-	{"numcreaturegt", GameScript::NumCreaturesGT, 0},
-	{"numcreaturelt", GameScript::NumCreaturesLT, 0},
-	{"numcreaturesatmylevel", GameScript::NumCreaturesAtMyLevel, 0},
-	{"numcreaturesgtmylevel", GameScript::NumCreaturesGTMyLevel, 0},
-	{"numcreaturesltmylevel", GameScript::NumCreaturesLTMyLevel, 0},
-	{"numcreaturevsparty", GameScript::NumCreatureVsParty, 0},
-	{"numcreaturevspartygt", GameScript::NumCreatureVsPartyGT, 0},
-	{"numcreaturevspartylt", GameScript::NumCreatureVsPartyLT, 0},
+	{"numcreature", GameScript::NumCreatures, TF_MEMO},
+	{"numcreaturegt", GameScript::NumCreaturesGT, TF_MEMO},
+	{"numcreaturelt", GameScript::NumCreaturesLT, TF_MEMO},
+	{"numcreaturesatmylevel", GameScript::NumCreaturesAtMyLevel, TF_MEMO},
+	{"numcreaturesgtmylevel", GameScript::NumCreaturesGTMyLevel, TF_MEMO},
+	{"numcreaturesltmylevel", GameScript::NumCreaturesLTMyLevel, TF_MEMO},
+	{"numcreaturevsparty", GameScript::NumCreatureVsParty, TF_MEMO},
+	{"numcreaturevspartygt", GameScript::NumCreatureVsPartyGT, TF_MEMO},
+	{"numcreaturevspartylt", GameScript::NumCreatureVsPartyLT, TF_MEMO},
 	{"numdead", GameScript::NumDead, 0},
 	{"numdeadgt", GameScript::NumDeadGT, 0},
 	{"numdeadlt", GameScript::NumDeadLT, 0},
@@ -1177,18 +1186,55 @@ static const IDSLink idsnames[] = {
 
 static int NextTriggerObjectID = 0;
 
+// Sorted index over one of the name tables above, built in InitializeIEScript.
+// Like the table scans it replaces, a name matches every entry it is a prefix
+// of and the earliest of those entries wins.
+template<class LINK>
+class LinkIndex {
+	const LINK* links = nullptr;
+	std::vector<std::pair<std::string, size_t>> sorted;
+
+public:
+	void Build(const LINK* table)
+	{
+		links = table;
+		sorted.clear();
+		for (size_t i = 0; table[i].Name; i++) {
+			std::string name(table[i].Name);
+			StringToLower(name);
+			sorted.emplace_back(std::move(name), i);
+		}
+		std::sort(sorted.begin(), sorted.end());
+	}
+
+	const LINK* Find(const char* name, size_t len) const
+	{
+		if (!name || !links) {
+			return nullptr;
+		}
+
+		std::string key(name, len);
+		StringToLower(key);
+		auto it = std::lower_bound(sorted.begin(), sorted.end(), std::make_pair(key, size_t(0)));
+		size_t found = size_t(-1);
+		for (; it != sorted.end() && it->first.compare(0, key.length(), key) == 0; ++it) {
+			found = std::min(found, it->second);
+		}
+		return found == size_t(-1) ? nullptr : links + found;
+	}
+};
+
+static LinkIndex<TriggerLink> triggerIndex;
+static LinkIndex<ActionLink> actionIndex;
+static LinkIndex<ObjectLink> objectIndex;
+static LinkIndex<IDSLink> idsIndex;
+
 static const TriggerLink* FindTrigger(const char* triggername)
 {
 	if (!triggername) {
 		return NULL;
 	}
-	int len = strlench( triggername, '(' );
-	for (int i = 0; triggernames[i].Name; i++) {
-		if (!strnicmp(triggernames[i].Name, triggername, len)) {
-			return triggernames + i;
-		}
-	}
-	return NULL;
+	return triggerIndex.Find(triggername, strlench(triggername, '('));
 }
 
 static const ActionLink* FindAction(const char* actionname)
@@ -1196,13 +1242,7 @@ static const ActionLink* FindAction(const char* actionname)
 	if (!actionname) {
 		return NULL;
 	}
-	int len = strlench( actionname, '(' );
-	for (int i = 0; actionnames[i].Name; i++) {
-		if (!strnicmp(actionnames[i].Name, actionname, len)) {
-			return actionnames + i;
-		}
-	}
-	return NULL;
+	return actionIndex.Find(actionname, strlench(actionname, '('));
 }
 
 static const ObjectLink* FindObject(const char* objectname)
@@ -1210,13 +1250,7 @@ static const ObjectLink* FindObject(const char* objectname)
 	if (!objectname) {
 		return NULL;
 	}
-	int len = strlench( objectname, '(' );
-	for (int i = 0; objectnames[i].Name; i++) {
-		if (!strnicmp(objectnames[i].Name, objectname, len)) {
-			return objectnames + i;
-		}
-	}
-	return NULL;
+	return objectIndex.Find(objectname, strlench(objectname, '('));
 }
 
 static const IDSLink* FindIdentifier(const char* idsname)
@@ -1224,17 +1258,95 @@ static const IDSLink* FindIdentifier(const char* idsname)
 	if (!idsname) {
 		return NULL;
 	}
-	int len = (int)strlen( idsname );
-	for (int i = 0; idsnames[i].Name; i++) {
-		if (!strnicmp( idsnames[i].Name, idsname, len )) {
-			return idsnames + i;
-		}
+	const IDSLink* link = idsIndex.Find(idsname, strlen(idsname));
+	if (link) {
+		return link;
 	}
 	
 	Log(WARNING, "GameScript", "Couldn't assign ids target: {}", idsname);
 	return nullptr;
 }
 
+// Compiled actions and triggers by their (lowercased) source text. Dialogs,
+// ActionOverride and the console compile the same few strings over and over,
+// so the callers get a copy of the cached one instead of a fresh parse.
+#define MAX_COMPILED_CACHE 4096
+static std::unordered_map<std::string, std::unique_ptr<Action>> compiledActions;
+static std::unordered_map<std::string, std::unique_ptr<Trigger>> compiledTriggers;
+static std::mutex compiledCacheLock;
+
+// Results of the pure, but expensive triggers (TF_MEMO) for the current tick.
+// Lots of blocks and actors ask the same creature counts each round, while
+// the answer can only change once something happens, so the memo is also
+// dropped whenever an action runs. Objects narrowed with the Last* filters
+// are never memoized, since those read state the sender itself changes.
+static std::unordered_map<std::string, int> triggerMemo;
+static ieDword triggerMemoTime = 0;
+static bool memoUnsafeFilters[MAX_OBJECTS];
+
+// Flattened BCS (0) and BS (1) scripts by their resref. Unlike the BcsCache
+// entries they stay after the last user is gone, so revisited areas don't
+// parse their scripts again, and with a ScriptCachePath neither do later
+// sessions. They are checked against the hash of the source, for overrides.
+static ResRefMap<CompiledScript> compiledScripts[2];
+
+static bool TriggerMemoKey(const Scriptable* Sender, const Trigger* trigger, std::string& key)
+{
+	const Object* oC = trigger->objectParameter;
+	if (oC) {
+		for (int filter : oC->objectFilters) {
+			if (filter > 0 && filter < MAX_OBJECTS && memoUnsafeFilters[filter]) return false;
+		}
+	}
+
+	auto append = [&key](const void* data, size_t size) {
+		key.append(static_cast<const char*>(data), size);
+	};
+	ieDword senderID = Sender->GetGlobalID();
+	append(&senderID, sizeof(senderID));
+	append(&trigger->triggerID, sizeof(trigger->triggerID));
+	append(&trigger->int0Parameter, sizeof(trigger->int0Parameter));
+	append(&trigger->int1Parameter, sizeof(trigger->int1Parameter));
+	append(&trigger->int2Parameter, sizeof(trigger->int2Parameter));
+	append(&trigger->pointParameter.x, sizeof(trigger->pointParameter.x));
+	append(&trigger->pointParameter.y, sizeof(trigger->pointParameter.y));
+	key.append(trigger->string0Parameter.CString()).push_back('\0');
+	key.append(trigger->string1Parameter.CString()).push_back('\0');
+	if (oC) {
+		append(oC->objectFields, sizeof(oC->objectFields));
+		append(oC->objectFilters, sizeof(oC->objectFilters));
+		append(&oC->objectRect.x, sizeof(oC->objectRect.x));
+		append(&oC->objectRect.y, sizeof(oC->objectRect.y));
+		append(&oC->objectRect.w, sizeof(oC->objectRect.w));
+		append(&oC->objectRect.h, sizeof(oC->objectRect.h));
+		key.append(oC->objectName.CString());
+	}
+	return true;
+}
+
+static int EvaluateMemoized(TriggerFunction func, Scriptable* Sender, const Trigger* trigger)
+{
+	const Game* game = core->GetGame();
+	std::string key;
+	if (!game || !TriggerMemoKey(Sender, trigger, key)) {
+		return func(Sender, trigger);
+	}
+
+	if (triggerMemoTime != game->GameTime) {
+		triggerMemo.clear();
+		triggerMemoTime = game->GameTime;
+	}
+	auto it = triggerMemo.find(key);
+	if (it != triggerMemo.end()) {
+		ScriptProfiler::CountMemo(true);
+		return it->second;
+	}
+	ScriptProfiler::CountMemo(false);
+	int ret = func(Sender, trigger);
+	triggerMemo.emplace(std::move(key), ret);
+	return ret;
+}
+
 /********************** Targets **********************************/
 
 int Targets::Count() const
@@ -1366,6 +1478,11 @@ void Targets::FilterObjectRect(const Object *oC)
 /** releasing global memory */
 static void CleanupIEScript()
 {
+	compiledActions.clear();
+	compiledTriggers.clear();
+	triggerMemo.clear();
+	compiledScripts[0].clear();
+	compiledScripts[1].clear();
 	triggersTable.reset();
 	actionsTable.reset();
 	objectsTable.reset();
@@ -1430,6 +1547,11 @@ void InitializeIEScript()
 	HasKaputz = core->HasFeature(GF_HAS_KAPUTZ);
 
 	InitScriptTables();
+	triggerIndex.Build(triggernames);
+	actionIndex.Build(actionnames);
+	objectIndex.Build(objectnames);
+	idsIndex.Build(idsnames);
+
 	int tT = core->LoadSymbol( "trigger" );
 	int aT = core->LoadSymbol( "action" );
 	int oT = core->LoadSymbol( "object" );
@@ -1707,6 +1829,7 @@ void InitializeIEScript()
 			}
 			continue;
 		}
+		memoUnsafeFilters[i] = strnicmp(objectsTable->GetStringIndex(j), "last", 4) == 0;
 		if (poi == NULL) {
 			objects[i] = NULL;
 			missing_objects.push_back(static_cast<int>(j));
@@ -1802,6 +1925,45 @@ GameScript::~GameScript(void)
 	}
 }
 
+// FNV-1a of the source and everything else the parse depends on
+static uint64_t ScriptSourceKey(DataStream* stream)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	auto mix = [&hash](const void* data, size_t len) {
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < len; i++) {
+			hash = (hash ^ bytes[i]) * 1099511628211ULL;
+		}
+	};
+
+	const int settings[] = {
+		ObjectFieldsCount, ExtraParametersCount, MaxObjectNesting,
+		HasAdditionalRect, HasTriggerPoint, NextTriggerObjectID
+	};
+	mix(settings, sizeof(settings));
+	mix(core->config.GameType, strlen(core->config.GameType));
+	// the AF_SCRIPTLEVEL actions are altered while parsing
+	mix(actionflags, sizeof(actionflags));
+
+	char buffer[4096];
+	strret_t len;
+	while ((len = stream->Read(buffer, sizeof(buffer))) > 0) {
+		mix(buffer, len);
+	}
+	stream->Rewind();
+	return hash;
+}
+
+static std::string ScriptCacheFile(const ResRef& resRef, bool AIScript)
+{
+	const char* dir = core->config.ScriptCachePath;
+	if (!dir[0]) return std::string();
+
+	char path[_MAX_PATH];
+	PathJoinExt(path, dir, ResRef::MakeLowerCase(resRef.CString()).CString(), AIScript ? "bs.gsc" : "bcs.gsc");
+	return path;
+}
+
 Script* GameScript::CacheScript(const ResRef& resRef, bool AIScript)
 {
 	char line[10];
@@ -1818,10 +1980,30 @@ Script* GameScript::CacheScript(const ResRef& resRef, bool AIScript)
 	if (!stream) {
 		return NULL;
 	}
+	uint64_t key = ScriptSourceKey(stream);
+
+	// seen before, in this session or an earlier one
+	CompiledScript& compiled = compiledScripts[AIScript][resRef];
+	if (compiled.GetKey() != key) {
+		std::string cacheFile = ScriptCacheFile(resRef, AIScript);
+		FileStream cached;
+		if (cacheFile.empty() || !cached.Open(cacheFile.c_str()) || !compiled.Load(&cached, key)) {
+			compiled = CompiledScript();
+		}
+	}
+	if (compiled.GetKey() == key) {
+		delete stream;
+		newScript = compiled.Instantiate();
+		BcsCache.SetAt(resRef, (void *) newScript);
+		ScriptDebugLog(ID_REFERENCE, "Caching {} for the {}-th time", resRef, BcsCache.RefCount(resRef));
+		return newScript;
+	}
+
 	stream->ReadLine( line, 10 );
 	if (strncmp( line, "SC", 2 ) != 0) {
 		Log(WARNING, "GameScript", "Not a Compiled Script file");
 		delete stream;
+		compiledScripts[AIScript].erase(resRef);
 		return nullptr;
 	}
 	newScript = new Script( );
@@ -1836,6 +2018,15 @@ Script* GameScript::CacheScript(const ResRef& resRef, bool AIScript)
 		stream->ReadLine( line, 10 );
 	}
 	delete stream;
+
+	compiled = CompiledScript(*newScript, key);
+	std::string cacheFile = ScriptCacheFile(resRef, AIScript);
+	if (!cacheFile.empty()) {
+		FileStream cached;
+		if (!cached.Create(cacheFile.c_str()) || !compiled.Save(&cached)) {
+			Log(WARNING, "GameScript", "Couldn't write the script cache {}.", cacheFile);
+		}
+	}
 	return newScript;
 }
 
@@ -2019,6 +2210,8 @@ bool GameScript::Update(bool *continuing, bool *done)
 		return false;
 	}
 
+	ScriptProfiler::Scope profile(Name);
+
 	bool continueExecution = false;
 	if (continuing) continueExecution = *continuing;
 
@@ -2316,7 +2509,13 @@ int Trigger::Evaluate(Scriptable *Sender) const
 	}
 	ScriptDebugLog(ID_TRIGGERS, "Executing trigger code: {:#x} {} (Sender: {} / {})", triggerID, tmpstr, Sender->GetScriptName(), fmt::WideToChar{Sender->GetName()});
 
-	int ret = func( Sender, this );
+	ScriptProfiler::Scope profile(triggerID);
+	int ret;
+	if (triggerflags[triggerID] & TF_MEMO) {
+		ret = EvaluateMemoized(func, Sender, this);
+	} else {
+		ret = func(Sender, this);
+	}
 	if (flags & TF_NEGATE) {
 		return !ret;
 	}
@@ -2418,6 +2617,11 @@ void GameScript::ExecuteAction(Scriptable* Sender, Action* aC)
 {
 	int actionID = aC->actionID;
 
+	// whatever it does may change what the memoized triggers would see
+	if (!triggerMemo.empty()) {
+		triggerMemo.clear();
+	}
+
 	// reallow area scripts after us, if they were disabled
 	if (aC->flags & ACF_REALLOW_SCRIPTS) {
 		core->GetGameControl()->SetDialogueFlags(DF_POSTPONE_SCRIPTS, BitOp::NAND);
@@ -2489,11 +2693,8 @@ void GameScript::ExecuteAction(Scriptable* Sender, Action* aC)
 	}
 }
 
-Trigger* GenerateTrigger(std::string string)
+static Trigger* GenerateTriggerUncached(const std::string& string)
 {
-	StringToLower(string);
-	ScriptDebugLog(ID_TRIGGERS, "Compiling: {}", string);
-
 	int negate = 0;
 	strpos_t start = 0;
 	if (string[start] == '!') {
@@ -2516,12 +2717,32 @@ Trigger* GenerateTrigger(std::string string)
 	return trigger;
 }
 
-Action* GenerateAction(std::string actionString)
+Trigger* GenerateTrigger(std::string string)
+{
+	StringToLower(string);
+	ScriptDebugLog(ID_TRIGGERS, "Compiling: {}", string);
+
+	{
+		std::lock_guard<std::mutex> lock(compiledCacheLock);
+		auto cached = compiledTriggers.find(string);
+		if (cached != compiledTriggers.end()) {
+			return TriggerCopy(cached->second.get());
+		}
+	}
+	Trigger* trigger = GenerateTriggerUncached(string);
+	if (trigger) {
+		std::lock_guard<std::mutex> lock(compiledCacheLock);
+		if (compiledTriggers.size() >= MAX_COMPILED_CACHE) {
+			compiledTriggers.clear();
+		}
+		compiledTriggers[std::move(string)].reset(TriggerCopy(trigger));
+	}
+	return trigger;
+}
+
+static Action* GenerateActionUncached(const std::string& actionString)
 {
 	Action* action = NULL;
-	
-	StringToLower(actionString);
-	ScriptDebugLog(ID_ACTIONS, "Compiling: {}", actionString);
 
 	int len = strlench(actionString.c_str(),'(')+1; //including (
 	const char *src = &actionString[len];
@@ -2552,6 +2773,29 @@ Action* GenerateAction(std::string actionString)
 	return action;
 }
 
+Action* GenerateAction(std::string actionString)
+{
+	StringToLower(actionString);
+	ScriptDebugLog(ID_ACTIONS, "Compiling: {}", actionString);
+
+	{
+		std::lock_guard<std::mutex> lock(compiledCacheLock);
+		auto cached = compiledActions.find(actionString);
+		if (cached != compiledActions.end()) {
+			return ParamCopy(cached->second.get());
+		}
+	}
+	Action* action = GenerateActionUncached(actionString);
+	if (action) {
+		std::lock_guard<std::mutex> lock(compiledCacheLock);
+		if (compiledActions.size() >= MAX_COMPILED_CACHE) {
+			compiledActions.clear();
+		}
+		compiledActions[std::move(actionString)].reset(ParamCopy(action));
+	}
+	return action;
+}
+
 Action *GenerateActionDirect(std::string string, const Scriptable *object)
 {
 	Action* action = GenerateAction(std::move(string));
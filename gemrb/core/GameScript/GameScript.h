@@ -444,6 +444,7 @@ using IDSFunction = int (*)(const Actor*, int parameter);
 #define TF_CONDITION    1 //this isn't a trigger, just a condition (0x4000)
 #define TF_SAVED        2 //trigger is in svtriobj.ids
 #define TF_MERGESTRINGS 8 //same value as actions' mergestring
+#define TF_MEMO         16 //pure, so its result can be reused within a tick
 
 struct TriggerLink {
 	const char* Name;
@@ -0,0 +1,137 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#include "GameScript/ScriptProfiler.h"
+
+#include "GameScript/GSUtils.h"
+#include "Logging/Logging.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace GemRB {
+
+bool ScriptProfiler::enabled = false;
+
+static ResRefMap<ScriptProfiler::Stats> scriptStats;
+static ScriptProfiler::Stats triggerStats[MAX_TRIGGERS];
+static uint64_t memoHits = 0;
+static uint64_t memoMisses = 0;
+
+ScriptProfiler::Scope::Scope(const ResRef& scriptName)
+{
+	if (!enabled) return;
+	script = &scriptName;
+	start = Clock::now();
+}
+
+ScriptProfiler::Scope::Scope(unsigned short trigger)
+{
+	if (!enabled || trigger >= MAX_TRIGGERS) return;
+	triggerID = trigger;
+	start = Clock::now();
+}
+
+ScriptProfiler::Scope::~Scope()
+{
+	// also covers being disabled while running
+	if (!enabled) return;
+
+	Stats* stats;
+	if (script) {
+		stats = &scriptStats[*script];
+	} else if (triggerID >= 0) {
+		stats = &triggerStats[triggerID];
+	} else {
+		return;
+	}
+	stats->time += Clock::now() - start;
+	stats->count++;
+}
+
+void ScriptProfiler::Enable(bool enable)
+{
+	if (enable && !enabled) {
+		Reset();
+	}
+	enabled = enable;
+}
+
+void ScriptProfiler::Reset()
+{
+	scriptStats.clear();
+	std::fill(std::begin(triggerStats), std::end(triggerStats), Stats());
+	memoHits = 0;
+	memoMisses = 0;
+}
+
+void ScriptProfiler::CountMemo(bool hit)
+{
+	if (hit) {
+		memoHits++;
+	} else {
+		memoMisses++;
+	}
+}
+
+template<class KEY>
+static void DumpStats(std::vector<std::pair<KEY, ScriptProfiler::Stats>>& entries, size_t limit, const char* what)
+{
+	std::sort(entries.begin(), entries.end(), [](const std::pair<KEY, ScriptProfiler::Stats>& a, const std::pair<KEY, ScriptProfiler::Stats>& b) {
+		return a.second.time > b.second.time;
+	});
+	if (entries.size() > limit) {
+		entries.resize(limit);
+	}
+
+	Log(MESSAGE, "ScriptProfiler", "{:<32} {:>10} {:>12} {:>10}", what, "count", "total ms", "avg us");
+	for (const auto& entry : entries) {
+		double total = std::chrono::duration<double, std::milli>(entry.second.time).count();
+		Log(MESSAGE, "ScriptProfiler", "{:<32} {:>10} {:>12.3f} {:>10.2f}", entry.first, entry.second.count,
+			total, total * 1000.0 / entry.second.count);
+	}
+}
+
+void ScriptProfiler::Dump(size_t limit)
+{
+	std::vector<std::pair<std::string, Stats>> scripts;
+	for (const auto& entry : scriptStats) {
+		scripts.emplace_back(entry.first.CString(), entry.second);
+	}
+	DumpStats(scripts, limit, "script");
+
+	std::vector<std::pair<std::string, Stats>> triggers;
+	for (int i = 0; i < MAX_TRIGGERS; i++) {
+		if (!triggerStats[i].count) continue;
+
+		const char* name = triggersTable ? triggersTable->GetValue(i) : nullptr;
+		if (!name && triggersTable) {
+			name = triggersTable->GetValue(i | 0x4000);
+		}
+		std::string label = name ? std::string(name, strlench(name, '(')) : fmt::format("{:#x}", i);
+		triggers.emplace_back(std::move(label), triggerStats[i]);
+	}
+	DumpStats(triggers, limit, "trigger");
+
+	uint64_t lookups = memoHits + memoMisses;
+	Log(MESSAGE, "ScriptProfiler", "Trigger memo: {} hits out of {} lookups", memoHits, lookups);
+}
+
+}
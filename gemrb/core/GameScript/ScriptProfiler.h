@@ -0,0 +1,74 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef SCRIPTPROFILER_H
+#define SCRIPTPROFILER_H
+
+#include "exports.h"
+
+#include "Resource.h"
+
+#include <chrono>
+#include <cstdint>
+
+namespace GemRB {
+
+// Opt-in accounting of where the script rounds spend their time: per script
+// (the whole GameScript::Update, actions included) and per trigger. Meant to
+// find the (mod) scripts eating the frame budget, so it costs next to nothing
+// while disabled.
+class GEM_EXPORT ScriptProfiler {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	struct Stats {
+		Clock::duration time {};
+		uint64_t count = 0;
+	};
+
+	// times its own lifetime, if the profiler is enabled
+	class Scope {
+		const ResRef* script = nullptr;
+		int triggerID = -1;
+		Clock::time_point start;
+
+	public:
+		explicit Scope(const ResRef& scriptName);
+		explicit Scope(unsigned short trigger);
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+		~Scope();
+	};
+
+	static bool IsEnabled() { return enabled; }
+	// enabling also drops the previous results
+	static void Enable(bool enable);
+	static void Reset();
+	static void CountMemo(bool hit);
+	// logs the scripts and triggers sorted by the time spent in them
+	static void Dump(size_t limit);
+
+private:
+	static bool enabled;
+};
+
+}
+
+#endif
@@ -128,11 +128,15 @@ bool GlobalTimer::UpdateViewport(tick_t thisTime)
 }
 
 bool GlobalTimer::Update()
+{
+	return Update(GetMilliseconds());
+}
+
+bool GlobalTimer::Update(tick_t thisTime)
 {
 	Map *map;
 	Game *game;
 	const GameControl* gc;
-	tick_t thisTime = GetMilliseconds();
 
 	if (!startTime) {
 		goto end;
@@ -54,6 +54,8 @@ public:
 
 	void Freeze();
 	bool Update();
+	// the same, but at the given time instead of now
+	bool Update(tick_t thisTime);
 	bool ViewportIsMoving() const;
 	void DoStep(int count);
 	void SetMoveViewPort(Point p, int spd, bool center);
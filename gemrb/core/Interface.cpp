@@ -29,6 +29,7 @@
 #include "AmbientMgr.h"
 #include "AnimationMgr.h"
 #include "ArchiveImporter.h"
+#include "AreaPrefetcher.h"
 #include "Calendar.h"
 #include "DataFileMgr.h"
 #include "DialogHandler.h"
@@ -38,6 +39,7 @@
 #include "EffectQueue.h"
 #include "Factory.h"
 #include "FontManager.h"
+#include "FrameProfiler.h"
 #include "Game.h"
 #include "GameScript/GameScript.h"
 #include "ItemMgr.h"
@@ -46,6 +48,7 @@
 #include "MoviePlayer.h"
 #include "MusicMgr.h"
 #include "Palette.h"
+#include "PathRequests.h"
 #ifndef STATIC_LINK
 #include "PluginLoader.h"
 #endif
@@ -76,6 +79,7 @@
 #include "RNG.h"
 #include "Scriptable/Container.h"
 #include "Streams/FileStream.h"
+#include "Streams/RecordLayout.h"
 #include "System/FileFilters.h"
 
 #include <utility>
@@ -259,6 +263,11 @@ Interface::Interface() noexcept
 
 Interface::~Interface() noexcept
 {
+	// the worker must not outlive anything it reads resources with
+	if (areaPrefetcher) {
+		areaPrefetcher->Stop();
+	}
+
 	WindowManager::CursorMouseUp = NULL;
 	WindowManager::CursorMouseDown = NULL;
 
@@ -611,12 +620,19 @@ void Interface::Main()
 	fpsRgn.x = 5;
 	fpsRgn.y = 0;
 
+	if (config.BenchmarkTicks > 0) {
+		RunBenchmark();
+		QuitGame(0);
+		return;
+	}
+
 	tick_t frame = 0;
 	tick_t time = GetMilliseconds();
 	tick_t timebase = time;
 	double frames = 0.0;
 
 	do {
+		FrameProfiler::NextFrame();
 		for (auto it = timers.begin(); it != timers.end();) {
 			if (it->IsRunning()) {
 				it->Update(time);
@@ -639,7 +655,7 @@ void Interface::Main()
 			HandleGUIBehaviour(gamectrl);
 		}
 
-		GameLoop();
+		GameLoop(GetMilliseconds());
 		// TODO: find other animations that need to be synchronized
 		// we can create a manager for them and everything can be updated at once
 		GlobalColorCycle.AdvanceTime(time);
@@ -657,10 +673,122 @@ void Interface::Main()
 			video->DrawRect( fpsRgn, ColorBlack );
 			fps->Print(fpsRgn, String(fpsstring), IE_FONT_ALIGN_MIDDLE | IE_FONT_SINGLE_LINE, {ColorWhite, ColorBlack});
 		}
+		if (config.DrawProfile && FrameProfiler::IsEnabled()) {
+			auto lock = winmgr->DrawHUD();
+			DrawFrameProfile(fps, Region(5, 30, 240, 0));
+		}
 	} while (video->SwapBuffers() == GEM_OK && !(QuitFlag&QF_KILL));
 	QuitGame(0);
 }
 
+// Runs the simulation without drawing or waiting, one game tick per round,
+// from the BenchmarkSave save game if there is one. Without it only the
+// engine itself runs, which is what the minimal test data allows.
+// Each round goes through the flag handling and GameLoop like in Main, so
+// frozen scripts and map changes behave the same; only input, the gui
+// behaviour and drawing are left out.
+void Interface::RunBenchmark()
+{
+	// no main menu
+	QuitFlag &= ~QF_CHANGESCRIPT;
+
+	if (!config.BenchmarkSave.empty()) {
+		Holder<SaveGame> save = GetSaveGameIterator()->GetSaveGame(config.BenchmarkSave.c_str());
+		if (!save) {
+			Log(ERROR, "Benchmark", "Save game {} not found.", config.BenchmarkSave);
+			return;
+		}
+		SetupLoadGame(save, 0);
+		QuitFlag |= QF_ENTERGAME;
+		HandleFlags();
+	} else {
+		Log(WARNING, "Benchmark", "No BenchmarkSave set, running without a game.");
+	}
+
+	bool profiling = FrameProfiler::IsEnabled();
+	FrameProfiler::Enable(true);
+
+	tick_t interval = Time.Ticks2Ms(1);
+	tick_t clock = GetMilliseconds();
+	int ticks = 0;
+	using Clock = std::chrono::steady_clock;
+	Clock::time_point start = Clock::now();
+	bool hadGame = game != nullptr;
+	for (; ticks < config.BenchmarkTicks; ticks++) {
+		while (QuitFlag && QuitFlag != QF_KILL) {
+			HandleFlags();
+		}
+		if (QuitFlag & QF_KILL) {
+			Log(WARNING, "Benchmark", "Stopped early, the engine was asked to exit.");
+			break;
+		}
+		if (hadGame && !game) {
+			Log(WARNING, "Benchmark", "Stopped early, the game was quit.");
+			break;
+		}
+
+		FrameProfiler::NextFrame();
+		clock += interval;
+		GameLoop(clock);
+	}
+	FrameProfiler::NextFrame();
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	const FrameProfiler::Frame& total = FrameProfiler::GetTotal();
+	Log(MESSAGE, "Benchmark", "{} ticks in {:.3f}s, {:.1f} ticks per second (seed {})",
+		ticks, seconds, seconds > 0 ? ticks / seconds : 0.0, config.BenchmarkSeed);
+	for (int s = 0; s < FrameProfiler::SectionCount; s++) {
+		if (!total.calls[s]) continue;
+		double ms = std::chrono::duration<double, std::milli>(total.sections[s]).count();
+		Log(MESSAGE, "Benchmark", "{:<12} {:>10.2f}ms {:>8} calls {:>8.3f}ms per tick",
+			FrameProfiler::GetSectionName(FrameProfiler::Section(s)), ms, total.calls[s], ticks ? ms / ticks : 0.0);
+	}
+	FrameProfiler::Enable(profiling);
+}
+
+// the section averages over the last second or so, with a graph of the frame times below
+void Interface::DrawFrameProfile(const Font* font, const Region& rgn) const
+{
+	static const int AVERAGED = 60;
+	static const int GRAPHED = 120;
+	static const int GRAPH_HEIGHT = 50; // 1px per ms
+
+	using FP = FrameProfiler;
+	FP::Frame average = FP::GetAverage(AVERAGED);
+	auto ms = [](FP::Clock::duration time) {
+		return std::chrono::duration<double, std::milli>(time).count();
+	};
+
+	double worst = 0;
+	for (int i = 0; i < AVERAGED && FP::GetFrame(i); i++) {
+		worst = std::max(worst, ms(FP::GetFrame(i)->length));
+	}
+	std::string text = fmt::format("frame {:.2f}ms, max {:.2f}ms", ms(average.length), worst);
+	for (int s = 0; s < FP::SectionCount; s++) {
+		if (!average.sections[s].count()) continue;
+		text += fmt::format("\n{} {:.2f}ms", FP::GetSectionName(FP::Section(s)), ms(average.sections[s]));
+	}
+
+	int lines = static_cast<int>(std::count(text.begin(), text.end(), '\n')) + 1;
+	Region textRgn(rgn.origin, Size(rgn.w, lines * font->LineHeight));
+	video->DrawRect(textRgn, ColorBlack);
+	// all ascii
+	font->Print(textRgn, String(text.begin(), text.end()), IE_FONT_ALIGN_LEFT | IE_FONT_ALIGN_TOP, {ColorWhite, ColorBlack});
+
+	Region graphRgn(rgn.x, textRgn.y + textRgn.h, GRAPHED, GRAPH_HEIGHT);
+	video->DrawRect(graphRgn, ColorBlack);
+	double budget = config.FrameBudget > 0 ? config.FrameBudget : 1000.0 / 60;
+	for (int i = 0; i < GRAPHED; i++) {
+		const FP::Frame* frame = FP::GetFrame(i);
+		if (!frame) break;
+		double length = ms(frame->length);
+		int height = std::min(int(length), GRAPH_HEIGHT);
+		int x = graphRgn.x + graphRgn.w - 1 - i;
+		int bottom = graphRgn.y + graphRgn.h - 1;
+		video->DrawLine(Point(x, bottom), Point(x, bottom - height), length > budget ? ColorRed : ColorGreen);
+	}
+}
+
 int Interface::LoadSprites()
 {
 	if (!IsAvailable( IE_2DA_CLASS_ID )) {
@@ -798,14 +926,23 @@ int Interface::Init(const InterfaceConfig* cfg)
 			var ( atoi( value ) ); \
 		value = nullptr
 
+	CONFIG_INT("AreaPrefetchBudget", config.AreaPrefetchBudget =);
+	CONFIG_INT("BenchmarkSeed", config.BenchmarkSeed =);
+	CONFIG_INT("BenchmarkTicks", config.BenchmarkTicks =);
+	CONFIG_INT("TileCacheBudget", config.TileCacheBudget =);
+	CONFIG_INT("SoundCacheBudget", config.SoundCacheBudget =);
 	CONFIG_INT("Bpp", config.Bpp =);
 	CONFIG_INT("CaseSensitive", config.CaseSensitive =);
 	CONFIG_INT("DoubleClickDelay", EventMgr::DCDelay = );
 	CONFIG_INT("DrawFPS", config.DrawFPS =);
+	CONFIG_INT("DrawProfile", config.DrawProfile =);
 	CONFIG_INT("EnableCheatKeys", EnableCheatKeys);
+	CONFIG_INT("FrameBudget", config.FrameBudget =);
 	CONFIG_INT("GCDebug", GameControl::DebugFlags = );
 	CONFIG_INT("Height", config.Height =);
+	CONFIG_INT("HierarchicalPathfinding", config.HierarchicalPathfinding =);
 	CONFIG_INT("KeepCache", config.KeepCache =);
+	CONFIG_INT("PathfindingThreads", config.PathfindingThreads =);
 	CONFIG_INT("MaxPartySize", config.MaxPartySize =);
 	config.MaxPartySize = std::min(std::max(1, config.MaxPartySize), 10);
 	vars->SetAt("MaxPartySize", config.MaxPartySize); // for simple GUIScript access
@@ -888,6 +1025,7 @@ int Interface::Init(const InterfaceConfig* cfg)
 
 	CONFIG_PATH("CachePath", config.CachePath, "./Cache2");
 	FixPath(config.CachePath, false);
+	CONFIG_PATH("ScriptCachePath", config.ScriptCachePath, "");
 
 	// AppImage doesn't support relative urls at all
 	// we set the path to the data dir to cover unhardcoded and co,
@@ -961,8 +1099,18 @@ int Interface::Init(const InterfaceConfig* cfg)
 	CONFIG_STRING("AudioDriver", config.AudioDriverName);
 	CONFIG_STRING("VideoDriver", config.VideoDriverName);
 	CONFIG_STRING("Encoding", config.Encoding);
+	CONFIG_STRING("BenchmarkSave", config.BenchmarkSave);
 #undef CONFIG_STRING
 
+	if (config.BenchmarkTicks > 0) {
+		// no window, no sound and the same random numbers every run
+		// the generators are per thread and only this one is seeded; that's
+		// enough, since the path workers never draw random numbers
+		config.VideoDriverName = "none";
+		config.AudioDriverName = "none";
+		RNG::getInstance().seed(config.BenchmarkSeed);
+	}
+
 	value = cfg->GetValueForKey("ModPath");
 	if (value) {
 		for (char *path = strtok((char*)value,SPathListSeparator);
@@ -1012,6 +1160,11 @@ int Interface::Init(const InterfaceConfig* cfg)
 	}
 	if (!config.KeepCache) DelTree((const char *) config.CachePath, false);
 
+	if (config.ScriptCachePath[0] && !MakeDirectories(config.ScriptCachePath)) {
+		Log(WARNING, "Core", "Unable to create the script cache directory '{}', not using it.", config.ScriptCachePath);
+		config.ScriptCachePath[0] = '\0';
+	}
+
 	// potentially disable logging before plugins are loaded (the log file is a plugin)
 	value = cfg->GetValueForKey("Logging");
 	if (value) ToggleLogging(atoi(value));
@@ -1167,6 +1320,18 @@ int Interface::Init(const InterfaceConfig* cfg)
 	// Purposely add the font directory last since we will only ever need it at engine load time.
 	if (config.CustomFontPath[0]) gamedata->AddSource(config.CustomFontPath, "CustomFonts", PLUGIN_RESOURCE_DIRECTORY);
 
+	// goes before everything else, but only ever has what the others would return
+	if (config.AreaPrefetchBudget > 0) {
+		areaPrefetcher = std::make_shared<AreaPrefetcher>(size_t(config.AreaPrefetchBudget) * 1024 * 1024);
+		gamedata->AddSourceFirst(areaPrefetcher);
+	}
+	if (config.PathfindingThreads > 0) {
+		pathWorkers = std::make_shared<PathWorkers>(config.PathfindingThreads);
+	}
+	TileOverlay::SetCacheBudget(size_t(std::max(config.TileCacheBudget, 0)) * 1024 * 1024);
+	FrameProfiler::SetBudget(config.FrameBudget);
+	FrameProfiler::Enable(config.FrameBudget > 0 || config.DrawProfile);
+
 	Log(MESSAGE, "Core", "Reading Game Options...");
 	if (!LoadGemRBINI()) {
 		Log(FATAL, "Core", "Cannot Load INI.");
@@ -2163,15 +2328,16 @@ bool Interface::IsFreezed() const
 	return !update_scripts;
 }
 
-void Interface::GameLoop(void)
+void Interface::GameLoop(tick_t time)
 {
+	PROFILE_SCOPE(GameLoop);
 	update_scripts = false;
 	GameControl *gc = GetGameControl();
 	if (gc) {
 		update_scripts = !(gc->GetDialogueFlags() & DF_FREEZE_SCRIPTS);
 	}
 
-	bool do_update = GSUpdate(update_scripts);
+	bool do_update = GSUpdate(update_scripts, time);
 
 	if (game) {
 		if (gc && !game->selected.empty()) {
@@ -2708,10 +2874,10 @@ bool Interface::InCutSceneMode() const
 }
 
 /** Updates the Game Script Engine State */
-bool Interface::GSUpdate(bool update)
+bool Interface::GSUpdate(bool update, tick_t time)
 {
 	if (update) {
-		return timer.Update();
+		return timer.Update(time);
 	} else {
 		timer.Freeze();
 		return false;
@@ -2745,7 +2911,7 @@ void Interface::QuitGame(int BackToMain)
 	if (BackToMain) {
 		SetNextScript("Start");
 	}
-	GSUpdate(true);
+	GSUpdate(true, GetMilliseconds());
 }
 
 void Interface::SetupLoadGame(Holder<SaveGame> sg, int ver_override)
@@ -3505,14 +3671,17 @@ CREItem *Interface::ReadItem(DataStream *str) const
 	return NULL;
 }
 
+// the same 20 bytes in CRE, ARE, GAM and STO files
+using CREItemLayout = RecordLayout<CREItem,
+	RECORD_FIELD(CREItem, ItemResRef), RECORD_FIELD(CREItem, Expired),
+	RECORD_FIELD(CREItem, Usages), RECORD_FIELD(CREItem, Flags)>;
+static_assert(CREItemLayout::Size == 20, "CREItem records are 20 bytes");
+
 CREItem *Interface::ReadItem(DataStream *str, CREItem *itm) const
 {
-	str->ReadResRef( itm->ItemResRef );
-	str->ReadWord(itm->Expired);
-	str->ReadWord(itm->Usages[0]);
-	str->ReadWord(itm->Usages[1]);
-	str->ReadWord(itm->Usages[2]);
-	str->ReadDword(itm->Flags);
+	if (!CREItemLayout::Read(str, *itm)) {
+		return NULL;
+	}
 	if (ResolveRandomItem(itm)) {
 		SanitizeItem(itm);
 		return itm;
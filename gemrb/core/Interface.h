@@ -56,6 +56,7 @@
 namespace GemRB {
 
 class Actor;
+class AreaPrefetcher;
 class Audio;
 class CREItem;
 class Calendar;
@@ -76,6 +77,7 @@ class Label;
 class Map;
 class MusicMgr;
 class Palette;
+class PathWorkers;
 using PaletteHolder = Holder<Palette>;
 class ProjectileServer;
 class SPLExtHeader;
@@ -308,6 +310,7 @@ struct CFGConfigData {
 	char GameCharactersPath[_MAX_PATH]{};
 	char SavePath[_MAX_PATH]{};
 	char CachePath[_MAX_PATH]{};
+	char ScriptCachePath[_MAX_PATH]{};
 	std::vector<std::string> CD[MAX_CD];
 	std::vector<std::string> ModPath;
 	char CustomFontPath[_MAX_PATH]{};
@@ -334,11 +337,22 @@ struct CFGConfigData {
 	int Height = 480;
 	int Bpp = 32;
 	bool DrawFPS = false;
+	bool DrawProfile = false;
+	int FrameBudget = 0; // in ms, longer frames get logged
 	int debugMode = 0;
 	bool CheatFlag = false; /** Cheats enabled? */
 	int MaxPartySize = 6;
 
 	bool KeepCache = false;
+	bool HierarchicalPathfinding = false;
+	int PathfindingThreads = 0; // 0 finds paths right away, otherwise they're queued, see PathRequests
+	int AreaPrefetchBudget = 64; // in MB, 0 disables the area prefetcher
+	int TileCacheBudget = 32; // in MB, 0 keeps all decoded area tiles
+	int SoundCacheBudget = 32; // in MB
+	// headless runs of a fixed number of game ticks, see RunBenchmark
+	int BenchmarkTicks = 0;
+	int BenchmarkSeed = 1;
+	std::string BenchmarkSave;
 	bool MultipleQuickSaves = false;
 	// once GemRB own format is working well, this might be set to 0
 	int SaveAsOriginal = 1; // if true, saves files in compatible mode
@@ -370,6 +384,8 @@ private:
 	Variables * tokens;
 	Variables * lists;
 	std::shared_ptr<MusicMgr> music;
+	std::shared_ptr<AreaPrefetcher> areaPrefetcher;
+	std::shared_ptr<PathWorkers> pathWorkers;
 	std::vector<Symbol> symbols;
 	std::shared_ptr<DataFileMgr> INIparty;
 	std::shared_ptr<DataFileMgr> INIbeasts;
@@ -530,8 +546,8 @@ public:
 	void SetCutSceneMode(bool active);
 	/** returns true if in cutscene mode */
 	bool InCutSceneMode() const;
-	/** Updates the Game Script Engine State */
-	bool GSUpdate(bool update);
+	/** Updates the Game Script Engine State, as of time */
+	bool GSUpdate(bool update, tick_t time);
 	/** Get the Party INI Interpreter */
 	DataFileMgr * GetPartyINI() const
 	{
@@ -570,6 +586,10 @@ public:
 	WorldMap* GetWorldMap() const;
 	WorldMap* GetWorldMap(const ResRef& area) const;
 	GameControl *GetGameControl() const { return game ? gamectrl : nullptr; }
+	/** the background reader of area resources, if enabled */
+	AreaPrefetcher* GetAreaPrefetcher() const { return areaPrefetcher.get(); }
+	/** the threads solving the queued path searches, if enabled */
+	PathWorkers* GetPathWorkers() const { return pathWorkers.get(); }
 	/** if backtomain is not null then goes back to main screen */
 	void QuitGame(int backtomain);
 	/** sets up load game */
@@ -755,8 +775,12 @@ private:
 	void HandleGUIBehaviour(GameControl*);
 	/** Creates a game control, closes all other windows */
 	GameControl* StartGameControl();
-	/** Executes everything (non graphical) in the main game loop */
-	void GameLoop(void);
+	/** Executes everything (non graphical) in the main game loop, as of time */
+	void GameLoop(tick_t time);
+	/** Runs BenchmarkTicks game ticks as fast as possible and reports the timings */
+	void RunBenchmark();
+	/** Draws the frame profiler overlay below the fps counter */
+	void DrawFrameProfile(const Font* font, const Region& rgn) const;
 	/** the internal (without cache) part of GetListFrom2DA */
 	std::vector<ieDword>* GetListFrom2DAInternal(const ResRef& resref);
 
@@ -81,6 +81,9 @@ CFGConfig::CFGConfig(int argc, char *argv[])
 		} else if (stricmp(argv[i], "-q") == 0) {
 			// quiet mode
 			SetKeyValuePair("AudioDriver", "none");
+		} else if (stricmp(argv[i], "-b") == 0 && i + 1 < argc) {
+			// headless benchmark, see Interface::RunBenchmark
+			SetKeyValuePair("BenchmarkTicks", argv[++i]);
 		} else {
 			// assume a path was passed, soft force configless startup
 			SetKeyValuePair("GamePath", argv[i]);
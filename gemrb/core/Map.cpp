@@ -26,6 +26,7 @@
 #include "AmbientMgr.h"
 #include "Audio.h"
 #include "DisplayMessage.h"
+#include "FrameProfiler.h"
 #include "Game.h"
 #include "GameData.h"
 #include "IniSpawn.h"
@@ -53,9 +54,13 @@
 
 #include <array>
 #include <cassert>
+#include <chrono>
+#include <cstring>
 #include <limits>
+#include <random>
 #include <utility>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace GemRB {
 
@@ -311,12 +316,13 @@ private:
 	}
 };
 
+// C++11 needs this, since std::min binds it to a reference
+constexpr int Explore::MaxVisibility;
+
 // TODO: fix this hardcoded resource reference
 static const ResRef PortalResRef = "EF03TPR3";
 static unsigned int PortalTime = 15;
 
-static ieDword oldGameTime = 0;
-
 static inline AnimationObjectType SelectObject(const Actor *actor, int q, const AreaAnimation *a, const VEFObject *sca, const Particles *spark, const Projectile *pro, const Container *pile)
 {
 	int actorh;
@@ -407,6 +413,7 @@ reverb(*this)
 {
 	area = this;
 	MasterArea = core->GetGame()->MasterArea(scriptName.CString());
+	actorGrid.Resize(GetSize());
 }
 
 Map::~Map(void)
@@ -456,6 +463,8 @@ Map::~Map(void)
 void Map::SetTileMapProps(TileProps props)
 {
 	tileProps = std::move(props);
+	pathClusters.Reset();
+	losRevision++;
 }
 
 void Map::AutoLockDoors() const
@@ -637,9 +646,10 @@ void Map::UpdateScripts()
 	for (auto actor : actors) {
 		if (actor->InParty) {
 			has_pcs = true;
-			break;
 		}
 	}
+	// the paths queued last tick
+	pathRequests.Deliver(*this);
 
 	GenerateQueues();
 	SortQueues();
@@ -837,6 +847,11 @@ void Map::UpdateScripts()
 	UpdateSpawns();
 	GenerateQueues();
 	SortQueues();
+
+	PathWorkers* pathWorkers = core->GetPathWorkers();
+	if (pathWorkers) {
+		pathRequests.Solve(*this, *pathWorkers);
+	}
 }
 
 ResRef Map::ResolveTerrainSound(const ResRef& resref, const Point &p) const
@@ -1313,97 +1328,104 @@ VEFObject *Map::GetNextScriptedAnimation(const scaIterator &iter) const
 	return *iter;
 }
 
-//Draw the game area (including overlays, actors, animations, weather)
-void Map::DrawMap(const Region& viewport, uint32_t dFlags)
+// apparently birds and the dead are always visible?
+static bool ShowsActor(const Map* map, const Actor* actor)
 {
-	assert(TMap);
-	debugFlags = dFlags;
+	if (!map->IsExplored(actor->Pos)) {
+		return false;
+	}
+	return map->IsVisible(actor->Pos) || actor->Modified[IE_DONOTJUMP] & DNJ_BIRD || actor->GetInternalFlag() & IF_REALLYDIED;
+}
 
-	Game *game = core->GetGame();
-	ieDword gametime = game->GameTime;
-	bool timestop = game->IsTimestopActive();
+void Map::UpdateScene()
+{
+	ieDword gametime = core->GetGame()->GameTime;
 
 	//area specific spawn.ini files (a PST feature)
 	if (INISpawn) {
 		INISpawn->CheckSpawn();
 	}
 
-	// Map Drawing Strategy
-	// 1. Draw background
-	// 2. Draw overlays (weather)
-	// 3. Create a stencil set: a WF_COVERANIMS wall stencil and an opaque wall stencil
-	// 4. set the video stencil buffer to animWallStencil
-	// 5. Draw background animations (BlitFlags::STENCIL_GREEN)
-	// 6. set the video stencil buffer to wallStencil
-	// 7. draw scriptables (depending on scriptable->ForceDither() return value)
-	// 8. draw fog (BlitFlags::BLENDED)
-	// 9. draw text (BlitFlags::BLENDED)
+	int q = PR_DISPLAY;
+	size_t index = queue[q].size();
+	Actor* actor = GetNextActor(q, index);
+	while (actor) {
+		bool visible = actor->GetAnims() && ShowsActor(this, actor);
+		if (!visible || (actor->GetInternalFlag() & (IF_REALLYDIED | IF_ACTIVE)) == (IF_REALLYDIED | IF_ACTIVE)) {
+			actor->SetInternalFlag(IF_TRIGGER_AP, BitOp::NAND);
+			// turning actor inactive if there is no action next turn
+			actor->HibernateIfAble();
+		}
+		actor = GetNextActor(q, index);
+	}
 
-	//Blit the Background Map Animations (before actors)
-	Video* video = core->GetVideoDriver();
-	int bgoverride = false;
+	if (gametime <= sceneTime) {
+		return;
+	}
+	sceneTime = gametime;
 
-	if (Background) {
-		if (BgDuration < gametime) {
-			Background = nullptr;
+	auto proidx = projectiles.begin();
+	while (proidx != projectiles.end()) {
+		if ((*proidx)->Update()) {
+			proidx++;
 		} else {
-			video->BlitSprite(Background, Point());
-			bgoverride = true;
+			delete *proidx;
+			proidx = projectiles.erase(proidx);
 		}
 	}
 
-	if (!bgoverride) {
-		int rain = 0;
-		BlitFlags flags = BlitFlags::NONE;
-
-		if (timestop) {
-			flags = BlitFlags::GREY;
-		} else if (AreaFlags&AF_DREAM) {
-			flags = BlitFlags::SEPIA;
+	auto spaidx = particles.begin();
+	while (spaidx != particles.end()) {
+		if ((*spaidx)->Update()) {
+			spaidx++;
+		} else {
+			delete *spaidx;
+			spaidx = particles.erase(spaidx);
 		}
+	}
+}
 
-		if (HasWeather()) {
-			//zero when the weather particles are all gone
-			rain = game->weather->GetPhase()-P_EMPTY;
-		}
+// walks everything in drawing order and notes down what to draw and how, so
+// nothing gets drawn while the lists are still changing
+void Map::RecordDrawList(bool bgoverride)
+{
+	drawList.clear();
 
-		TMap->DrawOverlays( viewport, rain, flags );
-	}
+	const Game* game = core->GetGame();
+	ieDword gametime = game->GameTime;
+	bool timestop = game->IsTimestopActive();
 
-	const auto& viewportWalls = WallsIntersectingRegion(viewport, false);
-	RedrawScreenStencil(viewport, viewportWalls.first);
-	video->SetStencilBuffer(wallStencil);
-	
-	//draw all background animations first
 	aniIterator aniidx = animations.begin();
 
-	auto DrawAreaAnimation = [&, this](const AreaAnimation *a) {
-		BlitFlags flags = SetDrawingStencilForAreaAnimation(a, viewport);
-		flags |= BlitFlags::COLOR_MOD | BlitFlags::BLENDED;
-		
+	auto RecordAreaAnimation = [&, this](const AreaAnimation* a) {
+		DrawCommand cmd {};
+		cmd.type = AOT_AREA;
+		cmd.animation = a;
+		cmd.flags = BlitFlags::COLOR_MOD | BlitFlags::BLENDED;
 		if (timestop) {
-			flags |= BlitFlags::GREY;
+			cmd.flags |= BlitFlags::GREY;
 		}
-		
-		Color tint = ColorWhite;
+
+		cmd.tint = ColorWhite;
 		if (a->Flags & A_ANI_NO_SHADOW) {
-			tint = GetLighting(a->Pos);
+			cmd.tint = GetLighting(a->Pos);
 		}
-		
-		game->ApplyGlobalTint(tint, flags);
 
-		a->Draw(viewport, tint, flags);
+		game->ApplyGlobalTint(cmd.tint, cmd.flags);
+		drawList.push_back(cmd);
 		return GetNextAreaAnimation(aniidx, gametime);
 	};
-	
+
+	//draw all background animations first
 	const AreaAnimation *a = GetNextAreaAnimation(aniidx, gametime);
 	while (a && a->GetHeight() == ANI_PRI_BACKGROUND) {
-		a = DrawAreaAnimation(a);
+		a = RecordAreaAnimation(a);
 	}
 
 	if (!bgoverride) {
-		//Draw Outlines
-		DrawHighlightables(viewport);
+		DrawCommand cmd {};
+		cmd.type = AOT_OUTLINES;
+		drawList.push_back(cmd);
 	}
 
 	//drawing queues 1 and 0
@@ -1428,119 +1450,172 @@ void Map::DrawMap(const Region& viewport, uint32_t dFlags)
 	// hidden by it.
 
 	while (actor || a || sca || spark || pro || pile) {
-		switch(SelectObject(actor,q,a,sca,spark,pro,pile)) {
+		DrawCommand cmd {};
+		cmd.type = SelectObject(actor, q, a, sca, spark, pro, pile);
+		switch (cmd.type) {
 		case AOT_ACTOR:
-			bool visible;
-			visible = false;
 			// always update the animations even if we arent visible
-			if (actor->UpdateDrawingState() && IsExplored(actor->Pos)) {
-				// apparently birds and the dead are always visible?
-				visible = IsVisible(actor->Pos) || actor->Modified[IE_DONOTJUMP] & DNJ_BIRD || actor->GetInternalFlag() & IF_REALLYDIED;
-				if (visible) {
-					BlitFlags flags = SetDrawingStencilForScriptable(actor, viewport);
-					if (game->TimeStoppedFor(actor)) {
-						// when time stops, almost everything turns dull grey,
-						// the caster and immune actors being the most notable exceptions
-						flags |= BlitFlags::GREY;
-					}
-
-					Color baseTint = area->GetLighting(actor->Pos);
-					Color tint(baseTint);
-					game->ApplyGlobalTint(tint, flags);
-					actor->Draw(viewport, baseTint, tint, flags | BlitFlags::BLENDED);
+			if (actor->UpdateDrawingState() && ShowsActor(this, actor)) {
+				cmd.actor = actor;
+				if (game->TimeStoppedFor(actor)) {
+					// when time stops, almost everything turns dull grey,
+					// the caster and immune actors being the most notable exceptions
+					cmd.flags = BlitFlags::GREY;
 				}
-			}
-
-			if (!visible || (actor->GetInternalFlag() & (IF_REALLYDIED | IF_ACTIVE)) == (IF_REALLYDIED | IF_ACTIVE)) {
-				actor->SetInternalFlag(IF_TRIGGER_AP, BitOp::NAND);
-				// turning actor inactive if there is no action next turn
-				actor->HibernateIfAble();
+				cmd.baseTint = GetLighting(actor->Pos);
+				cmd.tint = cmd.baseTint;
+				game->ApplyGlobalTint(cmd.tint, cmd.flags);
+				drawList.push_back(cmd);
 			}
 			actor = GetNextActor(q, index);
 			break;
 		case AOT_PILE:
-			// draw piles
 			if (!bgoverride) {
-				const Container* c = TMap->GetContainer(pileidx - 1);
-				
-				BlitFlags flags = SetDrawingStencilForScriptable(c, viewport);
-				flags |= BlitFlags::COLOR_MOD | BlitFlags::BLENDED;
-				
+				cmd.pile = pile;
+				cmd.flags = BlitFlags::COLOR_MOD | BlitFlags::BLENDED;
 				if (timestop) {
-					flags |= BlitFlags::GREY;
+					cmd.flags |= BlitFlags::GREY;
 				}
-				
-				Color tint = GetLighting(c->Pos);
-				game->ApplyGlobalTint(tint, flags);
-
-				if (c->Highlight || (debugFlags & DEBUG_SHOW_CONTAINERS)) {
-					c->Draw(true, viewport, tint, flags);
-				} else {
-					c->Draw(false, viewport, tint, flags);
-				}
-				pile = GetNextPile(pileidx);
+				cmd.tint = GetLighting(pile->Pos);
+				game->ApplyGlobalTint(cmd.tint, cmd.flags);
+				cmd.highlight = pile->Highlight || (debugFlags & DEBUG_SHOW_CONTAINERS);
+				drawList.push_back(cmd);
 			}
+			pile = GetNextPile(pileidx);
 			break;
 		case AOT_AREA:
-			a = DrawAreaAnimation(a);
+			a = RecordAreaAnimation(a);
 			break;
 		case AOT_SCRIPTED:
-			bool endReached;
-			endReached = sca->UpdateDrawingState(-1);
-			if (endReached) {
+			// the animation frames advance with the drawing, like for actors
+			if (sca->UpdateDrawingState(-1)) {
 				delete sca;
 				scaidx = vvcCells.erase(scaidx);
 			} else {
-				video->SetStencilBuffer(wallStencil);
-				Color tint = GetLighting(sca->Pos);
-				tint.a = 255;
+				cmd.scripted = sca;
+				cmd.tint = GetLighting(sca->Pos);
+				cmd.tint.a = 255;
 
 				// FIXME: these should actually make use of SetDrawingStencilForObject too
-				BlitFlags flags = core->DitherSprites ? BlitFlags::STENCIL_BLUE : BlitFlags::STENCIL_RED;
+				cmd.flags = core->DitherSprites ? BlitFlags::STENCIL_BLUE : BlitFlags::STENCIL_RED;
 				if (timestop) {
-					flags |= BlitFlags::GREY;
+					cmd.flags |= BlitFlags::GREY;
 				}
-				game->ApplyGlobalTint(tint, flags);
-				sca->Draw(viewport, tint, 0, flags);
+				game->ApplyGlobalTint(cmd.tint, cmd.flags);
+				drawList.push_back(cmd);
 				scaidx++;
 			}
 			sca = GetNextScriptedAnimation(scaidx);
 			break;
 		case AOT_PROJECTILE:
-			int drawn;
-			if (gametime > oldGameTime) {
-				drawn = pro->Update();
-			} else {
-				drawn = 1;
-			}
-			if (drawn) {
-				pro->Draw(viewport);
-				proidx++;
-			} else {
-				delete pro;
-				proidx = projectiles.erase(proidx);
-			}
+			cmd.projectile = pro;
+			drawList.push_back(cmd);
+			proidx++;
 			pro = GetNextProjectile(proidx);
 			break;
 		case AOT_SPARK:
-			if (gametime > oldGameTime) {
-				drawn = spark->Update();
-			} else {
-				drawn = 1;
-			}
-			if (drawn) {
-				spark->Draw(viewport.origin);
-				spaidx++;
-			} else {
-				delete spark;
-				spaidx = particles.erase(spaidx);
-			}
+			cmd.spark = spark;
+			drawList.push_back(cmd);
+			spaidx++;
 			spark = GetNextSpark(spaidx);
 			break;
 		default:
 			error("Map", "Trying to draw unknown animation type.");
 		}
 	}
+}
+
+void Map::RenderDrawList(const Region& viewport)
+{
+	Video* video = core->GetVideoDriver();
+
+	for (const DrawCommand& cmd : drawList) {
+		switch (cmd.type) {
+		case AOT_AREA:
+			cmd.animation->Draw(viewport, cmd.tint, cmd.flags | SetDrawingStencilForAreaAnimation(cmd.animation, viewport));
+			break;
+		case AOT_OUTLINES:
+			DrawHighlightables(viewport);
+			break;
+		case AOT_ACTOR:
+			cmd.actor->Draw(viewport, cmd.baseTint, cmd.tint, cmd.flags | SetDrawingStencilForScriptable(cmd.actor, viewport) | BlitFlags::BLENDED);
+			break;
+		case AOT_PILE:
+			cmd.pile->Draw(cmd.highlight, viewport, cmd.tint, cmd.flags | SetDrawingStencilForScriptable(cmd.pile, viewport));
+			break;
+		case AOT_SCRIPTED:
+			video->SetStencilBuffer(wallStencil);
+			cmd.scripted->Draw(viewport, cmd.tint, 0, cmd.flags);
+			break;
+		case AOT_PROJECTILE:
+			cmd.projectile->Draw(viewport);
+			break;
+		case AOT_SPARK:
+			cmd.spark->Draw(viewport.origin);
+			break;
+		}
+	}
+}
+
+//Draw the game area (including overlays, actors, animations, weather)
+void Map::DrawMap(const Region& viewport, uint32_t dFlags)
+{
+	PROFILE_SCOPE(DrawMap);
+	assert(TMap);
+	debugFlags = dFlags;
+
+	Game *game = core->GetGame();
+	ieDword gametime = game->GameTime;
+	bool timestop = game->IsTimestopActive();
+
+	// Map Drawing Strategy
+	// 1. Draw background
+	// 2. Draw overlays (weather)
+	// 3. Create a stencil set: a WF_COVERANIMS wall stencil and an opaque wall stencil
+	// 4. set the video stencil buffer to animWallStencil
+	// 5. Draw background animations (BlitFlags::STENCIL_GREEN)
+	// 6. set the video stencil buffer to wallStencil
+	// 7. draw scriptables (depending on scriptable->ForceDither() return value)
+	// 8. draw fog (BlitFlags::BLENDED)
+	// 9. draw text (BlitFlags::BLENDED)
+
+	//Blit the Background Map Animations (before actors)
+	Video* video = core->GetVideoDriver();
+	int bgoverride = false;
+
+	if (Background) {
+		if (BgDuration < gametime) {
+			Background = nullptr;
+		} else {
+			video->BlitSprite(Background, Point());
+			bgoverride = true;
+		}
+	}
+
+	if (!bgoverride) {
+		int rain = 0;
+		BlitFlags flags = BlitFlags::NONE;
+
+		if (timestop) {
+			flags = BlitFlags::GREY;
+		} else if (AreaFlags&AF_DREAM) {
+			flags = BlitFlags::SEPIA;
+		}
+
+		if (HasWeather()) {
+			//zero when the weather particles are all gone
+			rain = game->weather->GetPhase()-P_EMPTY;
+		}
+
+		TMap->DrawOverlays( viewport, rain, flags );
+	}
+
+	const auto& viewportWalls = WallsIntersectingRegion(viewport, false);
+	RedrawScreenStencil(viewport, viewportWalls.first);
+	video->SetStencilBuffer(wallStencil);
+	
+	RecordDrawList(bgoverride);
+	RenderDrawList(viewport);
 
 	video->SetStencilBuffer(NULL);
 	
@@ -1591,8 +1666,6 @@ void Map::DrawMap(const Region& viewport, uint32_t dFlags)
 		actors[i]->DrawOverheadText();
 	}
 
-	oldGameTime = gametime;
-
 	// Show wallpolygons
 	if (debugFlags & (DEBUG_SHOW_WALLS_ALL|DEBUG_SHOW_DOORS_DISABLED)) {
 		const auto& viewportWallsAll = WallsIntersectingRegion(viewport, true);
@@ -2068,6 +2141,7 @@ void Map::AddActor(Actor* actor, bool init)
 	actor->Area = ResRef::MakeLowerCase(scriptName);
 	if (!HasActor(actor)) {
 		actors.push_back( actor );
+		actorGrid.Insert(actor);
 	}
 	if (init) {
 		actor->SetMap(this);
@@ -2107,6 +2181,8 @@ void Map::DeleteActor(int i)
 		actor->SetMap(NULL);
 		actor->Area.Reset();
 		objectStencils.erase(actor);
+		actorGrid.Remove(actor);
+		fogFootprints.erase(actor);
 		//don't destroy the object in case it is a persistent object
 		//otherwise there is a dead reference causing a crash on save
 		if (game->InStore(actor) < 0) {
@@ -2204,36 +2280,39 @@ Actor* Map::GetActorByGlobalID(ieDword objectID) const
  GA_POINT     64  - not actor specific
  GA_NO_HIDDEN 128 - hidden actors don't play
 */
+// the box around p that contains the positions of all actors whose circle could cover it
+Region Map::ActorCircleBox(const Point& p) const
+{
+	int csize = std::max(actorGrid.MaxCircleSize(), 2);
+	Size reach((csize - 1) * 16, (csize - 1) * 12);
+	return Region(p.x - reach.w, p.y - reach.h, reach.w * 2, reach.h * 2);
+}
+
 Actor* Map::GetActor(const Point &p, int flags, const Movable *checker) const
 {
-	for (auto actor : actors) {
-		if (!actor->IsOver( p ))
-			continue;
-		if (!actor->ValidTarget(flags, checker) ) {
-			continue;
-		}
-		return actor;
-	}
-	return NULL;
+	// called for every node the pathfinder visits, so nothing is collected
+	return actorGrid.FindFirst(ActorCircleBox(p), [&](const Actor* actor) {
+		return actor->IsOver(p) && actor->ValidTarget(flags, checker);
+	});
 }
 
 Actor* Map::GetActorInRadius(const Point &p, int flags, unsigned int radius) const
 {
-	for (auto actor : actors) {
-		if (PersonalDistance( p, actor ) > radius)
-			continue;
-		if (!actor->ValidTarget(flags) ) {
-			continue;
-		}
-		return actor;
-	}
-	return NULL;
+	// PersonalDistance subtracts the circle, so bigger actors can be further away
+	int reach = radius + actorGrid.MaxCircleSize() * 10 + 1;
+	return actorGrid.FindFirst(Region(p.x - reach, p.y - reach, reach * 2, reach * 2), [&](const Actor* actor) {
+		return PersonalDistance(p, actor) <= radius && actor->ValidTarget(flags);
+	});
 }
 
 std::vector<Actor *> Map::GetAllActorsInRadius(const Point &p, int flags, unsigned int radius, const Scriptable *see) const
 {
 	std::vector<Actor *> neighbours;
-	for (auto actor : actors) {
+	// WithinRange is elliptic, 16 pixels per foot at most
+	int reach = radius * 16 + 1;
+	actorGrid.Query(Region(p.x - reach, p.y - reach, reach * 2, reach * 2), neighbours);
+	size_t count = 0;
+	for (auto actor : neighbours) {
 		if (!WithinRange(actor, p, radius)) {
 			continue;
 		}
@@ -2246,11 +2325,74 @@ std::vector<Actor *> Map::GetAllActorsInRadius(const Point &p, int flags, unsign
 				continue;
 			}
 		}
-		neighbours.emplace_back(actor);
+		neighbours[count++] = actor;
 	}
+	neighbours.resize(count);
 	return neighbours;
 }
 
+// Scatters a growing crowd of bare actors over the map and times the radius
+// queries done for every step (see ClearSearchMapFor) with the actor grid
+// and with a plain scan of all the actors, reporting both per crowd size
+double Map::BenchmarkActorQueries(unsigned int maxActors) const
+{
+	using Clock = std::chrono::steady_clock;
+	const Size mapSize = GetSize();
+	std::mt19937 gen(0xdeadbeef);
+	std::uniform_int_distribution<int> randX(0, std::max(0, mapSize.w - 1));
+	std::uniform_int_distribution<int> randY(0, std::max(0, mapSize.h - 1));
+	std::uniform_int_distribution<int> randCircle(1, MAX_CIRCLE_SIZE);
+	const int radius = MAX_CIRCLE_SIZE * 3;
+
+	double speedup = 0;
+	for (unsigned int count = 50; count <= std::max(maxActors, 50U); count *= 2) {
+		std::vector<Actor*> crowd;
+		ActorGrid grid;
+		grid.Resize(mapSize);
+		for (unsigned int i = 0; i < count; i++) {
+			Actor* actor = new Actor();
+			actor->SetPos(Point(randX(gen), randY(gen)));
+			actor->circleSize = randCircle(gen);
+			crowd.push_back(actor);
+			grid.Insert(actor);
+		}
+
+		size_t scanHits = 0;
+		auto startTime = Clock::now();
+		for (const Actor* actor : crowd) {
+			for (Actor* other : crowd) {
+				if (WithinRange(other, actor->Pos, radius)) scanHits++;
+			}
+		}
+		std::chrono::duration<double> scanTime = Clock::now() - startTime;
+
+		size_t gridHits = 0;
+		std::vector<Actor*> found;
+		startTime = Clock::now();
+		for (const Actor* actor : crowd) {
+			int reach = radius * 16 + 1;
+			found.clear();
+			grid.Query(Region(actor->Pos.x - reach, actor->Pos.y - reach, reach * 2, reach * 2), found);
+			for (Actor* other : found) {
+				if (WithinRange(other, actor->Pos, radius)) gridHits++;
+			}
+		}
+		std::chrono::duration<double> gridTime = Clock::now() - startTime;
+
+		speedup = gridTime.count() > 0 ? scanTime.count() / gridTime.count() : 0;
+		Log(MESSAGE, "Map", "{}: {} actors, scan {:.3f}ms ({} hits), grid {:.3f}ms ({} hits), {:.1f}x",
+			GetScriptName(), count, scanTime.count() * 1000, scanHits, gridTime.count() * 1000, gridHits, speedup);
+		if (scanHits != gridHits) {
+			Log(ERROR, "Map", "Actor grid query results differ from the scan!");
+		}
+
+		for (const Actor* actor : crowd) {
+			delete actor;
+		}
+	}
+	return speedup;
+}
+
 
 Actor* Map::GetActor(const ieVariable& Name, int flags) const
 {
@@ -2286,7 +2428,9 @@ void Map::JumpActors(bool jump) const
 		if (actor->Modified[IE_DONOTJUMP]&DNJ_JUMP) {
 			if (jump && !(actor->GetStat(IE_DONOTJUMP) & DNJ_BIRD)) {
 				ClearSearchMapFor(actor);
-				AdjustPositionNavmap(actor->Pos);
+				Point pos = actor->Pos;
+				AdjustPositionNavmap(pos);
+				actor->SetPos(pos);
 				actor->ImpedeBumping();
 			}
 			actor->SetBase(IE_DONOTJUMP,0);
@@ -2355,7 +2499,7 @@ void Map::PurgeArea(bool items)
 		if (actor->GetStat(IE_MC_FLAGS) & MC_IGNORE_RETURN) continue;
 		if (!actor->ValidTarget(GA_NO_DEAD|GA_NO_UNSCHEDULED|GA_NO_ALLY|GA_NO_ENEMY)) continue;
 		if (!actor->HomeLocation.IsZero() && !actor->HomeLocation.IsInvalid() && actor->Pos != actor->HomeLocation) {
-			actor->Pos = actor->HomeLocation;
+			actor->SetPos(actor->HomeLocation);
 		}
 	}
 }
@@ -2476,8 +2620,15 @@ Actor *Map::GetActorByScriptName(const char *name) const
 std::vector<Actor*> Map::GetActorsInRect(const Region& rgn, int excludeFlags) const
 {
 	std::vector<Actor*> actorlist;
-	actorlist.reserve(actors.size());
-	for (auto actor : actors) {
+	// include the actors whose circle reaches the origin from outside the rect
+	Region box = ActorCircleBox(rgn.origin);
+	if (rgn.w > 0 && rgn.h > 0) {
+		box.ExpandToRegion(rgn);
+	}
+	std::vector<Actor*> candidates;
+	actorGrid.Query(box, candidates);
+	actorlist.reserve(candidates.size());
+	for (auto actor : candidates) {
 		if (!actor->ValidTarget(excludeFlags))
 			continue;
 		if (!rgn.PointInside(actor->Pos)
@@ -2907,6 +3058,8 @@ void Map::RemoveActor(Actor* actor)
 			actor->SetMap(NULL);
 			actor->Area.Reset();
 			actors.erase( actors.begin()+i );
+			actorGrid.Remove(actor);
+			fogFootprints.erase(actor);
 			return;
 		}
 	}
@@ -3133,6 +3286,42 @@ void Map::SetupAmbients() const
 	ambim->SetAmbients(ambients);
 }
 
+// ranked, since the audio driver only preloads the head of the list: the
+// ambients come first, as they start playing right away, then the battle
+// sounds, the ones shared by the most creatures first
+std::vector<std::string> Map::GetSoundsToPreload() const
+{
+	std::vector<std::string> ranked;
+	for (const Ambient* ambient : ambients) {
+		for (const ResRef& sound : ambient->sounds) {
+			ranked.emplace_back(sound.CString());
+		}
+	}
+
+	std::vector<std::string> battleSounds;
+	for (const Actor* actor : actors) {
+		actor->GetBattleSounds(battleSounds);
+	}
+	std::unordered_map<std::string, int> uses;
+	for (const std::string& sound : battleSounds) {
+		uses[sound]++;
+	}
+	std::stable_sort(battleSounds.begin(), battleSounds.end(), [&uses](const std::string& a, const std::string& b) {
+		return uses[a] > uses[b];
+	});
+	ranked.insert(ranked.end(), battleSounds.begin(), battleSounds.end());
+
+	// keep only the first of each
+	std::vector<std::string> sounds;
+	std::unordered_set<std::string> seen;
+	for (std::string& sound : ranked) {
+		if (seen.insert(sound).second) {
+			sounds.push_back(std::move(sound));
+		}
+	}
+	return sounds;
+}
+
 ieWord Map::GetAmbientCount(bool toSave) const
 {
 	if (!toSave) return static_cast<ieWord>(ambients.size());
@@ -3386,6 +3575,14 @@ void Map::ExploreTile(const Point &p, bool fogOnly)
 }
 
 void Map::ExploreMapChunk(const Point &Pos, int range, int los)
+{
+	TraceVisibility(Pos, range, los, [this](const Point& tile, bool fogOnly) {
+		ExploreTile(tile, fogOnly);
+	});
+}
+
+// casts the visibility rays from Pos, calling mark for every tile they reach
+void Map::TraceVisibility(const Point& Pos, int range, int los, const std::function<void(const Point&, bool)>& mark) const
 {
 	Point Tile;
 	const Explore& explore = Explore::Get();
@@ -3423,14 +3620,71 @@ void Map::ExploreMapChunk(const Point &Pos, int range, int los)
 					if (!Pass) break;
 				}
 			}
-			ExploreTile(Tile, fogOnly);
+			mark(Tile, fogOnly);
 		}
 	}
 }
 
+void Map::CastFogFootprint(FogFootprint& footprint) const
+{
+	const Size fogSize = FogMapSize();
+	std::vector<std::pair<int, bool>> bits;
+	int minBit = std::numeric_limits<int>::max();
+	int maxBit = -1;
+	TraceVisibility(footprint.pos, footprint.range, 1, [&](const Point& tile, bool fogOnly) {
+		Point fogP = ConvertPointToFog(tile);
+		if (!fogSize.PointInside(fogP)) return;
+
+		int bit = fogP.y * fogSize.w + fogP.x;
+		bits.emplace_back(bit, fogOnly);
+		minBit = std::min(minBit, bit);
+		maxBit = std::max(maxBit, bit);
+	});
+
+	footprint.visible.clear();
+	footprint.explored.clear();
+	if (bits.empty()) return;
+
+	footprint.firstWord = minBit / 64;
+	size_t words = maxBit / 64 - footprint.firstWord + 1;
+	footprint.visible.resize(words, 0);
+	footprint.explored.resize(words, 0);
+	// fill the words through their bytes, so they match the bitmap memory on any endianness
+	uint8_t* explored = reinterpret_cast<uint8_t*>(footprint.explored.data());
+	uint8_t* visible = reinterpret_cast<uint8_t*>(footprint.visible.data());
+	for (const auto& bit : bits) {
+		size_t byte = bit.first / 8 - footprint.firstWord * 8;
+		uint8_t mask = 1 << (bit.first % 8);
+		explored[byte] |= mask;
+		if (!bit.second) {
+			visible[byte] |= mask;
+		}
+	}
+}
+
+// ORs the 64 bit chunks of a footprint mask into the matching part of the bitmap
+static void MergeFogMask(Bitmap& bitmap, size_t firstWord, const std::vector<uint64_t>& mask)
+{
+	uint8_t* data = bitmap.begin();
+	size_t bytes = bitmap.Bytes();
+	for (size_t i = 0; i < mask.size(); i++) {
+		if (!mask[i]) continue;
+
+		size_t offset = (firstWord + i) * 8;
+		// the tail of the bitmap is not necessarily a whole word
+		size_t len = std::min<size_t>(8, bytes - offset);
+		uint64_t word = 0;
+		memcpy(&word, data + offset, len);
+		word |= mask[i];
+		memcpy(data + offset, &word, len);
+	}
+}
+
 void Map::UpdateFog()
 {
+	PROFILE_SCOPE(Fog);
 	VisibleBitmap.fill(0);
+	fogTick++;
 	
 	std::set<Spawn*> potentialSpawns;
 	for (const auto actor : actors) {
@@ -3441,7 +3695,19 @@ void Map::UpdateFog()
 		
 		int vis2 = actor->Modified[IE_VISUALRANGE];
 		if ((state&STATE_BLIND) || (vis2<2)) vis2=2; //can see only themselves
-		ExploreMapChunk (actor->Pos, vis2+actor->GetAnims()->GetCircleSize(), 1);
+		int range = std::min(vis2 + actor->GetAnims()->GetCircleSize(), Explore::Get().MaxVisibility);
+
+		// only redo the rays if the explorer moved or its sight changed
+		FogFootprint& footprint = fogFootprints[actor];
+		if (footprint.explored.empty() || footprint.pos != actor->Pos || footprint.range != range || footprint.losRevision != losRevision) {
+			footprint.pos = actor->Pos;
+			footprint.range = range;
+			footprint.losRevision = losRevision;
+			CastFogFootprint(footprint);
+		}
+		footprint.lastUse = fogTick;
+		MergeFogMask(VisibleBitmap, footprint.firstWord, footprint.visible);
+		MergeFogMask(ExploredBitmap, footprint.firstWord, footprint.explored);
 		
 		Spawn *sp = GetSpawnRadius(actor->Pos, SPAWN_RANGE); //30 * 12
 		if (sp) {
@@ -3452,6 +3718,15 @@ void Map::UpdateFog()
 	for (Spawn* spawn : potentialSpawns) {
 		TriggerSpawn(spawn);
 	}
+
+	// forget the explorers that left, died or stopped exploring
+	for (auto it = fogFootprints.begin(); it != fogFootprints.end();) {
+		if (it->second.lastUse != fogTick) {
+			it = fogFootprints.erase(it);
+		} else {
+			++it;
+		}
+	}
 }
 
 Spawn* Map::GetSpawn(const char *Name) const
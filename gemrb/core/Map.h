@@ -24,19 +24,21 @@
 #include "exports.h"
 #include "globals.h"
 
+#include "ActorGrid.h"
 #include "Bitmap.h"
 #include "Interface.h"
 #include "MapReverb.h"
 #include "Scriptable/Scriptable.h"
+#include "PathClusters.h"
 #include "PathFinder.h"
+#include "PathRequests.h"
 #include "WorldMap.h"
 
 #include <algorithm>
+#include <functional>
 #include <queue>
 #include <unordered_map>
 
-template <class V> class FibonacciHeap;
-
 namespace GemRB {
 
 class Actor;
@@ -308,7 +310,28 @@ public:
 	int GetHeight() const;
 };
 
-enum AnimationObjectType {AOT_AREA, AOT_SCRIPTED, AOT_ACTOR, AOT_SPARK, AOT_PROJECTILE, AOT_PILE};
+// AOT_OUTLINES stands for the door, container and region outlines drawn after the background animations
+enum AnimationObjectType {AOT_AREA, AOT_SCRIPTED, AOT_ACTOR, AOT_SPARK, AOT_PROJECTILE, AOT_PILE, AOT_OUTLINES};
+
+// One object DrawMap is about to draw, with what is known before the wall
+// stencils get involved. The list is recorded in drawing order and is only
+// good until the next tick, which may free the objects in it.
+struct DrawCommand {
+	AnimationObjectType type;
+	union {
+		const AreaAnimation* animation;
+		const Actor* actor;
+		const Container* pile;
+		const VEFObject* scripted;
+		Projectile* projectile;
+		Particles* spark;
+	};
+	Color tint;
+	Color baseTint;
+	BlitFlags flags;
+	// piles only
+	bool highlight;
+};
 
 //i believe we need only the active actors/visible inactive actors queues
 #define QUEUE_COUNT 2
@@ -439,6 +462,30 @@ private:
 	Region stencilViewport;
 
 	std::unordered_map<const void*, std::pair<VideoBufferPtr, Region>> objectStencils;
+	std::vector<DrawCommand> drawList;
+	ieDword sceneTime = 0;
+
+	mutable PathFinderWorkspace pathWorkspace;
+	mutable PathClusters pathClusters;
+	PathRequests pathRequests;
+	ActorGrid actorGrid;
+
+	// what an explorer saw the last time, so UpdateFog only has to redo
+	// the ray casting for those that moved or changed; the masks are
+	// 64 bit chunks of the fog bitmaps, starting with firstWord
+	struct FogFootprint {
+		Point pos;
+		int range = 0;
+		size_t losRevision = 0;
+		size_t firstWord = 0;
+		std::vector<uint64_t> visible;
+		std::vector<uint64_t> explored;
+		ieDword lastUse = 0;
+	};
+	std::unordered_map<const Actor*, FogFootprint> fogFootprints;
+	ieDword fogTick = 0;
+	// bumped whenever the line of sight might have changed (doors)
+	mutable size_t losRevision = 0;
 
 public:
 	Map(TileMap *tm, TileProps tileProps, Holder<Sprite2D> sm);
@@ -464,7 +511,12 @@ public:
 	/* transfers all ever visible piles (loose items) to the specified position */
 	void MoveVisibleGroundPiles(const Point &Pos);
 
+	/** Advances by a tick what the area shows, but no script drives: projectiles,
+	 * sparks and spell animations, and it lets the unseen actors hibernate */
+	void UpdateScene();
 	void DrawMap(const Region& viewport, uint32_t debugFlags);
+	/** The objects the last DrawMap drew, in order */
+	const std::vector<DrawCommand>& GetDrawList() const { return drawList; }
 	void PlayAreaSong(int SongType, bool restart = true, bool hard = false) const;
 	void AddAnimation(AreaAnimation anim);
 	aniIterator GetFirstAnimation() { return animations.begin(); }
@@ -610,6 +662,24 @@ public:
 	Path GetLinePath(const Point &start, const Point &dest, int speed, orient_t Orientation, int flags) const;
 	/* Finds the path which leads to near d */
 	PathListNode* FindPath(const Point &s, const Point &d, unsigned int size, unsigned int minDistance = 0, int flags = PF_SIGHT, const Actor *caller = NULL) const;
+	/* Same as FindPath, but the steps are only kept in the pathfinder workspace */
+	bool SearchPath(const Point &s, const Point &d, unsigned int size, unsigned int minDistance = 0, int flags = PF_SIGHT, const Actor *caller = NULL) const;
+	const Path& GetLastSearchPath() const { return pathWorkspace.result; }
+	/* Queues a search for the caller instead, see PathRequests; returns its ticket */
+	unsigned int QueuePath(const Actor *caller, const Point &s, const Point &d, unsigned int size, unsigned int minDistance);
+	/* The parts of SearchPath that PathRequests runs separately */
+	bool PreparePathGoal(const Point &d, unsigned int size, unsigned int minDistance, const Actor *caller, NavmapPoint &goal) const;
+	bool SolvePath(PathFinderWorkspace &ws, const Point &s, const Point &d, const NavmapPoint &goal, unsigned int size, unsigned int minDistance, int flags, const Actor *caller) const;
+	/* Replays recent pathfinding queries and returns the paths found per second */
+	double BenchmarkPathfinding(unsigned int rounds, bool hierarchical = false) const;
+	/* Orders the party here to dest over and over and returns the orders handled per second */
+	double BenchmarkPartyMove(const Point &dest, unsigned int rounds);
+	/* Invalidates the pathfinding clusters after a static searchmap change */
+	void SearchMapChanged(const SearchmapPoint& p) const { pathClusters.Invalidate(p); losRevision++; }
+	/* Keeps the actor grid in sync, call it after changing the position of an actor */
+	void ActorMoved(const Movable* actor) { actorGrid.Update(actor); }
+	/* Times the proximity queries against growing crowds, returns the speedup over plain scans */
+	double BenchmarkActorQueries(unsigned int maxActors) const;
 
 	bool IsVisible(const Point &p) const;
 	bool IsExplored(const Point &p) const;
@@ -622,6 +692,8 @@ public:
 	//ambients
 	void AddAmbient(Ambient *ambient) { ambients.push_back(ambient); }
 	void SetupAmbients() const;
+	// the ambients and the creature battle sounds, most likely played first, see Audio::Preload
+	std::vector<std::string> GetSoundsToPreload() const;
 	Ambient *GetAmbient(int i) const { return ambients[i]; }
 	ieWord GetAmbientCount(bool toSave = false) const;
 
@@ -684,6 +756,8 @@ private:
 	void DrawDebugOverlay(const Region &vp, uint32_t dFlags) const;
 	void DrawPortal(const InfoPoint *ip, int enable);
 	void DrawHighlightables(const Region& viewport) const;
+	void RecordDrawList(bool bgoverride);
+	void RenderDrawList(const Region& viewport);
 	void DrawFogOfWar(const Bitmap* explored_mask, const Bitmap* visible_mask, const Region& viewport) const;
 	
 	Size PropsSize() const noexcept;
@@ -703,6 +777,12 @@ private:
 	
 	void UpdateSpawns() const;
 	PathMapFlags GetBlockedInLine(const Point &s, const Point &d, bool stopOnImpassable, const Actor *caller = NULL) const;
+	bool SearchPathUnrecorded(const Point &s, const Point &d, unsigned int size, unsigned int minDistance, int flags, const Actor *caller) const;
+	bool SearchPathFlat(const Point &s, const Point &d, unsigned int size, unsigned int minDistance, int flags, const Actor *caller) const;
+	bool SearchPathHierarchical(const Point &s, const Point &d, unsigned int size, unsigned int minDistance, int flags, const Actor *caller) const;
+	Region ActorCircleBox(const Point& p) const;
+	void TraceVisibility(const Point& pos, int range, int los, const std::function<void(const Point&, bool)>& mark) const;
+	void CastFogFootprint(FogFootprint& footprint) const;
 	void AddProjectile(Projectile* pro);
 
 };
@@ -0,0 +1,93 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef OBJECTPOOL_H
+#define OBJECTPOOL_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace GemRB {
+
+/**
+ * @class ObjectPool
+ * Keeps the memory of deleted objects of type T for the next ones. It's
+ * meant for the class specific operator new and delete of objects that
+ * come and go by the dozen every second, so the code using them doesn't
+ * change. Not thread safe, only use it for objects of the main thread.
+ */
+
+template <class T, size_t MaxFree = 256>
+class ObjectPool {
+public:
+	struct Stats {
+		size_t allocations = 0;
+		size_t reuses = 0;
+	};
+
+private:
+	std::vector<void*> freeList;
+	Stats stats;
+
+	ObjectPool() = default;
+
+public:
+	// never destroyed, since objects may still be deleted while the statics go
+	static ObjectPool& Get()
+	{
+		static ObjectPool* pool = new ObjectPool();
+		return *pool;
+	}
+
+	void* Allocate(size_t size)
+	{
+		// derived classes don't fit
+		if (size != sizeof(T)) {
+			return ::operator new(size);
+		}
+
+		stats.allocations++;
+		if (freeList.empty()) {
+			return ::operator new(size);
+		}
+		stats.reuses++;
+		void* ptr = freeList.back();
+		freeList.pop_back();
+		return ptr;
+	}
+
+	void Release(void* ptr, size_t size)
+	{
+		if (!ptr) return;
+		if (size != sizeof(T) || freeList.size() >= MaxFree) {
+			::operator delete(ptr);
+			return;
+		}
+		freeList.push_back(ptr);
+	}
+
+	const Stats& GetStats() const { return stats; }
+	size_t GetFreeCount() const { return freeList.size(); }
+};
+
+}
+
+#endif
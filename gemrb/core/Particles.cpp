@@ -23,6 +23,7 @@
 #include "CharAnimations.h"
 #include "Game.h"
 #include "Interface.h"
+#include "ObjectPool.h"
 #include "TableMgr.h"
 #include "Video/Video.h"
 
@@ -75,9 +76,47 @@ static void InitSparks()
 	inited = true;
 }
 
+// the element arrays of finished particle systems, for the next ones
+static std::vector<std::vector<int>>& SpareArrays()
+{
+	// never destroyed, the weather can outlive the statics
+	static auto* spare = new std::vector<std::vector<int>>();
+	return *spare;
+}
+
+static std::vector<int> TakeArray(size_t size, int value)
+{
+	std::vector<int> array;
+	auto& spare = SpareArrays();
+	if (!spare.empty()) {
+		array = std::move(spare.back());
+		spare.pop_back();
+	}
+	array.assign(size, value);
+	return array;
+}
+
+static void ReturnArray(std::vector<int>& array)
+{
+	auto& spare = SpareArrays();
+	if (spare.size() < 192) {
+		spare.push_back(std::move(array));
+	}
+}
+
+void* Particles::operator new(size_t size)
+{
+	return ObjectPool<Particles>::Get().Allocate(size);
+}
+
+void Particles::operator delete(void* ptr, size_t size)
+{
+	ObjectPool<Particles>::Get().Release(ptr, size);
+}
+
 Particles::Particles(int s)
+	: states(TakeArray(s, -1)), xs(TakeArray(s, 0)), ys(TakeArray(s, 0))
 {
-	points.resize(s);
 	/*
 	for (int i=0;i<MAX_SPARK_PHASE;i++) {
 		bitmap[i]=NULL;
@@ -89,6 +128,13 @@ Particles::Particles(int s)
 	size = last_insert = s;
 }
 
+Particles::~Particles()
+{
+	ReturnArray(states);
+	ReturnArray(xs);
+	ReturnArray(ys);
+}
+
 void Particles::SetBitmap(unsigned int FragAnimID)
 {
 	//int i;
@@ -136,18 +182,20 @@ bool Particles::AddNew(const Point &point)
 	}
 	int i = last_insert;
 	while (i--) {
-		if (points[i].state == -1) {
-			points[i].state = st;
-			points[i].pos = point;
+		if (states[i] == -1) {
+			states[i] = st;
+			xs[i] = point.x;
+			ys[i] = point.y;
 			last_insert = i;
 			return false;
 		}
 	}
 	i = size;
 	while (i--!=last_insert) {
-		if (points[i].state == -1) {
-			points[i].state = st;
-			points[i].pos = point;
+		if (states[i] == -1) {
+			states[i] = st;
+			xs[i] = point.x;
+			ys[i] = point.y;
 			last_insert = i;
 			return false;
 		}
@@ -155,84 +203,118 @@ bool Particles::AddNew(const Point &point)
 	return true;
 }
 
+// the phase of an element picks its color, raindrops also get their length from it
+static int SparkShade(int state, int& length)
+{
+	if (state >= MAX_SPARK_PHASE) {
+		constexpr int maxDropLength = 6;
+		length = maxDropLength - abs(state - MAX_SPARK_PHASE - maxDropLength);
+		return 0;
+	}
+	length = 0;
+	return MAX_SPARK_PHASE - state - 1;
+}
+
 void Particles::Draw(Point p)
 {
 	Video *video=core->GetVideoDriver();
-	const Game *game = core->GetGame();
 
 	if (owner) {
 		p.x-=pos.x;
 		p.y-=pos.y;
 	}
+	int shift = (path == SP_PATH_FLIT || path == SP_PATH_RAIN) ? 4 : 0;
+	if (type == SP_TYPE_BITMAP) {
+		if (fragments) {
+			DrawFragments(p, shift);
+		}
+		return;
+	}
+
+	// the elements are gathered by color, so a whole storm takes a batch per color
+	// only the main thread draws, so the batches are kept for the next call
+	static std::vector<Point> batches[MAX_SPARK_PHASE];
+	for (auto& batch : batches) {
+		batch.clear();
+	}
+
 	ieWord i = size;
 	while (i--) {
-		if (points[i].state == -1) {
+		if (states[i] == -1) {
 			continue;
 		}
-		int state;
-
-		switch(path) {
-		case SP_PATH_FLIT:
-		case SP_PATH_RAIN:
-			state = points[i].state>>4;
+		int length;
+		int shade = SparkShade(states[i] >> shift, length);
+		Point elementPos = Point(xs[i], ys[i]) - p;
+		switch (type) {
+		case SP_TYPE_CIRCLE:
+			video->DrawCircle(elementPos, 2, sparkcolors[color][shade]);
 			break;
+		// this is more like a raindrop
+		case SP_TYPE_LINE:
+			if (length) {
+				batches[shade].push_back(elementPos);
+				batches[shade].push_back(elementPos + Point((i&1), length));
+			}
+			break;
+		case SP_TYPE_POINT:
 		default:
-			state = points[i].state;
+			batches[shade].push_back(elementPos);
 			break;
 		}
+	}
 
-		int length; //used only for raindrops
-		if (state>=MAX_SPARK_PHASE) {
-			constexpr int maxDropLength = 6;
-			length = maxDropLength - abs(state - MAX_SPARK_PHASE - maxDropLength);
-			state = 0;
+	for (int shade = 0; shade < MAX_SPARK_PHASE; shade++) {
+		if (batches[shade].empty()) {
+			continue;
+		}
+		if (type == SP_TYPE_LINE) {
+			video->DrawLineSegments(batches[shade], sparkcolors[color][shade]);
 		} else {
-			state=MAX_SPARK_PHASE-state-1;
-			length=0;
+			video->DrawPoints(batches[shade], sparkcolors[color][shade]);
 		}
-		Color clr = sparkcolors[color][state];
-		switch (type) {
-		case SP_TYPE_BITMAP:
-			/*
-			if (bitmap[state]) {
-				Holder<Sprite2D> frame = bitmap[state]->GetFrame(points[i].state&255);
-				video->BlitGameSprite(frame,
-					points[i].pos.x+screen.x,
-					points[i].pos.y+screen.y, 0, clr,
-					NULL, NULL, &screen);
-			}
-			*/
-			if (fragments) {
-				//IE_ANI_CAST stance has a simple looping animation
-				const auto* anims = fragments->GetAnimation(IE_ANI_CAST, ClampToOrientation(i));
-				if (!anims) {
-					break;
-				}
+	}
+}
 
-				const auto anim = anims->at(0);
-				Holder<Sprite2D> nextFrame = anim->GetFrame(anim->GetCurrentFrameIndex());
+void Particles::DrawFragments(const Point& p, int shift) const
+{
+	Video *video = core->GetVideoDriver();
+	const Game *game = core->GetGame();
 
-				BlitFlags flags = BlitFlags::NONE;
-				if (game) game->ApplyGlobalTint(clr, flags);
+	// the tint only depends on the color and every orientation has a single frame
+	Color tints[MAX_SPARK_PHASE];
+	BlitFlags flags[MAX_SPARK_PHASE];
+	for (int shade = 0; shade < MAX_SPARK_PHASE; shade++) {
+		tints[shade] = sparkcolors[color][shade];
+		flags[shade] = BlitFlags::NONE;
+		if (game) game->ApplyGlobalTint(tints[shade], flags[shade]);
+	}
+	Holder<Sprite2D> frames[MAX_ORIENT];
+	bool lookedUp[MAX_ORIENT]{};
+	PaletteHolder palette = fragments->GetPartPalette(0);
 
-				video->BlitGameSpriteWithPalette(nextFrame, fragments->GetPartPalette(0),
-													points[i].pos - p, flags, clr);
-			}
-			break;
-		case SP_TYPE_CIRCLE:
-			video->DrawCircle (points[i].pos - p, 2, clr);
-			break;
-		case SP_TYPE_POINT:
-		default:
-			video->DrawPoint(points[i].pos - p, clr);
-			break;
-		// this is more like a raindrop
-		case SP_TYPE_LINE:
-			if (length) {
-				video->DrawLine (points[i].pos - p, points[i].pos - p + Point((i&1), length), clr);
+	ieWord i = size;
+	while (i--) {
+		if (states[i] == -1) {
+			continue;
+		}
+		orient_t orient = ClampToOrientation(i);
+		if (!lookedUp[orient]) {
+			lookedUp[orient] = true;
+			//IE_ANI_CAST stance has a simple looping animation
+			const auto* anims = fragments->GetAnimation(IE_ANI_CAST, orient);
+			if (anims) {
+				const auto anim = anims->at(0);
+				frames[orient] = anim->GetFrame(anim->GetCurrentFrameIndex());
 			}
-			break;
 		}
+		if (!frames[orient]) {
+			continue;
+		}
+
+		int length;
+		int shade = SparkShade(states[i] >> shift, length);
+		video->BlitGameSpriteWithPalette(frames[orient], palette, Point(xs[i], ys[i]) - p, flags[shade], tints[shade]);
 	}
 }
 
@@ -267,6 +349,56 @@ void Particles::AddParticles(int count)
 	}
 }
 
+// unused elements are moved too, since they get a new position when reused
+// (the state checks of the flitting and fountain paths keep them still)
+void Particles::MoveElements()
+{
+	int* x = xs.data();
+	int* y = ys.data();
+	const int* state = states.data();
+
+	switch (path) {
+	case SP_PATH_FALL:
+		for (int i = 0; i < size; i++) {
+			y[i] = (y[i] + 3 + ((i>>2)&3)) % pos.h;
+		}
+		break;
+	case SP_PATH_RAIN:
+		for (int i = 0; i < size; i++) {
+			x[i] = (x[i] + pos.w + (i&1)) % pos.w;
+			y[i] = (y[i] + 3 + ((i>>2)&3)) % pos.h;
+		}
+		break;
+	case SP_PATH_FLIT:
+		for (int i = 0; i < size; i++) {
+			if (state[i] <= MAX_SPARK_PHASE<<4) {
+				continue;
+			}
+			x[i] = (x[i] + core->Roll(1, 3, pos.w - 2)) % pos.w;
+			y[i] += (i&3)+1;
+		}
+		break;
+	case SP_PATH_EXPL:
+		for (int i = 0; i < size; i++) {
+			y[i] += 1;
+		}
+		break;
+	case SP_PATH_FOUNT:
+		for (int i = 0; i < size; i++) {
+			if (state[i] <= MAX_SPARK_PHASE) {
+				continue;
+			}
+			if ((state[i]&7) == 7) {
+				x[i] += (i&3)-1;
+			}
+			y[i] += state[i] < MAX_SPARK_PHASE + pos.h ? 2 : -2;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
 int Particles::Update()
 {
 	int drawn=false;
@@ -295,55 +427,16 @@ int Particles::Update()
 	default:
 		grow = size/10;
 	}
+	// ageing is a separate pass, so neither loop needs to skip the unused elements
 	for (int i = 0; i < size; i++) {
-		if (points[i].state==-1) {
-			continue;
-		}
-		drawn=true;
-		if (!points[i].state) {
-			grow++;
-		}
-		points[i].state--;
-
-		switch (path) {
-		case SP_PATH_FALL:
-			points[i].pos.y+=3+((i>>2)&3);
-			points[i].pos.y%=pos.h;
-			break;
-		case SP_PATH_RAIN:
-			points[i].pos.x+=pos.w+(i&1);
-			points[i].pos.x%=pos.w;
-			points[i].pos.y+=3+((i>>2)&3);
-			points[i].pos.y%=pos.h;
-			break;
-		case SP_PATH_FLIT:
-			if (points[i].state<=MAX_SPARK_PHASE<<4) {
-				break;
-			}
-			points[i].pos.x+=core->Roll(1,3,pos.w-2);
-			points[i].pos.x%=pos.w;
-			points[i].pos.y+=(i&3)+1;
-			break;
-		case SP_PATH_EXPL:
-			points[i].pos.y+=1;
-			break;
-		case SP_PATH_FOUNT:
-			if (points[i].state<=MAX_SPARK_PHASE) {
-				break;
-			}
-			if (points[i].state<(MAX_SPARK_PHASE+pos.h)) {
-				if ( (points[i].state&7) == 7) {
-					points[i].pos.x+=(i&3)-1;
-				}
-				points[i].pos.y+=2;
-			} else {
-				if ( (points[i].state&7) == 7) {
-					points[i].pos.x+=(i&3)-1;
-				}
-				points[i].pos.y-=2;
-			}
-			break;
-		}
+		int state = states[i];
+		bool alive = state != -1;
+		drawn |= alive;
+		grow += state == 0;
+		states[i] = state - alive;
+	}
+	if (drawn) {
+		MoveElements();
 	}
 	if (phase==P_GROW) {
 		AddParticles(grow);
@@ -33,6 +33,7 @@
 #include "Region.h"
 
 #include <memory>
+#include <vector>
 
 namespace GemRB {
 
@@ -44,13 +45,6 @@ class Scriptable;
 #define P_FADE  1
 #define P_EMPTY 2
 
-// this structure holds data for a single particle element
-struct Element {
-	int state;
-	Point pos;
-	Element(): state(-1) {};
-};
-
 /**
  * @class Particles 
  * Class holding information about particles and rendering them.
@@ -93,6 +87,12 @@ struct Element {
 class GEM_EXPORT Particles {
 public:
 	explicit Particles(int s);
+	~Particles();
+	Particles(const Particles&) = delete;
+	Particles& operator=(const Particles&) = delete;
+	// sparkles come and go with every spell, so the memory is pooled
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr, size_t size);
 
 	void SetBitmap(unsigned int FragAnimID);
 	void SetPhase(ieByte ph) { phase = ph; }
@@ -122,7 +122,13 @@ public:
 	int Update();
 	int GetHeight() const { return pos.y+pos.h; }
 private:
-	std::vector<Element> points;
+	void MoveElements();
+	void DrawFragments(const Point& p, int shift) const;
+
+	// the elements are kept as separate arrays, so the update loops run over plain ints
+	std::vector<int> states; // -1 for unused elements
+	std::vector<int> xs;
+	std::vector<int> ys;
 	ieDword timetolive = 0;
 //	ieDword target;    //could be 0, in that case target is pos
 	ieWord size = 0;       // spark number
@@ -0,0 +1,353 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#include "PathClusters.h"
+
+#include "Map.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+
+namespace GemRB {
+
+constexpr int PathClusters::CLUSTER_SIZE;
+
+constexpr float NO_PATH = std::numeric_limits<float>::infinity();
+constexpr size_t NO_NODE = std::numeric_limits<size_t>::max();
+// longer border runs get an entrance at both ends instead of one in the middle
+constexpr int MAX_SINGLE_ENTRANCE_RUN = 6;
+constexpr std::array<int, 8> dxNeighbour{{1, 0, -1, 0, 1, 1, -1, -1}};
+constexpr std::array<int, 8> dyNeighbour{{0, 1, 0, -1, 1, -1, 1, -1}};
+
+using OpenNode = std::pair<float, size_t>;
+using OpenList = std::vector<OpenNode>;
+
+static void PushOpen(OpenList& open, float cost, size_t idx)
+{
+	open.emplace_back(cost, idx);
+	std::push_heap(open.begin(), open.end(), std::greater<OpenNode>());
+}
+
+static OpenNode PopOpen(OpenList& open)
+{
+	std::pop_heap(open.begin(), open.end(), std::greater<OpenNode>());
+	OpenNode node = open.back();
+	open.pop_back();
+	return node;
+}
+
+static float CellDistance(const SearchmapPoint& a, const SearchmapPoint& b)
+{
+	int dx = a.x - b.x;
+	int dy = a.y - b.y;
+	return std::sqrt(float(dx * dx + dy * dy));
+}
+
+// mirrors Map::GetBlocked, but ignores actors
+bool PathClusters::Walkable(const TileProps& props, const SearchmapPoint& p)
+{
+	PathMapFlags flags = props.QuerySearchMap(p) & PathMapFlags::NOTACTOR;
+	if (bool(flags & PathMapFlags::DOOR_IMPASSABLE)) {
+		flags &= ~PathMapFlags::PASSABLE;
+	}
+	if (bool(flags & PathMapFlags::DOOR_OPAQUE)) {
+		flags = PathMapFlags::SIDEWALL;
+	}
+	// the same test as the flat search, actors aside
+	return bool(flags & (PathMapFlags::PASSABLE | PathMapFlags::TRAVEL));
+}
+
+void PathClusters::Reset()
+{
+	clusters.clear();
+	nodeOffsets.clear();
+	nodeCells.clear();
+	nodeClusters.clear();
+	nodePeers.clear();
+	dirty = true;
+}
+
+void PathClusters::Invalidate(const SearchmapPoint& p)
+{
+	if (clusters.empty() || !mapSize.PointInside(p)) return;
+
+	clusters[ClusterIndex(p)].dirty = true;
+	dirty = true;
+}
+
+size_t PathClusters::ClusterIndex(const SearchmapPoint& p) const
+{
+	return (p.y / CLUSTER_SIZE) * gridSize.w + p.x / CLUSTER_SIZE;
+}
+
+void PathClusters::Build(const TileProps& props)
+{
+	mapSize = props.GetSize();
+	gridSize.w = (mapSize.w + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+	gridSize.h = (mapSize.h + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+	clusters.clear();
+	clusters.resize(gridSize.Area());
+	for (int cy = 0; cy < gridSize.h; cy++) {
+		for (int cx = 0; cx < gridSize.w; cx++) {
+			Region& bounds = clusters[cy * gridSize.w + cx].bounds;
+			bounds.x = cx * CLUSTER_SIZE;
+			bounds.y = cy * CLUSTER_SIZE;
+			bounds.w = std::min(CLUSTER_SIZE, mapSize.w - bounds.x);
+			bounds.h = std::min(CLUSTER_SIZE, mapSize.h - bounds.y);
+		}
+	}
+	dirty = true;
+}
+
+// entrances only depend on the cells of both clusters along their border, so a
+// cluster and its neighbour always agree where they are
+void PathClusters::FindEntrances(const TileProps& props, size_t clusterIdx)
+{
+	Cluster& cluster = clusters[clusterIdx];
+	const Region& bounds = cluster.bounds;
+	cluster.entrances.clear();
+	cluster.peers.clear();
+
+	// one pass per side: first border cell, step along the border and step across it
+	const Point sideStart[4] = { bounds.origin, Point(bounds.x + bounds.w - 1, bounds.y), Point(bounds.x, bounds.y + bounds.h - 1), bounds.origin };
+	const Point along[4] = { Point(1, 0), Point(0, 1), Point(1, 0), Point(0, 1) };
+	const Point across[4] = { Point(0, -1), Point(1, 0), Point(0, 1), Point(-1, 0) };
+	const int length[4] = { bounds.w, bounds.h, bounds.w, bounds.h };
+
+	for (int side = 0; side < 4; side++) {
+		int runStart = -1;
+		for (int i = 0; i <= length[side]; i++) {
+			Point cell = sideStart[side] + Point(along[side].x * i, along[side].y * i);
+			Point peer = cell + across[side];
+			bool open = i < length[side] && mapSize.PointInside(peer) && Walkable(props, cell) && Walkable(props, peer);
+			if (open) {
+				if (runStart < 0) runStart = i;
+				continue;
+			}
+			if (runStart < 0) continue;
+
+			int runLength = i - runStart;
+			int picks[2] = { runStart + (runLength - 1) / 2, -1 };
+			if (runLength > MAX_SINGLE_ENTRANCE_RUN) {
+				picks[0] = runStart;
+				picks[1] = i - 1;
+			}
+			for (int pick : picks) {
+				if (pick < 0) continue;
+				Point entrance = sideStart[side] + Point(along[side].x * pick, along[side].y * pick);
+				cluster.entrances.push_back(entrance);
+				cluster.peers.push_back(entrance + across[side]);
+			}
+			runStart = -1;
+		}
+	}
+}
+
+// Dijkstra from one cell, restricted to the cluster bounds
+void PathClusters::ClusterCosts(const TileProps& props, const Region& bounds, const SearchmapPoint& from, const std::vector<SearchmapPoint>& to, float* costs)
+{
+	cellCosts.assign(bounds.size.Area(), NO_PATH);
+	OpenList open;
+	size_t fromIdx = (from.y - bounds.y) * bounds.w + from.x - bounds.x;
+	cellCosts[fromIdx] = 0;
+	PushOpen(open, 0, fromIdx);
+
+	while (!open.empty()) {
+		OpenNode current = PopOpen(open);
+		if (current.first > cellCosts[current.second]) continue;
+
+		Point cell(int(current.second % bounds.w), int(current.second / bounds.w));
+		for (size_t i = 0; i < dxNeighbour.size(); i++) {
+			Point next(cell.x + dxNeighbour[i], cell.y + dyNeighbour[i]);
+			if (next.x < 0 || next.y < 0 || next.x >= bounds.w || next.y >= bounds.h) continue;
+			if (!Walkable(props, next + bounds.origin)) continue;
+			float step = 1;
+			if (dxNeighbour[i] && dyNeighbour[i]) {
+				// no cutting corners
+				if (!Walkable(props, Point(next.x, cell.y) + bounds.origin)) continue;
+				if (!Walkable(props, Point(cell.x, next.y) + bounds.origin)) continue;
+				step = float(M_SQRT2);
+			}
+			size_t nextIdx = next.y * bounds.w + next.x;
+			float cost = current.first + step;
+			if (cost < cellCosts[nextIdx]) {
+				cellCosts[nextIdx] = cost;
+				PushOpen(open, cost, nextIdx);
+			}
+		}
+	}
+
+	for (size_t i = 0; i < to.size(); i++) {
+		costs[i] = cellCosts[(to[i].y - bounds.y) * bounds.w + to[i].x - bounds.x];
+	}
+}
+
+void PathClusters::Refresh(const TileProps& props)
+{
+	if (!dirty) return;
+
+	// the entrances on the borders of a changed cluster may have changed too,
+	// so its neighbours need to be redone as well
+	std::vector<bool> redo(clusters.size(), false);
+	for (int cy = 0; cy < gridSize.h; cy++) {
+		for (int cx = 0; cx < gridSize.w; cx++) {
+			if (!clusters[cy * gridSize.w + cx].dirty) continue;
+			for (int ny = std::max(cy - 1, 0); ny <= std::min(cy + 1, gridSize.h - 1); ny++) {
+				for (int nx = std::max(cx - 1, 0); nx <= std::min(cx + 1, gridSize.w - 1); nx++) {
+					redo[ny * gridSize.w + nx] = true;
+				}
+			}
+		}
+	}
+
+	for (size_t i = 0; i < clusters.size(); i++) {
+		if (redo[i]) FindEntrances(props, i);
+	}
+	for (size_t i = 0; i < clusters.size(); i++) {
+		Cluster& cluster = clusters[i];
+		cluster.dirty = false;
+		if (!redo[i]) continue;
+
+		size_t count = cluster.entrances.size();
+		cluster.costs.assign(count * count, NO_PATH);
+		for (size_t e = 0; e < count; e++) {
+			ClusterCosts(props, cluster.bounds, cluster.entrances[e], cluster.entrances, &cluster.costs[e * count]);
+		}
+	}
+
+	// renumber the nodes and link them with their peers
+	nodeOffsets.resize(clusters.size());
+	nodeCells.clear();
+	nodeClusters.clear();
+	std::unordered_map<int, size_t> nodeAtCell;
+	for (size_t i = 0; i < clusters.size(); i++) {
+		nodeOffsets[i] = nodeCells.size();
+		for (const SearchmapPoint& cell : clusters[i].entrances) {
+			nodeAtCell[cell.y * mapSize.w + cell.x] = nodeCells.size();
+			nodeCells.push_back(cell);
+			nodeClusters.push_back(i);
+		}
+	}
+	nodePeers.assign(nodeCells.size(), NO_NODE);
+	for (size_t i = 0; i < clusters.size(); i++) {
+		const Cluster& cluster = clusters[i];
+		for (size_t e = 0; e < cluster.peers.size(); e++) {
+			const SearchmapPoint& peer = cluster.peers[e];
+			auto it = nodeAtCell.find(peer.y * mapSize.w + peer.x);
+			if (it != nodeAtCell.end()) {
+				nodePeers[nodeOffsets[i] + e] = it->second;
+			}
+		}
+	}
+	dirty = false;
+}
+
+bool PathClusters::PlanRoute(const TileProps& props, const SearchmapPoint& start, const SearchmapPoint& goal, std::vector<SearchmapPoint>& waypoints)
+{
+	waypoints.clear();
+	if (clusters.empty() || mapSize != props.GetSize()) {
+		Build(props);
+	}
+	Refresh(props);
+
+	if (!mapSize.PointInside(start) || !mapSize.PointInside(goal)) return false;
+	if (!Walkable(props, start) || !Walkable(props, goal)) return false;
+	size_t startCluster = ClusterIndex(start);
+	size_t goalCluster = ClusterIndex(goal);
+	if (startCluster == goalCluster) return false;
+
+	const Cluster& from = clusters[startCluster];
+	const Cluster& to = clusters[goalCluster];
+	std::vector<float> startCosts(from.entrances.size());
+	std::vector<float> goalCosts(to.entrances.size());
+	ClusterCosts(props, from.bounds, start, from.entrances, startCosts.data());
+	ClusterCosts(props, to.bounds, goal, to.entrances, goalCosts.data());
+
+	// A* over the entrances, with two extra nodes for the start and the goal
+	size_t nodeCount = nodeCells.size();
+	size_t startNode = nodeCount;
+	size_t goalNode = nodeCount + 1;
+	nodeCosts.assign(nodeCount + 2, NO_PATH);
+	nodeParents.assign(nodeCount + 2, NO_NODE);
+	nodeClosed.assign(nodeCount + 2, false);
+	OpenList open;
+
+	auto relax = [&](size_t node, size_t parent, float cost) {
+		if (cost >= nodeCosts[node] || nodeClosed[node]) return;
+		nodeCosts[node] = cost;
+		nodeParents[node] = parent;
+		const SearchmapPoint& cell = node == goalNode ? goal : nodeCells[node];
+		PushOpen(open, cost + CellDistance(cell, goal), node);
+	};
+
+	nodeCosts[startNode] = 0;
+	PushOpen(open, CellDistance(start, goal), startNode);
+	while (!open.empty()) {
+		size_t node = PopOpen(open).second;
+		if (nodeClosed[node]) continue;
+		nodeClosed[node] = true;
+		if (node == goalNode) break;
+
+		float cost = nodeCosts[node];
+		if (node == startNode) {
+			for (size_t e = 0; e < startCosts.size(); e++) {
+				relax(nodeOffsets[startCluster] + e, node, cost + startCosts[e]);
+			}
+			continue;
+		}
+
+		size_t clusterIdx = nodeClusters[node];
+		const Cluster& cluster = clusters[clusterIdx];
+		size_t local = node - nodeOffsets[clusterIdx];
+		size_t count = cluster.entrances.size();
+		for (size_t e = 0; e < count; e++) {
+			if (e == local) continue;
+			relax(nodeOffsets[clusterIdx] + e, node, cost + cluster.costs[local * count + e]);
+		}
+		if (nodePeers[node] != NO_NODE) {
+			relax(nodePeers[node], node, cost + 1);
+		}
+		if (clusterIdx == goalCluster) {
+			relax(goalNode, node, cost + goalCosts[local]);
+		}
+	}
+
+	if (!nodeClosed[goalNode]) return false;
+
+	// only keep the cells where the route enters a new cluster; the refinement
+	// can find its own way through each cluster
+	waypoints.push_back(goal);
+	size_t node = nodeParents[goalNode];
+	while (node != startNode) {
+		size_t parent = nodeParents[node];
+		if (parent != startNode && nodePeers[parent] == node) {
+			waypoints.push_back(nodeCells[node]);
+		}
+		node = parent;
+	}
+	std::reverse(waypoints.begin(), waypoints.end());
+	return true;
+}
+
+}
@@ -0,0 +1,94 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef PATHCLUSTERS_H
+#define PATHCLUSTERS_H
+
+#include "exports.h"
+
+#include "PathFinder.h"
+
+#include <vector>
+
+namespace GemRB {
+
+class TileProps;
+
+// Abstraction layer for planning long routes (HPA*, see Botea et al., 2004)
+// The searchmap is split into square clusters. Walkable runs along the border
+// of two clusters get an entrance on each side and the costs between all the
+// entrances of a cluster are precomputed, so a long route can be planned
+// over this small graph first and then refined by FindPath piece by piece.
+// Only the static part of the searchmap is considered: actors move around
+// all the time and are left for the refinement to deal with, while door
+// changes invalidate the affected clusters.
+class GEM_EXPORT PathClusters {
+public:
+	static constexpr int CLUSTER_SIZE = 16; // in searchmap cells
+
+private:
+	struct Cluster {
+		Region bounds;
+		// entrance cells inside this cluster and the matching cells across the border
+		std::vector<SearchmapPoint> entrances;
+		std::vector<SearchmapPoint> peers;
+		// entrances.size() squared costs of the walks between the entrances
+		std::vector<float> costs;
+		bool dirty = true;
+	};
+
+	Size mapSize;
+	Size gridSize;
+	std::vector<Cluster> clusters;
+	// global node ids: the entrances of cluster c start at nodeOffsets[c]
+	std::vector<size_t> nodeOffsets;
+	std::vector<SearchmapPoint> nodeCells;
+	std::vector<size_t> nodeClusters;
+	std::vector<size_t> nodePeers;
+	bool dirty = true;
+
+	// scratch space for the searches
+	std::vector<float> cellCosts;
+	std::vector<float> nodeCosts;
+	std::vector<size_t> nodeParents;
+	std::vector<bool> nodeClosed;
+
+	void Build(const TileProps& props);
+	void Refresh(const TileProps& props);
+	void FindEntrances(const TileProps& props, size_t clusterIdx);
+	void ClusterCosts(const TileProps& props, const Region& bounds, const SearchmapPoint& from, const std::vector<SearchmapPoint>& to, float* costs);
+	size_t ClusterIndex(const SearchmapPoint& p) const;
+
+public:
+	static bool Walkable(const TileProps& props, const SearchmapPoint& p);
+
+	// drops the whole graph, eg. after the searchmap was replaced
+	void Reset();
+	// marks the cluster of a changed searchmap cell for rebuilding
+	void Invalidate(const SearchmapPoint& p);
+	// fills waypoints with the cluster entrances to pass through on the way
+	// from start to goal, ending with goal; false if no route exists
+	bool PlanRoute(const TileProps& props, const SearchmapPoint& start, const SearchmapPoint& goal, std::vector<SearchmapPoint>& waypoints);
+	size_t GetNodeCount() const { return nodeCells.size(); }
+};
+
+}
+
+#endif
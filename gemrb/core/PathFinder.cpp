@@ -34,15 +34,21 @@
 // Moving to each node in the path thus becomes an automatic regulation problem
 // which is solved with a P regulator, see Scriptable.cpp
 
-#include "FibonacciHeap.h"
+#include "FrameProfiler.h"
+#include "Game.h"
 #include "GameData.h"
 #include "Map.h"
 #include "PathFinder.h"
+#include "PathClusters.h"
 #include "RNG.h"
 #include "Scriptable/Actor.h"
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <functional>
 #include <limits>
+#include <random>
 
 namespace GemRB {
 
@@ -130,17 +136,7 @@ bool Map::TargetUnreachable(const Point &s, const Point &d, unsigned int size, b
 {
 	int flags = PF_SIGHT;
 	if (actorsAreBlocking) flags |= PF_ACTORS_ARE_BLOCKING;
-	PathListNode *path = FindPath(s, d, size, 0, flags);
-	bool targetUnreachable = path == nullptr;
-	if (!targetUnreachable) {
-		PathListNode *thisNode = path;
-		while (thisNode) {
-			PathListNode *nextNode = thisNode->Next;
-			delete thisNode;
-			thisNode = nextNode;
-		}
-	}
-	return targetUnreachable;
+	return !SearchPath(s, d, size, 0, flags);
 }
 
 // Use this function when you target something by a straight line projectile (like a lightning bolt, arrow, etc)
@@ -296,47 +292,228 @@ PathListNode *Map::GetLine(const Point &p, int steps, orient_t orient) const
 	return step;
 }
 
+void PathFinderWorkspace::NewSearch(const Size& mapSize)
+{
+	size_t area = mapSize.Area();
+	if (closedGen.size() != area) {
+		closedGen.assign(area, 0);
+		visitedGen.assign(area, 0);
+		parents.assign(area, NavmapPoint());
+		distFromStart.assign(area, std::numeric_limits<unsigned short>::max());
+		generation = 0;
+	}
+
+	generation++;
+	// on wraparound the old stamps could alias new searches, so start over
+	if (generation == 0) {
+		std::fill(closedGen.begin(), closedGen.end(), 0);
+		std::fill(visitedGen.begin(), visitedGen.end(), 0);
+		generation = 1;
+	}
+	open.clear();
+	result.clear();
+}
+
+unsigned short PathFinderWorkspace::GetDistance(size_t idx) const
+{
+	if (visitedGen[idx] != generation) {
+		return std::numeric_limits<unsigned short>::max();
+	}
+	return distFromStart[idx];
+}
+
+void PathFinderWorkspace::Visit(size_t idx, const NavmapPoint& parent, unsigned short dist)
+{
+	visitedGen[idx] = generation;
+	parents[idx] = parent;
+	distFromStart[idx] = dist;
+}
+
+void PathFinderWorkspace::PushOpen(const PQNode& node)
+{
+	open.push_back(node);
+	std::push_heap(open.begin(), open.end(), std::greater<PQNode>());
+}
+
+PQNode PathFinderWorkspace::PopOpen()
+{
+	std::pop_heap(open.begin(), open.end(), std::greater<PQNode>());
+	PQNode node = open.back();
+	open.pop_back();
+	return node;
+}
+
+void PathFinderWorkspace::Record(const PathQuery& query)
+{
+	if (recorded.size() < MAX_RECORDED_QUERIES) {
+		recorded.push_back(query);
+	} else {
+		recorded[nextRecorded] = query;
+	}
+	nextRecorded = (nextRecorded + 1) % MAX_RECORDED_QUERIES;
+}
+
 // Find a path from start to goal, ending at the specified distance from the
 // target (the goal must be in sight of the end, if PF_SIGHT is specified)
 PathListNode *Map::FindPath(const Point &s, const Point &d, unsigned int size, unsigned int minDistance, int flags, const Actor *caller) const
 {
-	Log(DEBUG, "FindPath", "s = {}, d = {}, caller = {}, dist = {}, size = {}", s, d, caller ? MBStringFromString(caller->GetShortName()) : "nullptr", minDistance, size);
-	NavmapPoint nmptDest = d;
-	NavmapPoint nmptSource = s;
+	if (!SearchPath(s, d, size, minDistance, flags, caller)) {
+		return nullptr;
+	}
+	return MakePathList(pathWorkspace.result);
+}
+
+PathListNode* MakePathList(const Path& path)
+{
+	PathListNode *resultPath = nullptr;
+	PathListNode *lastStep = nullptr;
+	for (const PathNode& node : path) {
+		PathListNode *newStep = new PathListNode;
+		newStep->point = node.point;
+		newStep->orient = node.orient;
+		newStep->Next = nullptr;
+		newStep->Parent = lastStep;
+		if (lastStep) {
+			lastStep->Next = newStep;
+		} else {
+			resultPath = newStep;
+		}
+		lastStep = newStep;
+	}
+	return resultPath;
+}
+
+// Does the actual search for FindPath; on success the steps are left in
+// pathWorkspace.result, which stays valid until the next search on this map
+bool Map::SearchPath(const Point &s, const Point &d, unsigned int size, unsigned int minDistance, int flags, const Actor *caller) const
+{
+	PROFILE_SCOPE(Pathfinding);
+#ifdef USE_BENCHMARKS
+	pathWorkspace.Record(PathQuery { s, d, size, minDistance, flags });
+#endif
+	return SearchPathUnrecorded(s, d, size, minDistance, flags, caller);
+}
+
+// SearchPath for the benchmarks, which must not record their own searches
+bool Map::SearchPathUnrecorded(const Point &s, const Point &d, unsigned int size, unsigned int minDistance, int flags, const Actor *caller) const
+{
+	if (core->config.HierarchicalPathfinding && SearchPathHierarchical(s, d, size, minDistance, flags, caller)) {
+		return true;
+	}
+	return SearchPathFlat(s, d, size, minDistance, flags, caller);
+}
+
+unsigned int Map::QueuePath(const Actor *caller, const Point &s, const Point &d, unsigned int size, unsigned int minDistance)
+{
+	return pathRequests.Add(caller, s, d, size, minDistance);
+}
+
+// Picks where a search for d should end up: blocked targets are moved to
+// the nearest free spot. False if the caller can't fit there at all.
+// Not thread safe (the adjustment is random), so QueuePath calls it upfront
+bool Map::PreparePathGoal(const Point &d, unsigned int size, unsigned int minDistance, const Actor *caller, NavmapPoint &goal) const
+{
+	goal = d;
 	if (!(GetBlockedInRadius(d, size) & PathMapFlags::PASSABLE)) {
 		// If the desired target is blocked, find the path
 		// to the nearest reachable point.
 		// Also avoid bumping a still actor out of its position,
 		// but stop just before it
-		AdjustPositionNavmap(nmptDest);
+		AdjustPositionNavmap(goal);
 	}
-	if (minDistance < size && !(GetBlockedInRadius(nmptDest, size) & (PathMapFlags::PASSABLE | PathMapFlags::ACTOR))) {
+	if (minDistance < size && !(GetBlockedInRadius(goal, size) & (PathMapFlags::PASSABLE | PathMapFlags::ACTOR))) {
 		Log(DEBUG, "FindPath", "{} can't fit in destination", caller ? MBStringFromString(caller->GetShortName()) : "nullptr");
-		return nullptr;
+		return false;
+	}
+	return true;
+}
+
+// Plans long routes over the cluster graph first, then refines them by searching
+// from one cluster entrance to the next. Returns false if that wasn't possible
+// (or worthwhile), so the caller can fall back to a plain search
+bool Map::SearchPathHierarchical(const Point &s, const Point &d, unsigned int size, unsigned int minDistance, int flags, const Actor *caller) const
+{
+	SearchmapPoint smptSource(s.x / 16, s.y / 12);
+	SearchmapPoint smptDest(d.x / 16, d.y / 12);
+	if (Distance(smptSource, smptDest) < unsigned(2 * PathClusters::CLUSTER_SIZE)) {
+		return false;
+	}
+
+	std::vector<SearchmapPoint> waypoints;
+	if (!pathClusters.PlanRoute(tileProps, smptSource, smptDest, waypoints)) {
+		return false;
+	}
+
+	Path route;
+	NavmapPoint nmptFrom = s;
+	for (size_t i = 0; i < waypoints.size(); i++) {
+		bool last = i == waypoints.size() - 1;
+		NavmapPoint nmptTo = last ? d : NavmapPoint(waypoints[i].x * 16 + 8, waypoints[i].y * 12 + 6);
+		// already in the cell (for the last segment, d's), which a search
+		// can't handle, and that's where it would end anyway
+		if (nmptFrom.x / 16 == nmptTo.x / 16 && nmptFrom.y / 12 == nmptTo.y / 12) {
+			continue;
+		}
+		if (!SearchPathFlat(nmptFrom, nmptTo, size, last ? minDistance : 0, flags, caller)) {
+			return false;
+		}
+		route.insert(route.end(), pathWorkspace.result.begin(), pathWorkspace.result.end());
+		nmptFrom = route.back().point;
+	}
+	if (route.empty()) {
+		return false;
 	}
+
+	pathWorkspace.result = std::move(route);
+	return true;
+}
+
+bool Map::SearchPathFlat(const Point &s, const Point &d, unsigned int size, unsigned int minDistance, int flags, const Actor *caller) const
+{
+	Log(DEBUG, "FindPath", "s = {}, d = {}, caller = {}, dist = {}, size = {}", s, d, caller ? MBStringFromString(caller->GetShortName()) : "nullptr", minDistance, size);
+
+	NavmapPoint goal;
+	if (!PreparePathGoal(d, size, minDistance, caller, goal)) {
+		return false;
+	}
+	if (SolvePath(pathWorkspace, s, d, goal, size, minDistance, flags, caller)) {
+		return true;
+	}
+	if (caller) {
+		Log(DEBUG, "FindPath", "Pathing failed for {}", fmt::WideToChar{caller->GetShortName()});
+	} else {
+		Log(DEBUG, "FindPath", "Pathing failed");
+	}
+	return false;
+}
+
+// The search itself, from s to the goal picked by PreparePathGoal for d.
+// It only reads the map and leaves the steps in ws.result, so PathWorkers
+// can run several at once while the map is left alone
+bool Map::SolvePath(PathFinderWorkspace &ws, const Point &s, const Point &d, const NavmapPoint &goal, unsigned int size, unsigned int minDistance, int flags, const Actor *caller) const
+{
+	NavmapPoint nmptDest = goal;
+	NavmapPoint nmptSource = s;
 	SearchmapPoint smptSource(nmptSource.x / 16, nmptSource.y / 12);
 	SearchmapPoint smptDest(nmptDest.x / 16, nmptDest.y / 12);
-	if (smptDest == smptSource) return nullptr;
+	if (smptDest == smptSource) return false;
 
 	const Size& mapSize = PropsSize();
-	if (!mapSize.PointInside(smptSource)) return nullptr;
+	if (!mapSize.PointInside(smptSource)) return false;
 
 	// Initialize data structures
-	FibonacciHeap<PQNode> open;
-	std::vector<bool> isClosed(mapSize.Area(), false);
-	std::vector<NavmapPoint> parents(mapSize.Area(), Point(0, 0));
-	std::vector<unsigned short> distFromStart(mapSize.Area(), std::numeric_limits<unsigned short>::max());
-	distFromStart[smptSource.y * mapSize.w + smptSource.x] = 0;
-	parents[smptSource.y * mapSize.w + smptSource.x] = nmptSource;
-	open.emplace(PQNode(nmptSource, 0));
+	ws.NewSearch(mapSize);
+	ws.Visit(smptSource.y * mapSize.w + smptSource.x, nmptSource, 0);
+	ws.PushOpen(PQNode(nmptSource, 0));
 	bool foundPath = false;
 	unsigned int squaredMinDist = minDistance * minDistance;
 
-	while (!open.empty()) {
-		NavmapPoint nmptCurrent = open.top().point;
-		open.pop();
+	while (!ws.OpenEmpty()) {
+		NavmapPoint nmptCurrent = ws.PopOpen().point;
 		SearchmapPoint smptCurrent(nmptCurrent.x / 16, nmptCurrent.y / 12);
-		if (parents[smptCurrent.y * mapSize.w + smptCurrent.x] == Point(0, 0)) {
+		size_t currentIdx = smptCurrent.y * mapSize.w + smptCurrent.x;
+		NavmapPoint nmptParent = ws.GetParent(currentIdx);
+		if (nmptParent == Point(0, 0)) {
 			continue;
 		}
 
@@ -345,8 +522,7 @@ PathListNode *Map::FindPath(const Point &s, const Point &d, unsigned int size, u
 			foundPath = true;
 			break;
 		} else if (minDistance) {
-			if (parents[smptCurrent.y * mapSize.w + smptCurrent.x] != nmptCurrent &&
-					SquaredDistance(nmptCurrent, nmptDest) < squaredMinDist) {
+			if (nmptParent != nmptCurrent && SquaredDistance(nmptCurrent, nmptDest) < squaredMinDist) {
 				if (!(flags & PF_SIGHT) || IsVisibleLOS(nmptCurrent, d)) {
 					smptDest = smptCurrent;
 					nmptDest = nmptCurrent;
@@ -355,15 +531,16 @@ PathListNode *Map::FindPath(const Point &s, const Point &d, unsigned int size, u
 				}
 			}
 		}
-		isClosed[smptCurrent.y * mapSize.w + smptCurrent.x] = true;
+		ws.Close(currentIdx);
 
 		for (size_t i = 0; i < DEGREES_OF_FREEDOM; i++) {
 			NavmapPoint nmptChild(nmptCurrent.x + 16 * dxAdjacent[i], nmptCurrent.y + 12 * dyAdjacent[i]);
 			SearchmapPoint smptChild(nmptChild.x / 16, nmptChild.y / 12);
 			// Outside map
 			if (smptChild.x < 0 ||	smptChild.y < 0 || smptChild.x >= mapSize.w || smptChild.y >= mapSize.h) continue;
+			size_t childIdx = smptChild.y * mapSize.w + smptChild.x;
 			// Already visited
-			if (isClosed[smptChild.y * mapSize.w + smptChild.x]) continue;
+			if (ws.IsClosed(childIdx)) continue;
 			// If there's an actor, check it can be bumped away
 			const Actor* childActor = GetActor(nmptChild, GA_NO_DEAD | GA_NO_UNSCHEDULED);
 			bool childIsUnbumpable = childActor && childActor != caller && (flags & PF_ACTORS_ARE_BLOCKING || !childActor->ValidTarget(GA_ONLY_BUMPABLE));
@@ -375,27 +552,24 @@ PathListNode *Map::FindPath(const Point &s, const Point &d, unsigned int size, u
 
 			// Weighted heuristic. Finds sub-optimal paths but should be quite a bit faster
 			const float HEURISTIC_WEIGHT = 1.5;
-			SearchmapPoint smptCurrent2(nmptCurrent.x / 16, nmptCurrent.y / 12);
-			NavmapPoint nmptParent = parents[smptCurrent2.y * mapSize.w + smptCurrent2.x];
-			unsigned short oldDist = distFromStart[smptChild.y * mapSize.w + smptChild.x];
+			unsigned short oldDist = ws.GetDistance(childIdx);
+			unsigned short newDist = oldDist;
 			// Theta-star path if there is LOS
 			if (IsWalkableTo(nmptParent, nmptChild, flags & PF_ACTORS_ARE_BLOCKING, caller)) {
 				SearchmapPoint smptParent(nmptParent.x / 16, nmptParent.y / 12);
-				unsigned short newDist = distFromStart[smptParent.y * mapSize.w + smptParent.x] + Distance(smptParent, smptChild);
+				newDist = ws.GetDistance(smptParent.y * mapSize.w + smptParent.x) + Distance(smptParent, smptChild);
 				if (newDist < oldDist) {
-					parents[smptChild.y * mapSize.w + smptChild.x] = nmptParent;
-					distFromStart[smptChild.y * mapSize.w + smptChild.x] = newDist;
+					ws.Visit(childIdx, nmptParent, newDist);
 				}
 			// Fall back to A-star path
 			} else if (IsWalkableTo(nmptCurrent, nmptChild, flags & PF_ACTORS_ARE_BLOCKING, caller)) {
-				unsigned short newDist = distFromStart[smptCurrent2.y * mapSize.w + smptCurrent2.x] + Distance(smptCurrent2, smptChild);
+				newDist = ws.GetDistance(currentIdx) + Distance(smptCurrent, smptChild);
 				if (newDist < oldDist) {
-					parents[smptChild.y * mapSize.w + smptChild.x] = nmptCurrent;
-					distFromStart[smptChild.y * mapSize.w + smptChild.x] = newDist;
+					ws.Visit(childIdx, nmptCurrent, newDist);
 				}
 			}
 
-			if (distFromStart[smptChild.y * mapSize.w + smptChild.x] < oldDist) {
+			if (newDist < oldDist) {
 				// Calculate heuristic
 				int xDist = smptChild.x - smptDest.x;
 				int yDist = smptChild.y - smptDest.y;
@@ -405,46 +579,147 @@ PathListNode *Map::FindPath(const Point &s, const Point &d, unsigned int size, u
 				int crossProduct = std::abs(xDist * dyCross - yDist * dxCross) >> 3;
 				double distance = std::sqrt(xDist * xDist + yDist * yDist);
 				double heuristic = HEURISTIC_WEIGHT * (distance + crossProduct);
-				double estDist = distFromStart[smptChild.y * mapSize.w + smptChild.x] + heuristic;
-				PQNode newNode(nmptChild, estDist);
-				open.emplace(newNode);
+				double estDist = newDist + heuristic;
+				ws.PushOpen(PQNode(nmptChild, estDist));
 			}
 		}
 	}
 
 	if (foundPath) {
-		PathListNode *resultPath = nullptr;
+		// walk back from the goal, then flip, so the steps run from the start
 		NavmapPoint nmptCurrent = nmptDest;
-		NavmapPoint nmptParent;
 		SearchmapPoint smptCurrent(nmptCurrent.x / 16, nmptCurrent.y / 12);
-		while (!resultPath || nmptCurrent != parents[smptCurrent.y * mapSize.w + smptCurrent.x]) {
-			nmptParent = parents[smptCurrent.y * mapSize.w + smptCurrent.x];
-			PathListNode *newStep = new PathListNode;
-			newStep->point = nmptCurrent;
-			newStep->Next = resultPath;
-			newStep->Parent = nullptr;
+		NavmapPoint nmptParent = ws.GetParent(smptCurrent.y * mapSize.w + smptCurrent.x);
+		while (ws.result.empty() || nmptCurrent != nmptParent) {
+			orient_t orient;
 			if (flags & PF_BACKAWAY) {
-				newStep->orient = GetOrient(nmptParent, nmptCurrent);
+				orient = GetOrient(nmptParent, nmptCurrent);
 			} else {
-				newStep->orient = GetOrient(nmptCurrent, nmptParent);
-			}
-			if (resultPath) {
-				resultPath->Parent = newStep;
+				orient = GetOrient(nmptCurrent, nmptParent);
 			}
-			resultPath = newStep;
+			ws.result.push_back(PathNode { nmptCurrent, orient });
 			nmptCurrent = nmptParent;
 
 			smptCurrent.x = nmptCurrent.x / 16;
 			smptCurrent.y = nmptCurrent.y / 12;
+			nmptParent = ws.GetParent(smptCurrent.y * mapSize.w + smptCurrent.x);
+		}
+		std::reverse(ws.result.begin(), ws.result.end());
+		return true;
+	}
+
+	return false;
+}
+
+// Replays the recently recorded FindPath queries (or a fixed set of random ones,
+// if there are none, like in builds without USE_BENCHMARKS) and reports how
+// many paths per second were found
+double Map::BenchmarkPathfinding(unsigned int rounds, bool hierarchical) const
+{
+	std::vector<PathQuery> queries = pathWorkspace.GetRecorded();
+	const Size& mapSize = PropsSize();
+	if (queries.empty()) {
+		std::mt19937 gen(0xdeadbeef);
+		std::uniform_int_distribution<int> randX(1, (mapSize.w - 1) * 16);
+		std::uniform_int_distribution<int> randY(1, (mapSize.h - 1) * 12);
+		for (int tries = 0; tries < 10000 && queries.size() < 256; tries++) {
+			Point start(randX(gen), randY(gen));
+			Point goal(randX(gen), randY(gen));
+			if (!(GetBlocked(start) & PathMapFlags::PASSABLE) || !(GetBlocked(goal) & PathMapFlags::PASSABLE)) continue;
+			queries.push_back(PathQuery { start, goal, 1, 0, PF_SIGHT });
+		}
+	}
+	if (queries.empty() || !rounds) return 0;
+
+	unsigned int found = 0;
+	size_t steps = 0;
+	auto startTime = std::chrono::steady_clock::now();
+	for (unsigned int round = 0; round < rounds; round++) {
+		for (const PathQuery& query : queries) {
+			bool success = hierarchical && SearchPathHierarchical(query.start, query.goal, query.size, query.minDistance, query.flags, nullptr);
+			if (!success) {
+				success = SearchPathFlat(query.start, query.goal, query.size, query.minDistance, query.flags, nullptr);
+			}
+			if (success) {
+				found++;
+				steps += pathWorkspace.result.size();
+			}
 		}
-		return resultPath;
-	} else if (caller) {
-		Log(DEBUG, "FindPath", "Pathing failed for {}", fmt::WideToChar{caller->GetShortName()});
-	} else {
-		Log(DEBUG, "FindPath", "Pathing failed");
 	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
 
-	return nullptr;
+	size_t total = queries.size() * rounds;
+	double pathsPerSecond = elapsed.count() > 0 ? total / elapsed.count() : 0;
+	Log(MESSAGE, "FindPath", "{} ({} planner): {} searches ({} queries x {} rounds, {} found, {} steps) in {:.3f}s, {:.1f} paths/s",
+		GetScriptName(), hierarchical ? "hierarchical" : "flat", total, queries.size(), rounds, found, steps, elapsed.count(), pathsPerSecond);
+	return pathsPerSecond;
+}
+
+// Orders the party members in this area to dest, like a click would, and
+// times it until everyone has a path (or gave up). The searches are queued
+// if PathfindingThreads is set, so both ways are timed for comparison.
+// Returns the orders handled per second the configured way
+double Map::BenchmarkPartyMove(const Point &dest, unsigned int rounds)
+{
+	const Game* game = core->GetGame();
+	std::vector<Actor*> party;
+	for (int i = 0; i < game->GetPartySize(false); i++) {
+		Actor* pc = game->GetPC(i, false);
+		if (pc && pc->GetCurrentArea() == this) {
+			party.push_back(pc);
+		}
+	}
+	if (party.empty() || !rounds) return 0;
+
+	auto stopAll = [this, &party]() {
+		for (Actor* pc : party) {
+			pc->ClearPath(true);
+			if (pc->BlocksSearchMap()) BlockSearchMapFor(pc);
+		}
+	};
+	stopAll();
+
+	// the plain searches WalkTo would do right away
+	unsigned int found = 0;
+	auto startTime = std::chrono::steady_clock::now();
+	for (unsigned int round = 0; round < rounds; round++) {
+		for (const Actor* pc : party) {
+			if (pc->BlocksSearchMap()) ClearSearchMapFor(pc);
+			bool success = SearchPathUnrecorded(pc->Pos, dest, pc->circleSize, 0, PF_SIGHT | PF_ACTORS_ARE_BLOCKING, pc);
+			if (!success && pc->ValidTarget(GA_CAN_BUMP)) {
+				success = SearchPathUnrecorded(pc->Pos, dest, pc->circleSize, 0, PF_SIGHT, pc);
+			}
+			if (success) found++;
+			if (pc->BlocksSearchMap()) BlockSearchMapFor(pc);
+		}
+	}
+	std::chrono::duration<double> direct = std::chrono::steady_clock::now() - startTime;
+	double ordersPerSecond = direct.count() > 0 ? rounds / direct.count() : 0;
+	Log(MESSAGE, "FindPath", "{}: party of {} to {}, {} rounds, {} paths found, directly: {:.3f}ms per order",
+		GetScriptName(), party.size(), dest, rounds, found, direct.count() * 1000 / rounds);
+
+	PathWorkers* workers = core->GetPathWorkers();
+	if (!workers) return ordersPerSecond;
+
+	found = 0;
+	startTime = std::chrono::steady_clock::now();
+	for (unsigned int round = 0; round < rounds; round++) {
+		for (Actor* pc : party) {
+			pc->WalkTo(dest, 0);
+		}
+		pathRequests.Solve(*this, *workers);
+		pathRequests.Deliver(*this);
+		for (const Actor* pc : party) {
+			if (pc->GetPath()) found++;
+		}
+		stopAll();
+	}
+	std::chrono::duration<double> queued = std::chrono::steady_clock::now() - startTime;
+	ordersPerSecond = queued.count() > 0 ? rounds / queued.count() : 0;
+	Log(MESSAGE, "FindPath", "{}: {} paths found, queued on {} threads: {:.3f}ms per order, {:.2f}x",
+		GetScriptName(), found, workers->GetThreadCount() + 1, queued.count() * 1000 / rounds,
+		queued.count() > 0 ? direct.count() / queued.count() : 0);
+	return ordersPerSecond;
 }
 
 void Map::NormalizeDeltas(double &dx, double &dy, const double &factor)
@@ -20,6 +20,7 @@
 #ifndef PATHFINDER_H
 #define PATHFINDER_H
 
+#include "exports.h"
 #include "EnumFlags.h"
 
 #include "Orientation.h"
@@ -75,6 +76,9 @@ struct PathListNode {
 	orient_t orient;
 };
 
+// copies the steps into a newly allocated list, nullptr if there are none
+GEM_EXPORT PathListNode* MakePathList(const Path& path);
+
 enum {
 	PF_SIGHT = 1,
 	PF_BACKAWAY = 2,
@@ -101,6 +105,55 @@ public:
 
 };
 
+// a FindPath query, as recorded for BenchmarkPathfinding in USE_BENCHMARKS builds
+struct PathQuery {
+	NavmapPoint start;
+	NavmapPoint goal;
+	unsigned int size;
+	unsigned int minDistance;
+	int flags;
+};
+
+// Scratch space of Map::FindPath, kept by each map and reused between searches
+// (and one for each thread of PathWorkers).
+// The per-cell data is stamped with the search generation it was written in,
+// so it never needs to be cleared: data from older searches just reads as unset.
+class GEM_EXPORT PathFinderWorkspace {
+	std::vector<uint32_t> closedGen;
+	std::vector<uint32_t> visitedGen;
+	std::vector<NavmapPoint> parents;
+	std::vector<unsigned short> distFromStart;
+	// binary min-heap, ordered by PQNode::dist
+	std::vector<PQNode> open;
+	uint32_t generation = 0;
+
+	std::vector<PathQuery> recorded;
+	size_t nextRecorded = 0;
+
+public:
+	static constexpr size_t MAX_RECORDED_QUERIES = 512;
+
+	// the nodes of the last path found, from the first step to the goal
+	Path result;
+
+	// prepares for a new search on a searchmap of the given size
+	void NewSearch(const Size& mapSize);
+
+	bool IsClosed(size_t idx) const { return closedGen[idx] == generation; }
+	void Close(size_t idx) { closedGen[idx] = generation; }
+	// unvisited cells have no parent and an infinite distance
+	NavmapPoint GetParent(size_t idx) const { return visitedGen[idx] == generation ? parents[idx] : NavmapPoint(); }
+	unsigned short GetDistance(size_t idx) const;
+	void Visit(size_t idx, const NavmapPoint& parent, unsigned short dist);
+
+	bool OpenEmpty() const { return open.empty(); }
+	void PushOpen(const PQNode& node);
+	PQNode PopOpen();
+
+	void Record(const PathQuery& query);
+	const std::vector<PathQuery>& GetRecorded() const { return recorded; }
+};
+
 }
 
 #endif
@@ -0,0 +1,193 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#include "PathRequests.h"
+
+#include "FrameProfiler.h"
+#include "Map.h"
+#include "Logging/Logging.h"
+#include "Scriptable/Actor.h"
+
+namespace GemRB {
+
+PathWorkers::PathWorkers(unsigned int count)
+	: workspaces(count + 1)
+{
+	for (unsigned int i = 0; i < count; i++) {
+		threads.emplace_back(&PathWorkers::Loop, this, i);
+	}
+}
+
+PathWorkers::~PathWorkers()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wakeUp.notify_all();
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+}
+
+void PathWorkers::Loop(size_t idx)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	unsigned int seen = 0;
+	while (true) {
+		wakeUp.wait(lock, [this, seen]() { return stopping || batch != seen; });
+		if (stopping) return;
+
+		// late risers find nothing left and go back to sleep
+		seen = batch;
+		busy++;
+		Work(workspaces[idx], lock);
+		busy--;
+		if (!busy) {
+			done.notify_all();
+		}
+	}
+}
+
+void PathWorkers::Work(PathFinderWorkspace& ws, std::unique_lock<std::mutex>& lock)
+{
+	while (nextItem < itemCount) {
+		size_t item = nextItem++;
+		lock.unlock();
+		(*job)(item, ws);
+		lock.lock();
+	}
+}
+
+void PathWorkers::Run(size_t count, const Job& fn)
+{
+	if (!count) return;
+
+	std::unique_lock<std::mutex> lock(mutex);
+	job = &fn;
+	itemCount = count;
+	nextItem = 0;
+	batch++;
+	if (count > 1) {
+		wakeUp.notify_all();
+	}
+	Work(workspaces.back(), lock);
+	// everything is taken, wait for the items still being worked on
+	done.wait(lock, [this]() { return busy == 0; });
+	job = nullptr;
+}
+
+unsigned int PathRequests::Add(const Actor* caller, const Point& s, const Point& d, unsigned int size, unsigned int minDistance)
+{
+	if (++lastTicket == 0) {
+		lastTicket = 1;
+	}
+	queued.push_back({ lastTicket, caller->GetGlobalID(), s, d, size, minDistance, caller->ValidTarget(GA_CAN_BUMP), nullptr, NavmapPoint(), false, Path() });
+	return lastTicket;
+}
+
+void PathRequests::Solve(const Map& map, PathWorkers& workers)
+{
+	if (queued.empty()) return;
+	PROFILE_SCOPE(Pathfinding);
+
+	// skip what was replaced or cancelled in the meantime and pick the
+	// goals here, since that may roll the dice
+	// the searchers' footprints are lifted here too, like Movable::WalkTo
+	// does right before its search; other actors block through GetActor,
+	// so that doesn't change what the searches see of each other
+	size_t kept = 0;
+	for (Request& request : queued) {
+		const Actor* actor = map.GetActorByGlobalID(request.actorID);
+		if (!actor || actor->GetPathTicket() != request.ticket) {
+			continue;
+		}
+		if (actor->BlocksSearchMap()) {
+			map.ClearSearchMapFor(actor);
+		}
+		if (map.PreparePathGoal(request.dest, request.size, request.minDistance, actor, request.goal)) {
+			request.caller = actor;
+		}
+		if (&queued[kept] != &request) {
+			queued[kept] = std::move(request);
+		}
+		kept++;
+	}
+	queued.erase(queued.begin() + kept, queued.end());
+
+	workers.Run(queued.size(), [this, &map](size_t item, PathFinderWorkspace& ws) {
+		Request& request = queued[item];
+		if (!request.caller) return;
+
+		// like Movable::WalkTo, first around everyone, then through those that step aside
+		request.found = map.SolvePath(ws, request.start, request.dest, request.goal, request.size, request.minDistance, PF_SIGHT | PF_ACTORS_ARE_BLOCKING, request.caller);
+		if (!request.found && request.canBump) {
+			request.found = map.SolvePath(ws, request.start, request.dest, request.goal, request.size, request.minDistance, PF_SIGHT, request.caller);
+		}
+		if (request.found) {
+			std::swap(request.result, ws.result);
+		}
+	});
+
+	for (Request& request : queued) {
+		solved.push_back(std::move(request));
+	}
+	queued.clear();
+}
+
+// The actor kept walking its old path while the search ran, so the new one
+// is joined to where it stands now: it heads straight for the furthest step
+// it can walk to, or back to where the search started if there's none.
+static void SpliceToPosition(const Map& map, const Actor* actor, const NavmapPoint& start, Path& path)
+{
+	if (actor->Pos == start || path.empty()) return;
+
+	for (size_t i = path.size(); i-- > 0;) {
+		if (map.IsWalkableTo(actor->Pos, path[i].point, false, actor)) {
+			path.erase(path.begin(), path.begin() + i);
+			path.front().orient = GetOrient(path.front().point, actor->Pos);
+			return;
+		}
+	}
+	path.insert(path.begin(), PathNode { start, GetOrient(start, actor->Pos) });
+}
+
+void PathRequests::Deliver(const Map& map)
+{
+	for (Request& request : solved) {
+		Actor* actor = map.GetActorByGlobalID(request.actorID);
+		if (!actor || actor->GetPathTicket() != request.ticket) {
+			continue;
+		}
+		if (request.found) {
+			SpliceToPosition(map, actor, request.start, request.result);
+		} else {
+			Log(DEBUG, "FindPath", "Pathing failed for {}", fmt::WideToChar{actor->GetShortName()});
+		}
+		actor->PathSolved(request.found ? MakePathList(request.result) : nullptr, request.minDistance);
+		// Actor::NewPath couldn't count this try when it queued the search
+		if (!actor->GetPath()) {
+			actor->IncrementPathTries();
+		}
+	}
+	solved.clear();
+}
+
+}
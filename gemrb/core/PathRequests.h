@@ -0,0 +1,124 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef PATHREQUESTS_H
+#define PATHREQUESTS_H
+
+#include "exports.h"
+#include "ie_types.h"
+
+#include "PathFinder.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace GemRB {
+
+class Actor;
+class Map;
+
+/**
+ * @class PathWorkers
+ * Threads for solving a batch of path searches at once, each with its own
+ * workspace. The caller blocks in Run and takes items too, so nothing can
+ * change the map while the searches read it.
+ */
+
+class GEM_EXPORT PathWorkers {
+public:
+	using Job = std::function<void(size_t item, PathFinderWorkspace& ws)>;
+
+private:
+	std::vector<std::thread> threads;
+	// one for each thread and the last one for the caller of Run
+	std::vector<PathFinderWorkspace> workspaces;
+
+	std::mutex mutex;
+	std::condition_variable wakeUp;
+	std::condition_variable done;
+	const Job* job = nullptr;
+	size_t itemCount = 0;
+	size_t nextItem = 0;
+	// threads working on the current batch
+	size_t busy = 0;
+	unsigned int batch = 0;
+	bool stopping = false;
+
+	void Loop(size_t idx);
+	void Work(PathFinderWorkspace& ws, std::unique_lock<std::mutex>& lock);
+
+public:
+	explicit PathWorkers(unsigned int count);
+	PathWorkers(const PathWorkers&) = delete;
+	~PathWorkers();
+	PathWorkers& operator=(const PathWorkers&) = delete;
+
+	/** Calls job for every item below count and returns when all are done */
+	void Run(size_t count, const Job& job);
+	size_t GetThreadCount() const { return threads.size(); }
+};
+
+/**
+ * @class PathRequests
+ * The path searches the actors of a map asked for during a tick. They are
+ * solved together at the end of the tick and handed out at the start of
+ * the next one, see Movable::WalkTo. A request only gets delivered if its
+ * actor still waits for that ticket, so new orders cancel the old ones.
+ */
+
+class GEM_EXPORT PathRequests {
+private:
+	struct Request {
+		unsigned int ticket;
+		ieDword actorID;
+		NavmapPoint start;
+		NavmapPoint dest;
+		unsigned int size;
+		unsigned int minDistance;
+		// try again ignoring the actors that can be bumped away
+		bool canBump;
+
+		// filled in while solving
+		const Actor* caller;
+		NavmapPoint goal;
+		bool found;
+		Path result;
+	};
+
+	std::vector<Request> queued;
+	std::vector<Request> solved;
+	unsigned int lastTicket = 0;
+
+public:
+	/** Queues a search and returns its ticket, never 0 */
+	unsigned int Add(const Actor* caller, const Point& s, const Point& d, unsigned int size, unsigned int minDistance);
+	/** Solves everything queued, blocking until done */
+	void Solve(const Map& map, PathWorkers& workers);
+	/** Hands the solved paths to the actors still waiting for them */
+	void Deliver(const Map& map);
+	size_t GetQueuedCount() const { return queued.size(); }
+};
+
+}
+
+#endif
@@ -26,6 +26,7 @@
 #include "GameData.h"
 #include "GlobalTimer.h"
 #include "Interface.h"
+#include "ObjectPool.h"
 #include "ProjectileServer.h"
 #include "Sprite2D.h"
 #include "VEFObject.h"
@@ -53,6 +54,16 @@ Projectile::Projectile() noexcept
 	shadow.resize(MAX_ORIENT);
 }
 
+void* Projectile::operator new(size_t size)
+{
+	return ObjectPool<Projectile>::Get().Allocate(size);
+}
+
+void Projectile::operator delete(void* ptr, size_t size)
+{
+	ObjectPool<Projectile>::Get().Release(ptr, size);
+}
+
 Projectile::AnimArray Projectile::CreateAnimations(const ResRef& bamres, int Seq)
 {
 	const AnimationFactory* af = static_cast<const AnimationFactory*>(
@@ -213,6 +213,9 @@ public:
 	Projectile& operator=(const Projectile&) noexcept = default;
 	Projectile& operator=(Projectile&&) noexcept = default;
 #endif
+	// every shot is a copy of a template, so the memory is pooled
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr, size_t size);
 
 	ieWord Speed = 20; // (horizontal) pixels / tick
 	ieDword SFlags = PSF_FLYING;
@@ -41,6 +41,8 @@ class GEM_EXPORT RNG {
 	std::mt19937_64 engine;
 	public:
 	static RNG& getInstance();
+	// for reproducible runs, the seed is per thread like the generator
+	void seed(uint32_t value) noexcept { engine.seed(value); }
 	
 	/**
 	 * It is possible to generate random numbers from [-min, +/-max].
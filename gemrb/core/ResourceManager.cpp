@@ -35,6 +35,7 @@ bool ResourceManager::AddSource(const char *path, const char *description, Plugi
 		return false;
 	}
 
+	std::lock_guard<std::mutex> lock(sourcesLock);
 	if (flags & RM_REPLACE_SAME_SOURCE) {
 		for (auto& path2 : searchPath) {
 			if (description == path2->GetDescription()) {
@@ -48,6 +49,18 @@ bool ResourceManager::AddSource(const char *path, const char *description, Plugi
 	return true;
 }
 
+void ResourceManager::AddSourceFirst(std::shared_ptr<ResourceSource> source)
+{
+	std::lock_guard<std::mutex> lock(sourcesLock);
+	searchPath.insert(searchPath.begin(), std::move(source));
+}
+
+std::vector<std::shared_ptr<ResourceSource> > ResourceManager::GetSources() const
+{
+	std::lock_guard<std::mutex> lock(sourcesLock);
+	return searchPath;
+}
+
 static void PrintPossibleFiles(std::string& buffer, const char* ResRef, const TypeID *type)
 {
 	const std::vector<ResourceDesc>& types = PluginMgr::Get()->GetResourceDesc(type);
@@ -61,7 +74,7 @@ bool ResourceManager::Exists(const char *ResRef, SClass_ID type, bool silent) co
 	if (!ResRef || ResRef[0] == '\0')
 		return false;
 	// TODO: check various caches
-	for (const auto& path : searchPath) {
+	for (const auto& path : GetSources()) {
 		if (path->HasResource(ResRef, type)) {
 			return true;
 		}
@@ -79,8 +92,9 @@ bool ResourceManager::Exists(const char *ResRef, const TypeID *type, bool silent
 		return false;
 	// TODO: check various caches
 	const std::vector<ResourceDesc> &types = PluginMgr::Get()->GetResourceDesc(type);
+	const auto sources = GetSources();
 	for (const auto& type2 : types) {
-		for (const auto& path : searchPath) {
+		for (const auto& path : sources) {
 			if (path->HasResource(ResRef, type2)) {
 				return true;
 			}
@@ -118,7 +132,7 @@ DataStream* ResourceManager::GetResource(const char* ResRef, SClass_ID type, boo
 {
 	if (!ResRef || ResRef[0] == '\0')
 		return NULL;
-	for (const auto& path : searchPath) {
+	for (const auto& path : GetSources()) {
 		DataStream *ds = path->GetResource(ResRef, type);
 		if (ds) {
 			if (!silent) {
@@ -141,8 +155,9 @@ Resource* ResourceManager::GetResource(const char* ResRef, const TypeID *type, b
 		Log(MESSAGE, "ResourceManager", "Searching for '{}'...", ResRef);
 	}
 	const std::vector<ResourceDesc> &types = PluginMgr::Get()->GetResourceDesc(type);
+	const auto sources = GetSources();
 	for (const auto& type2 : types) {
-		for (const auto& path : searchPath) {
+		for (const auto& path : sources) {
 			DataStream *str = path->GetResource(ResRef, type2);
 			if (!str && useCorrupt && core->UseCorruptedHack) {
 				// don't look at other paths if requested
@@ -27,6 +27,8 @@
 #include "Resource.h"
 #include "ResourceSource.h"
 
+#include <memory>
+#include <mutex>
 #include <vector>
 
 namespace GemRB {
@@ -46,6 +48,8 @@ public:
 	 * @param[in] type Plugin type used for source.
 	 **/
 	bool AddSource(const char *path, const char *description, PluginID type, int flags=0);
+	/** Puts an already opened source in front of all the others */
+	void AddSourceFirst(std::shared_ptr<ResourceSource> source);
 
 	/** returns true if resource exists */
 	bool Exists(const char *resRef, SClass_ID type, bool silent=false) const;
@@ -63,6 +67,12 @@ public:
 
 private:
 	std::vector<std::shared_ptr<ResourceSource> > searchPath;
+	// lookups also happen from background threads (see AreaPrefetcher), so
+	// they work on a copy and the sources guard their own state; that way a
+	// slow source doesn't hold up lookups elsewhere
+	mutable std::mutex sourcesLock;
+
+	std::vector<std::shared_ptr<ResourceSource> > GetSources() const;
 };
 
 }
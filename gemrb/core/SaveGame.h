@@ -27,6 +27,8 @@
 #include "ResourceManager.h"
 #include "System/VFS.h"
 
+#include <ctime>
+
 namespace GemRB {
 
 class ImageMgr;
@@ -36,7 +38,7 @@ class GEM_EXPORT SaveGame : public Held<SaveGame> {
 public:
 	static const TypeID ID;
 public:
-	SaveGame(const char* path, const char* name, const char* prefix, const char* slotname, int pCount, int saveID);
+	SaveGame(const char* path, const char* name, const char* prefix, const char* slotname, int pCount, int saveID, time_t saved, int gameTime);
 	~SaveGame() override = default;
 	int GetPortraitCount() const
 	{
@@ -73,7 +75,12 @@ public:
 	DataStream* GetGame() const;
 	DataStream* GetWmap(int idx) const;
 	DataStream* GetSave() const;
+
+	// the game time stored in the GAM, -1 if it isn't one
+	static int ReadGameTime(DataStream* ds);
 private:
+	void OpenSlot() const;
+
 	char Path[_MAX_PATH];
 	char Prefix[10];
 	char Name[_MAX_PATH];
@@ -82,7 +89,10 @@ private:
 	char SlotName[_MAX_PATH];
 	int PortraitCount;
 	int SaveID;
-	ResourceManager manager;
+	int GameTime;
+	// set up on first use, since listing the saves doesn't need it
+	mutable ResourceManager manager;
+	mutable bool slotOpen = false;
 };
 
 }
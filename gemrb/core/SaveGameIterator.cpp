@@ -51,19 +51,30 @@ namespace GemRB {
 
 const TypeID SaveGame::ID = { "SaveGame" };
 
-/** Extract date from save game ds into Date. */
-static std::string ParseGameDate(DataStream *ds)
+int SaveGame::ReadGameTime(DataStream *ds)
 {
+	if (!ds) {
+		return -1;
+	}
 	char Signature[8];
 	ieDword GameTime;
 	ds->Read(Signature, 8);
 	ds->ReadDword(GameTime);
 	delete ds;
 	if (memcmp(Signature, "GAME", 4) != 0) {
+		return -1;
+	}
+	return (int) GameTime;
+}
+
+/** Turn the game time of a save into a date. */
+static std::string FormatGameDate(int GameTime)
+{
+	if (GameTime < 0) {
 		return "ERROR";
 	}
 
-	int hours = ((int)GameTime)/core->Time.hour_sec;
+	int hours = GameTime / core->Time.hour_sec;
 	int days = hours/24;
 	hours -= days*24;
 	std::string a, b, c;
@@ -94,7 +105,7 @@ static std::string ParseGameDate(DataStream *ds)
 	}
 }
 
-SaveGame::SaveGame(const char* path, const char* name, const char* prefix, const char* slotname, int pCount, int saveID)
+SaveGame::SaveGame(const char* path, const char* name, const char* prefix, const char* slotname, int pCount, int saveID, time_t saved, int gameTime)
 {
 	strlcpy( Prefix, prefix, sizeof( Prefix ) );
 	strlcpy( Path, path, sizeof( Path ) );
@@ -102,20 +113,22 @@ SaveGame::SaveGame(const char* path, const char* name, const char* prefix, const
 	strlcpy( SlotName, slotname, sizeof( SlotName ) );
 	PortraitCount = pCount;
 	SaveID = saveID;
-	char nPath[_MAX_PATH];
-	struct stat my_stat;
-	PathJoinExt(nPath, Path, Prefix, "bmp");
-	memset(&my_stat,0,sizeof(my_stat));
-	if (stat(nPath, &my_stat)) {
-		Log(ERROR, "SaveGameIterator", "Stat call failed, using dummy time!");
-		strlcpy(Date, "Sun 31 Feb 00:00:01 2099", _MAX_PATH);
+	GameTime = gameTime;
+	if (saved) {
+		strftime(Date, _MAX_PATH, "%c", localtime(&saved));
 	} else {
-		strftime(Date, _MAX_PATH, "%c", localtime(&my_stat.st_mtime));
+		strlcpy(Date, "Sun 31 Feb 00:00:01 2099", _MAX_PATH);
 	}
-	manager.AddSource(Path, Name, PLUGIN_RESOURCE_DIRECTORY);
 	GameDate[0] = '\0';
 }
 
+void SaveGame::OpenSlot() const
+{
+	if (slotOpen) return;
+	manager.AddSource(Path, Name, PLUGIN_RESOURCE_DIRECTORY);
+	slotOpen = true;
+}
+
 Holder<Sprite2D> SaveGame::GetPortrait(int index) const
 {
 	if (index > PortraitCount) {
@@ -123,6 +136,7 @@ Holder<Sprite2D> SaveGame::GetPortrait(int index) const
 	}
 	char nPath[_MAX_PATH];
 	snprintf(nPath, _MAX_PATH, "PORTRT%d", index);
+	OpenSlot();
 	ResourceHolder<ImageMgr> im = GetResourceHolder<ImageMgr>(nPath, manager, true);
 	if (!im)
 		return NULL;
@@ -131,6 +145,7 @@ Holder<Sprite2D> SaveGame::GetPortrait(int index) const
 
 Holder<Sprite2D> SaveGame::GetPreview() const
 {
+	OpenSlot();
 	ResourceHolder<ImageMgr> im = GetResourceHolder<ImageMgr>(Prefix, manager, true);
 	if (!im)
 		return NULL;
@@ -139,23 +154,26 @@ Holder<Sprite2D> SaveGame::GetPreview() const
 
 DataStream* SaveGame::GetGame() const
 {
+	OpenSlot();
 	return manager.GetResource(Prefix, IE_GAM_CLASS_ID, true);
 }
 
 DataStream* SaveGame::GetWmap(int idx) const
 {
+	OpenSlot();
 	return manager.GetResource(core->WorldMapName[idx], IE_WMP_CLASS_ID, true);
 }
 
 DataStream* SaveGame::GetSave() const
 {
+	OpenSlot();
 	return manager.GetResource(Prefix, IE_SAV_CLASS_ID, true);
 }
 
 const char* SaveGame::GetGameDate() const
 {
 	if (GameDate[0] == '\0')
-		strcpy(GameDate, ParseGameDate(GetGame()).c_str());
+		strcpy(GameDate, FormatGameDate(GameTime).c_str());
 	return GameDate;
 }
 
@@ -255,6 +273,9 @@ static bool IsSaveGameSlot(const char* Path, const char* slotname)
 	return true;
 }
 
+#define SAVE_INDEX_FILE "gemrb.idx"
+#define SAVE_INDEX_SIGNATURE "GemRB save index 1"
+
 bool SaveGameIterator::RescanSaveGames()
 {
 	// delete old entries
@@ -275,20 +296,57 @@ bool SaveGameIterator::RescanSaveGames()
 	if (!dir) { //If we cannot open the Directory
 		return false;
 	}
+	LoadIndex(Path);
 
 	std::set<std::string> slots;
 	dir.SetFlags(DirectoryIterator::Directories);
 	do {
 		const char *name = dir.GetName();
-		if (IsSaveGameSlot( Path, name )) {
+		if (name[0] != '.') {
 			slots.emplace(name);
 		}
 	} while (++dir);
 
+	bool changed = false;
+	for (auto it = slotIndex.begin(); it != slotIndex.end();) {
+		if (slots.count(it->first)) {
+			++it;
+		} else {
+			it = slotIndex.erase(it);
+			changed = true;
+		}
+	}
+
+	// the names come straight from the listing, so there's no need
+	// to resolve their case like PathJoin does
+	std::string slotPath;
 	for (const auto& slot : slots) {
-		save_slots.push_back(BuildSaveGame(slot.c_str()));
+		slotPath = fmt::format("{}{}{}", Path, SPathDelimiter, slot);
+		struct stat slotStat;
+		if (stat(slotPath.c_str(), &slotStat)) {
+			continue;
+		}
+
+		SlotInfo& info = slotIndex[slot];
+		if (info.modified != slotStat.st_mtime) {
+			info = ScanSlot(Path, slot.c_str());
+			info.modified = slotStat.st_mtime;
+			changed = true;
+		}
+		if (!info.valid) {
+			continue;
+		}
+		if (!info.save) {
+			info.save = BuildSaveGame(Path, slot.c_str(), info);
+		}
+		if (info.save) {
+			save_slots.push_back(info.save);
+		}
 	}
 
+	if (changed) {
+		WriteIndex();
+	}
 	return true;
 }
 
@@ -310,37 +368,155 @@ Holder<SaveGame> SaveGameIterator::GetSaveGame(const char *name)
 	return NULL;
 }
 
-Holder<SaveGame> SaveGameIterator::BuildSaveGame(const char *slotname)
+// Does the slow checks on a slot directory and reads what the list shows
+SaveGameIterator::SlotInfo SaveGameIterator::ScanSlot(const char *path, const char *slotname)
+{
+	SlotInfo info;
+	if (!IsSaveGameSlot(path, slotname)) {
+		return info;
+	}
+
+	char Path[_MAX_PATH];
+	//lets leave space for the filenames
+	PathJoin(Path, path, slotname, nullptr);
+	//maximum pathlength == 240, without 8+3 filenames
+	if (strlen(Path) > 240) {
+		Log(WARNING, "SaveGame", "Invalid savegame directory '{}' in {}.", slotname, Path);
+		return info;
+	}
+
+	DirectoryIterator dir(Path);
+	if (!dir) {
+		return info;
+	}
+	do {
+		if (strnicmp( dir.GetName(), "PORTRT", 6 ) == 0)
+			info.portraits++;
+	} while (++dir);
+
+	char nPath[_MAX_PATH];
+	struct stat my_stat;
+	PathJoinExt(nPath, Path, core->GameNameResRef, "bmp");
+	memset(&my_stat,0,sizeof(my_stat));
+	if (stat(nPath, &my_stat)) {
+		Log(ERROR, "SaveGameIterator", "Stat call failed, using dummy time!");
+	} else {
+		info.saved = my_stat.st_mtime;
+	}
+
+	PathJoinExt(nPath, Path, core->GameNameResRef, "gam");
+	info.gameTime = SaveGame::ReadGameTime(FileStream::OpenFile(nPath));
+	info.valid = true;
+	return info;
+}
+
+Holder<SaveGame> SaveGameIterator::BuildSaveGame(const char *path, const char *slotname, const SlotInfo& info)
 {
 	if (!slotname) {
 		return NULL;
 	}
 
-	int prtrt = 0;
 	char Path[_MAX_PATH];
-	//lets leave space for the filenames
-	PathJoin(Path, core->config.SavePath, SaveDir(), slotname, nullptr);
+	PathJoin(Path, path, slotname, nullptr);
 
 	char savegameName[_MAX_PATH]={0};
 	int savegameNumber = 0;
 
 	int cnt = sscanf( slotname, SAVEGAME_DIRECTORY_MATCHER, &savegameNumber, savegameName );
-	//maximum pathlength == 240, without 8+3 filenames
-	if ( (cnt != 2) || (strlen(Path)>240) ) {
+	if (cnt != 2) {
 		Log(WARNING, "SaveGame", "Invalid savegame directory '{}' in {}.", slotname, Path);
 		return NULL;
 	}
 
-	DirectoryIterator dir(Path);
-	if (!dir) {
-		return NULL;
+	return MakeHolder<SaveGame>(Path, savegameName, core->GameNameResRef, slotname, info.portraits, savegameNumber, info.saved, info.gameTime);
+}
+
+// one line per slot: the modification times of the directory and the
+// preview, whether it's usable, the portrait count, the game time and
+// finally the directory name, which may contain spaces
+void SaveGameIterator::LoadIndex(const char *path) const
+{
+	if (indexDir == path) {
+		return;
+	}
+	indexDir = path;
+	slotIndex.clear();
+
+	char indexPath[_MAX_PATH];
+	PathJoin(indexPath, path, SAVE_INDEX_FILE, nullptr);
+	FileStream* str = FileStream::OpenFile(indexPath);
+	if (!str) {
+		return;
 	}
-	do {
-		if (strnicmp( dir.GetName(), "PORTRT", 6 ) == 0)
-			prtrt++;
-	} while (++dir);
 
-	return MakeHolder<SaveGame>(Path, savegameName, core->GameNameResRef, slotname, prtrt, savegameNumber);
+	char line[_MAX_PATH * 2];
+	if (str->ReadLine(line, sizeof(line)) < 0 || strcmp(line, SAVE_INDEX_SIGNATURE) != 0) {
+		Log(WARNING, "SaveGameIterator", "Ignoring the outdated save index in {}.", path);
+		delete str;
+		return;
+	}
+	while (str->ReadLine(line, sizeof(line)) >= 0) {
+		long long modified;
+		long long saved;
+		int valid;
+		int portraits;
+		int gameTime;
+		int nameStart = 0;
+		if (sscanf(line, "%lld %lld %d %d %d %n", &modified, &saved, &valid, &portraits, &gameTime, &nameStart) < 5 || !nameStart || !line[nameStart]) {
+			continue;
+		}
+		SlotInfo& info = slotIndex[line + nameStart];
+		info.modified = time_t(modified);
+		info.saved = time_t(saved);
+		info.valid = valid != 0;
+		info.portraits = portraits;
+		info.gameTime = gameTime;
+	}
+	delete str;
+}
+
+void SaveGameIterator::WriteIndex() const
+{
+	if (indexDir.empty()) {
+		return;
+	}
+
+	char indexPath[_MAX_PATH];
+	PathJoin(indexPath, indexDir.c_str(), SAVE_INDEX_FILE, nullptr);
+	FileStream str;
+	if (!str.Create(indexPath)) {
+		Log(WARNING, "SaveGameIterator", "Unable to write the save index to {}.", indexPath);
+		return;
+	}
+
+	std::string lines = SAVE_INDEX_SIGNATURE "\n";
+	for (const auto& slot : slotIndex) {
+		const SlotInfo& info = slot.second;
+		lines += fmt::format("{} {} {:d} {} {} {}\n", (long long) info.modified, (long long) info.saved,
+				     info.valid, info.portraits, info.gameTime, slot.first);
+	}
+	str.Write(lines.c_str(), lines.size());
+}
+
+// brings the index up to date after a slot was written or deleted,
+// so listing the saves next time doesn't have to find that out
+void SaveGameIterator::IndexSlot(const char *slotPath) const
+{
+	const char *slotname = strrchr(slotPath, PathDelimiter);
+	if (!slotname || indexDir != std::string(slotPath, slotname - slotPath)) {
+		return;
+	}
+	slotname++;
+
+	struct stat slotStat;
+	if (stat(slotPath, &slotStat)) {
+		slotIndex.erase(slotname);
+	} else {
+		SlotInfo info = ScanSlot(indexDir.c_str(), slotname);
+		info.modified = slotStat.st_mtime;
+		slotIndex[slotname] = info;
+	}
+	WriteIndex();
 }
 
 void SaveGameIterator::PruneQuickSave(const char *folder) const
@@ -617,6 +793,8 @@ int SaveGameIterator::CreateSaveGame(int index, bool mqs) const
 		return GEM_ERROR;
 	}
 
+	IndexSlot(Path);
+
 	// Save successful / Quick-save successful
 	if (qsave) {
 		displaymsg->DisplayConstantString(STR_QSAVESUCCEED, DMC_BG2XPGREEN);
@@ -681,6 +859,8 @@ int SaveGameIterator::CreateSaveGame(Holder<SaveGame> save, const char *slotname
 		return GEM_ERROR;
 	}
 
+	IndexSlot(Path);
+
 	// Save successful
 	displaymsg->DisplayConstantString(STR_SAVESUCCEED, DMC_BG2XPGREEN);
 	gc->SetDisplayText(STR_SAVESUCCEED, 30);
@@ -695,6 +875,7 @@ void SaveGameIterator::DeleteSaveGame(const Holder<SaveGame>& game) const
 
 	core->DelTree( game->GetPath(), false ); //remove all files from folder
 	rmdir( game->GetPath() );
+	IndexSlot(game->GetPath());
 }
 
 }
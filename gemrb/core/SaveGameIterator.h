@@ -25,6 +25,9 @@
 
 #include "SaveGame.h"
 
+#include <ctime>
+#include <map>
+#include <string>
 #include <vector>
 
 namespace GemRB {
@@ -36,6 +39,20 @@ private:
 	using charlist = std::vector<Holder<SaveGame>>;
 	charlist save_slots;
 
+	// what we know about each slot directory, so only new and changed ones
+	// need to be looked at again; it's kept in the save directory as well
+	struct SlotInfo {
+		time_t modified = -1; // of the slot directory
+		bool valid = false;
+		int portraits = 0;
+		time_t saved = 0; // of the preview, shown as the save date
+		int gameTime = -1;
+		Holder<SaveGame> save;
+	};
+	mutable std::map<std::string, SlotInfo> slotIndex;
+	// the save directory the index belongs to
+	mutable std::string indexDir;
+
 public:
 	SaveGameIterator() noexcept = default;
 	~SaveGameIterator() noexcept = default;
@@ -46,7 +63,11 @@ public:
 	Holder<SaveGame> GetSaveGame(const char *slotname);
 private:
 	bool RescanSaveGames();
-	static Holder<SaveGame> BuildSaveGame(const char *slotname);
+	static SlotInfo ScanSlot(const char *path, const char *slotname);
+	static Holder<SaveGame> BuildSaveGame(const char *path, const char *slotname, const SlotInfo& info);
+	void LoadIndex(const char *path) const;
+	void WriteIndex() const;
+	void IndexSlot(const char *slotPath) const;
 	void PruneQuickSave(const char *folder) const;
 };
 
@@ -3569,6 +3569,27 @@ void Actor::DisplayStringOrVerbalConstant(size_t str, int vcstat, int vccount) c
 	}
 }
 
+void Actor::GetBattleSounds(std::vector<std::string>& sounds) const
+{
+	for (int vc = VB_ATTACK; vc <= VB_HURT; vc++) {
+		if (PCStats && !PCStats->SoundSet.IsEmpty()) {
+			ResRef soundRef;
+			GetVerbalConstantSound(soundRef, vc);
+			if (!soundRef.IsEmpty()) {
+				sounds.push_back(GetSoundFolder(1, soundRef));
+			}
+			continue;
+		}
+
+		ieStrRef strref = GetVerbalConstant(vc);
+		if (strref == ieStrRef::INVALID) continue;
+		StringBlock sb = core->strings->GetStringBlock(strref);
+		if (!sb.Sound.IsEmpty()) {
+			sounds.emplace_back(sb.Sound.CString());
+		}
+	}
+}
+
 bool Actor::HasSpecialDeathReaction(const ieVariable& deadname) const
 {
 	AutoTable tm = gamedata->LoadTable("death");
@@ -7830,7 +7851,8 @@ void Actor::NewPath()
 		return;
 	}
 	WalkTo(savedDest, InternalFlags, pathfindingDistance);
-	if (!GetPath()) {
+	// queued searches count their try once solved, see PathRequests::Deliver
+	if (!PathPending() && !GetPath()) {
 		IncrementPathTries();
 	}
 }
@@ -627,6 +627,8 @@ public:
 	bool VerbalConstant(int start, int count=1, int flags=0) const;
 	/* display string or verbal constant depending on what is available */
 	void DisplayStringOrVerbalConstant(size_t str, int vcstat, int vccount=1) const;
+	/* adds the sounds of the battle verbal constants, for preloading */
+	void GetBattleSounds(std::vector<std::string>& sounds) const;
 	/* inlined dialogue response */
 	void Response(int type) const;
 	/* called when someone died in the party */
@@ -565,7 +565,8 @@ bool Scriptable::InMove() const
 		return false;
 	}
 	Movable *me = (Movable *) this;
-	return me->GetStep() != NULL;
+	// waiting for a queued search counts too, so actions don't give up early
+	return me->GetStep() != NULL || me->PathPending();
 }
 
 void Scriptable::SetWait(tick_t time)
@@ -2026,7 +2027,9 @@ void Movable::BumpAway()
 	if (!IsBumped()) oldPos = Pos;
 	bumped = true;
 	bumpBackTries = 0;
-	area->AdjustPositionNavmap(Pos);
+	Point p = Pos;
+	area->AdjustPositionNavmap(p);
+	SetPos(p);
 }
 
 void Movable::BumpBack()
@@ -2137,8 +2140,7 @@ void Movable::DoStep(unsigned int walkScale, ieDword time) {
 		if (InternalFlags & IF_RUNNING) {
 			StanceID = IE_ANI_RUN;
 		}
-		Pos.x += dx;
-		Pos.y += dy;
+		SetPos(Pos + Point(dx, dy));
 		oldPos = Pos;
 		if (actor && BlocksSearchMap()) {
 			auto flag = actor->IsPartyMember() ? PathMapFlags::PC : PathMapFlags::NPC;
@@ -2159,9 +2161,19 @@ void Movable::DoStep(unsigned int walkScale, ieDword time) {
 	}
 }
 
+void Movable::SetPos(const Point &p)
+{
+	Pos = p;
+	if (area) {
+		area->ActorMoved(this);
+	}
+}
+
 void Movable::AdjustPosition()
 {
-	area->AdjustPosition(Pos);
+	Point p = Pos;
+	area->AdjustPosition(p);
+	SetPos(p);
 	ImpedeBumping();
 }
 
@@ -2217,13 +2229,26 @@ void Movable::WalkTo(const Point &Des, int distance)
 		return;
 	}
 
+	if (actor && core->GetPathWorkers()) {
+		// solved at the end of the tick, meanwhile we keep to the old path
+		// and our footprint, see PathRequests::Solve
+		pathTicket = area->QueuePath(actor, Pos, Des, circleSize, distance);
+		return;
+	}
+
 	if (BlocksSearchMap()) area->ClearSearchMapFor(this);
+
 	PathListNode* newPath = area->FindPath(Pos, Des, circleSize, distance, PF_SIGHT | PF_ACTORS_ARE_BLOCKING, actor);
 	if (!newPath && actor && actor->ValidTarget(GA_CAN_BUMP)) {
 		Log(DEBUG, "WalkTo", "{} re-pathing ignoring actors", fmt::WideToChar{actor->GetShortName()});
 		newPath = area->FindPath(Pos, Des, circleSize, distance, PF_SIGHT, actor);
 	}
+	PathSolved(newPath, distance);
+}
 
+void Movable::PathSolved(PathListNode* newPath, int distance)
+{
+	pathTicket = 0;
 	if (newPath) {
 		ClearPath(false);
 		path = newPath;
@@ -2319,7 +2344,7 @@ void Movable::RandomWalk(bool can_stop, bool run)
 void Movable::MoveTo(const Point &Des)
 {
 	area->ClearSearchMapFor(this);
-	Pos = Des;
+	SetPos(Des);
 	oldPos = Des;
 	Destination = Des;
 	if (BlocksSearchMap()) {
@@ -2336,6 +2361,8 @@ void Movable::Stop(int flags)
 void Movable::ClearPath(bool resetDestination)
 {
 	pathAbandoned = false;
+	// also cancels any queued search
+	pathTicket = 0;
 
 	if (resetDestination) {
 		//this is to make sure attackers come to us
@@ -492,6 +492,8 @@ private: //these seem to be sensitive, so get protection
 	unsigned int prevTicks = 0;
 	int bumpBackTries = 0;
 	bool pathAbandoned = false;
+	// of the search queued with Map::QueuePath, 0 if none
+	unsigned int pathTicket = 0;
 protected:
 	ieDword timeStartStep = 0;
 	//the # of previous tries to pick up a new walkpath
@@ -528,6 +530,8 @@ public:
 	inline bool IsBumped() const { return bumped; }
 	PathListNode *GetNextStep(int x) const;
 	inline PathListNode *GetPath() const { return path; };
+	inline bool PathPending() const { return pathTicket != 0; }
+	inline unsigned int GetPathTicket() const { return pathTicket; }
 	inline int GetPathTries() const	{ return pathTries; }
 	inline void IncrementPathTries() { pathTries++; }
 	inline void ResetPathTries() { pathTries = 0; }
@@ -564,7 +568,12 @@ public:
 	int GetRandomWalkCounter() const { return randomWalkCounter; };
 	void MoveLine(int steps, orient_t Orient);
 	void WalkTo(const Point &Des, int MinDistance = 0);
+	// takes over the path found by WalkTo (or nothing, if there was none)
+	void PathSolved(PathListNode* newPath, int distance);
 	void MoveTo(const Point &Des);
+	// sets Pos and keeps the area's actor lookup current; unlike MoveTo it
+	// leaves the search map and the destination alone
+	void SetPos(const Point &p);
 	void Stop(int flags = 0) override;
 	void ClearPath(bool resetDestination = true);
 	void HandleAnkhegStance(bool emerge);
@@ -29,6 +29,7 @@
 #include "GameData.h"
 #include "Interface.h"
 #include "Map.h"
+#include "ObjectPool.h"
 #include "Video/Pixels.h"
 #include "Sprite2D.h"
 
@@ -313,6 +314,57 @@ ScriptedAnimation::ScriptedAnimation(DataStream* stream)
 	delete stream;
 }
 
+ScriptedAnimation* ScriptedAnimation::Clone() const
+{
+	ScriptedAnimation* sca = new ScriptedAnimation();
+	for (size_t i = 0; i < 3 * MAX_ORIENT; i++) {
+		if (anims[i]) {
+			sca->anims[i] = new Animation(*anims[i]);
+		}
+	}
+	sca->palette = palette;
+	sca->sharedPalette = bool(palette);
+	std::copy(std::begin(sounds), std::end(sounds), sca->sounds);
+	sca->Tint = Tint;
+	sca->Fade = Fade;
+	sca->Transparency = Transparency;
+	sca->SequenceFlags = SequenceFlags;
+	sca->Dither = Dither;
+	sca->Pos = Pos;
+	sca->XOffset = XOffset;
+	sca->YOffset = YOffset;
+	sca->ZOffset = ZOffset;
+	sca->LightX = LightX;
+	sca->LightY = LightY;
+	sca->LightZ = LightZ;
+	sca->FrameRate = FrameRate;
+	sca->NumOrientations = NumOrientations;
+	sca->Orientation = Orientation;
+	sca->OrientationFlags = OrientationFlags;
+	sca->Duration = Duration;
+	sca->Delay = Delay;
+	sca->justCreated = justCreated;
+	sca->ResName = ResName;
+	sca->Phase = Phase;
+	sca->SoundPhase = SoundPhase;
+	sca->active = active;
+	sca->effect_owned = effect_owned;
+	if (twin) {
+		sca->twin = twin->Clone();
+	}
+	return sca;
+}
+
+void* ScriptedAnimation::operator new(size_t size)
+{
+	return ObjectPool<ScriptedAnimation>::Get().Allocate(size);
+}
+
+void ScriptedAnimation::operator delete(void* ptr, size_t size)
+{
+	ObjectPool<ScriptedAnimation>::Get().Release(ptr, size);
+}
+
 ScriptedAnimation::~ScriptedAnimation(void)
 {
 	for (Animation *anim : anims) {
@@ -363,6 +415,7 @@ void ScriptedAnimation::PlayOnce()
 void ScriptedAnimation::SetFullPalette(const ResRef &PaletteResRef)
 {
 	palette = gamedata->GetPalette(PaletteResRef);
+	sharedPalette = false;
 	if (twin) {
 		twin->SetFullPalette(PaletteResRef);
 	}
@@ -690,8 +743,14 @@ void ScriptedAnimation::SetFade(ieByte initial, int speed)
 
 void ScriptedAnimation::GetPaletteCopy()
 {
-	if (palette)
+	if (palette) {
+		if (sharedPalette) {
+			palette = palette->Copy();
+			sharedPalette = false;
+		}
 		return;
+	}
+	sharedPalette = false;
 	//it is not sure that the first position will have a resource in it
 	//therefore the cycle
 	for (const Animation *anim : anims) {
@@ -103,6 +103,11 @@ public:
 	ScriptedAnimation& operator=(const ScriptedAnimation&) = delete;
 	explicit ScriptedAnimation(DataStream* stream);
 	void LoadAnimationFactory(AnimationFactory *af, int gettwin = 0);
+	/** Returns a new copy of this animation as loaded, sharing the frames and the palette */
+	ScriptedAnimation* Clone() const;
+	// they're spawned by the dozen in fights, so the memory is pooled
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr, size_t size);
 	//there are 3 phases: start, hold, release
 	//it will usually cycle in the 2. phase
 	//the anims could also be used 'orientation based' if NumOrientations is
@@ -135,6 +140,9 @@ public:
 	bool effect_owned = false;
 	Holder<SoundHandle> sound_handle;
 	tick_t starttime = 0;
+private:
+	// the palette still belongs to the template, copy before changing it
+	bool sharedPalette = false;
 public:
 	//draws the next frame of the videocell
 	bool UpdateDrawingState(orient_t orientation);
@@ -44,6 +44,11 @@ public:
 	 * @returns Number of samples read.
 	 */
 	virtual int read_samples( short* memory, int cnt ) = 0 ;
+	/**
+	 * Decodes without any cpu specific speedups from here on, as a reference
+	 * to check those against. Call it before reading any samples.
+	 */
+	virtual void UseReferenceDecoder() {}
 	int get_channels() const
 	{
 		return channels;
@@ -35,6 +35,11 @@ DataStream::DataStream() noexcept
 	IsCPUBigEndian = ((char *)&endiantest)[1] == 1;
 }
 
+const void* DataStream::ViewBytes(strpos_t)
+{
+	return nullptr;
+}
+
 bool DataStream::NeedEndianSwap() const noexcept
 {
 	return IsCPUBigEndian != IsDataBigEndian;
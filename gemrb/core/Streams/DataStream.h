@@ -83,6 +83,9 @@ public:
 	// if (NeedEndianSwap()) swabs(..., len);
 	virtual strret_t Read(void* dest, strpos_t len) = 0;
 	virtual strret_t Write(const void* src, strpos_t len) = 0;
+	/** Skips the next len bytes and returns where they are, without copying.
+	 * Only for streams in memory, the others return null and stay put. */
+	virtual const void* ViewBytes(strpos_t len);
 	
 	template <typename T>
 	strret_t ReadScalar(T& dest) {
@@ -181,6 +184,7 @@ public:
 	 *  Returns NULL on failure.
 	 **/
 	virtual DataStream* Clone() const noexcept;
+	bool NeedEndianSwap() const noexcept;
 protected:
 	strpos_t Pos = 0;
 	strpos_t size = 0;
@@ -188,8 +192,6 @@ protected:
 	bool IsDataBigEndian = false;
 	
 private:
-	bool NeedEndianSwap() const noexcept;
-
 	bool IsCPUBigEndian = false;
 };
 
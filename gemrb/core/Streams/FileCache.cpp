@@ -27,6 +27,10 @@
 #endif
 #include "System/VFS.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
 namespace GemRB {
 
 DataStream* CacheCompressedStream(DataStream *stream, const std::string& filename, int length, bool overwrite)
@@ -41,17 +45,16 @@ DataStream* CacheCompressedStream(DataStream *stream, const std::string& filenam
 	char path[_MAX_PATH];
 	PathJoin(path, core->config.CachePath, fname, nullptr);
 
-	if (overwrite || !file_exists(path)) {
-		FileStream out;
-		if (!out.Create(path)) {
-			Log(ERROR, "FileCache", "Cannot write {}.", path);
-			return NULL;
-		}
-
+	bool inflated = false;
+	bool ok = FileCache::Get().Ensure(path, [&](DataStream& out) {
+		inflated = true;
 		PluginHolder<Compressor> comp = MakePluginHolder<Compressor>(PLUGIN_COMPRESSION_ZLIB);
-		if (comp->Decompress(&out, stream, length) != GEM_OK)
-			return NULL;
-	} else {
+		return comp->Decompress(&out, stream, length) == GEM_OK;
+	}, overwrite);
+	if (!ok) {
+		return NULL;
+	}
+	if (!inflated) {
 		stream->Seek(length, GEM_CURRENT_POS);
 	}
 #if defined(SUPPORTS_MEMSTREAM)
@@ -61,4 +64,148 @@ DataStream* CacheCompressedStream(DataStream *stream, const std::string& filenam
 #endif
 }
 
+struct CacheManifest {
+	char signature[8];
+	uint64_t size;
+	int64_t mtime;
+	uint64_t checksum;
+};
+
+static const char manifestSignature[8] = { 'G', 'E', 'M', 'C', 'A', 'C', 'H', 'E' };
+
+static std::string ManifestPath(const char* path)
+{
+	return std::string(path) + ".chk";
+}
+
+static bool StatFile(const char* path, uint64_t& size, int64_t& mtime)
+{
+	struct stat buf;
+	if (stat(path, &buf) < 0) {
+		return false;
+	}
+	size = buf.st_size;
+	mtime = buf.st_mtime;
+	return true;
+}
+
+// FNV-1a over whole words, the cache never leaves this machine, so the
+// endianness does not matter
+static bool ChecksumFile(const char* path, uint64_t& size, uint64_t& checksum)
+{
+	FileStream* file = FileStream::OpenFile(path);
+	if (!file) {
+		return false;
+	}
+
+	size = file->Size();
+	checksum = 0xcbf29ce484222325ULL;
+	std::vector<uint64_t> buffer(8192);
+	bool ok = true;
+	while (file->Remains()) {
+		strpos_t len = std::min<strpos_t>(file->Remains(), buffer.size() * sizeof(uint64_t));
+		std::fill(buffer.begin(), buffer.begin() + CeilDiv<strpos_t>(len, sizeof(uint64_t)), 0);
+		if (file->Read(buffer.data(), len) != strret_t(len)) {
+			ok = false;
+			break;
+		}
+		for (size_t i = 0; i < CeilDiv<strpos_t>(len, sizeof(uint64_t)); i++) {
+			checksum = (checksum ^ buffer[i]) * 0x100000001b3ULL;
+		}
+	}
+	delete file;
+	return ok;
+}
+
+FileCache& FileCache::Get()
+{
+	static FileCache cache;
+	return cache;
+}
+
+bool FileCache::Ensure(const char* path, const Producer& produce, bool overwrite)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	produced.wait(lock, [&]() { return busy.count(path) == 0; });
+	if (!overwrite && IsValid(path)) {
+		return true;
+	}
+	busy.insert(path);
+	lock.unlock();
+
+	bool ok = Produce(path, produce);
+
+	lock.lock();
+	busy.erase(path);
+	produced.notify_all();
+	return ok;
+}
+
+bool FileCache::Produce(const char* path, const Producer& produce) const
+{
+	std::string manifestPath = ManifestPath(path);
+	std::string tmpPath = std::string(path) + ".tmp";
+	std::remove(manifestPath.c_str());
+
+	FileStream out;
+	if (!out.Create(tmpPath.c_str())) {
+		Log(ERROR, "FileCache", "Cannot write {}.", tmpPath);
+		return false;
+	}
+	if (!produce(out)) {
+		out.Close();
+		std::remove(tmpPath.c_str());
+		return false;
+	}
+	out.Close();
+
+	CacheManifest manifest;
+	std::copy(manifestSignature, manifestSignature + 8, manifest.signature);
+	if (!ChecksumFile(tmpPath.c_str(), manifest.size, manifest.checksum)) {
+		std::remove(tmpPath.c_str());
+		return false;
+	}
+
+	// windows can't rename over an existing file
+	std::remove(path);
+	if (rename(tmpPath.c_str(), path) != 0) {
+		Log(ERROR, "FileCache", "Cannot move {} into place.", tmpPath);
+		return false;
+	}
+	uint64_t size = 0;
+	if (!StatFile(path, size, manifest.mtime) || size != manifest.size) {
+		Log(ERROR, "FileCache", "Cannot check {}.", path);
+		return false;
+	}
+
+	FileStream manifestFile;
+	if (!manifestFile.Create(manifestPath.c_str()) || manifestFile.Write(&manifest, sizeof(manifest)) != sizeof(manifest)) {
+		Log(ERROR, "FileCache", "Cannot write {}.", manifestPath);
+		return false;
+	}
+	return true;
+}
+
+bool FileCache::IsValid(const char* path) const
+{
+	FileStream* manifestFile = FileStream::OpenFile(ManifestPath(path).c_str());
+	if (!manifestFile) {
+		return false;
+	}
+	CacheManifest manifest;
+	bool ok = manifestFile->Read(&manifest, sizeof(manifest)) == sizeof(manifest);
+	delete manifestFile;
+	if (!ok || !std::equal(manifestSignature, manifestSignature + 8, manifest.signature)) {
+		return false;
+	}
+
+	uint64_t size = 0;
+	int64_t mtime = 0;
+	ok = StatFile(path, size, mtime) && size == manifest.size && mtime == manifest.mtime;
+	if (!ok) {
+		Log(WARNING, "FileCache", "Discarding the incomplete cache file {}.", path);
+	}
+	return ok;
+}
+
 }
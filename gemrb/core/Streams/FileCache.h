@@ -21,10 +21,42 @@
 
 #include "Streams/DataStream.h"
 
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+
 namespace GemRB {
 
 GEM_EXPORT DataStream* CacheCompressedStream(DataStream *stream, const std::string& filename, int length = 0, bool overwrite = false);
 
+// Bookkeeping for the files inflated into the CachePath.
+// Files are written under a temporary name and get a small manifest with
+// their size, modification time and checksum once complete, so the leftovers
+// of a crash are not mistaken for a finished cache file. The checksum is only
+// taken once, when the file is produced; later checks just compare the size
+// and time. Several threads may ask for the same file: the first one
+// produces it, while the others wait.
+class GEM_EXPORT FileCache {
+public:
+	using Producer = std::function<bool(DataStream& out)>;
+
+	static FileCache& Get();
+
+	// makes sure path holds a complete cache file, calling produce if not
+	bool Ensure(const char* path, const Producer& produce, bool overwrite = false);
+	// checks the manifest against the file's size and modification time
+	bool IsValid(const char* path) const;
+
+private:
+	std::mutex mutex;
+	std::condition_variable produced;
+	std::set<std::string> busy;
+
+	bool Produce(const char* path, const Producer& produce) const;
+};
+
 }
 
 #endif
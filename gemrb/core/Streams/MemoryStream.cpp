@@ -62,6 +62,18 @@ strret_t MemoryStream::Read(void* dest, strpos_t length)
 	return length;
 }
 
+const void* MemoryStream::ViewBytes(strpos_t length)
+{
+	// encrypted data needs the copy to decrypt
+	if (!data || Encrypted || Pos + length > size) {
+		return nullptr;
+	}
+
+	const void* view = data + Pos;
+	Pos += length;
+	return view;
+}
+
 strret_t MemoryStream::Write(const void* src, strpos_t length)
 {
 	if (Pos+length>size ) {
@@ -0,0 +1,273 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+/**
+ * @file RecordLayout.h
+ * Decoding of fixed layout file records straight from memory.
+ * @author The GemRB Project
+ */
+
+#ifndef RECORDLAYOUT_H
+#define RECORDLAYOUT_H
+
+#include "Streams/DataStream.h"
+
+#include "ie_types.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace GemRB {
+
+/**
+ * @class RecordCursor
+ * Walks over bytes that are known to hold a whole record, so the single
+ * fields need no bounds checks of their own.
+ */
+
+class RecordCursor {
+	const uint8_t* pos;
+	bool swap;
+
+public:
+	RecordCursor(const void* data, bool swap) noexcept
+		: pos(static_cast<const uint8_t*>(data)), swap(swap) {}
+
+	template <typename T>
+	T Take() noexcept
+	{
+		T value;
+		memcpy(&value, pos, sizeof(T));
+		pos += sizeof(T);
+		if (swap) {
+			swabs(&value, sizeof(T));
+		}
+		return value;
+	}
+
+	template <typename STR>
+	void TakeString(STR& dest, size_t len) noexcept
+	{
+		memcpy(dest.begin(), pos, len);
+		pos += len;
+		dest.RTrim();
+	}
+
+	void Skip(size_t len) noexcept { pos += len; }
+};
+
+/**
+ * @class RecordBytes
+ * The LEN bytes of the next record of a stream, straight from memory if the
+ * stream has them there and copied otherwise.
+ */
+
+template <size_t LEN>
+class RecordBytes {
+	uint8_t buffer[LEN];
+	const void* bytes = nullptr;
+	bool swap;
+
+public:
+	explicit RecordBytes(DataStream* stream)
+		: swap(stream->NeedEndianSwap())
+	{
+		bytes = stream->ViewBytes(LEN);
+		if (!bytes && stream->Read(buffer, LEN) == strret_t(LEN)) {
+			bytes = buffer;
+		}
+	}
+	RecordBytes(const RecordBytes&) = delete;
+	RecordBytes& operator=(const RecordBytes&) = delete;
+
+	/** False if the stream ended first */
+	explicit operator bool() const { return bytes != nullptr; }
+	RecordCursor Cursor() const { return RecordCursor(bytes, swap); }
+};
+
+// how a Member is stored on disk, as a Raw scalar by default
+template <typename Raw, typename Member>
+struct FieldCodec {
+	static constexpr size_t Size = sizeof(Raw);
+	static void Decode(RecordCursor& cursor, Member& member) noexcept
+	{
+		member = static_cast<Member>(cursor.Take<Raw>());
+	}
+};
+
+// resrefs and variable names, space padded
+template <size_t LEN, int(*CMP)(const char*, const char*, size_t)>
+struct FieldCodec<FixedSizeString<LEN, CMP>, FixedSizeString<LEN, CMP>> {
+	static constexpr size_t Size = LEN;
+	static void Decode(RecordCursor& cursor, FixedSizeString<LEN, CMP>& member) noexcept
+	{
+		cursor.TakeString(member, LEN);
+	}
+};
+
+// points are two words, like in DataStream::ReadPoint
+template <>
+struct FieldCodec<Point, Point> {
+	static constexpr size_t Size = 4;
+	static void Decode(RecordCursor& cursor, Point& member) noexcept
+	{
+		member.x = cursor.Take<ieWord>();
+		member.y = cursor.Take<ieWord>();
+	}
+};
+
+// fixed arrays, like the charges of an item
+template <typename Raw, typename Member, size_t N>
+struct FieldCodec<Raw[N], Member[N]> {
+	static constexpr size_t Size = N * FieldCodec<Raw, Member>::Size;
+	static void Decode(RecordCursor& cursor, Member (&member)[N]) noexcept
+	{
+		for (Member& element : member) {
+			FieldCodec<Raw, Member>::Decode(cursor, element);
+		}
+	}
+};
+
+template <typename Raw, typename Struct, typename Member, Member Struct::*Ptr>
+struct RecordField {
+	static constexpr size_t Size = FieldCodec<Raw, Member>::Size;
+	static void Decode(RecordCursor& cursor, Struct& record) noexcept
+	{
+		FieldCodec<Raw, Member>::Decode(cursor, record.*Ptr);
+	}
+};
+
+// a field stored the way it is declared
+#define RECORD_FIELD(Struct, member) \
+	RecordField<decltype(Struct::member), Struct, decltype(Struct::member), &Struct::member>
+// a field stored as a different scalar, like a byte read into a word
+#define RECORD_FIELD_AS(Raw, Struct, member) \
+	RecordField<Raw, Struct, decltype(Struct::member), &Struct::member>
+
+// unused, reserved or otherwise ignored bytes
+template <size_t LEN>
+struct SkipBytes {
+	static constexpr size_t Size = LEN;
+	template <typename Struct>
+	static void Decode(RecordCursor& cursor, Struct&) noexcept
+	{
+		cursor.Skip(LEN);
+	}
+};
+
+template <typename... Fields>
+struct RecordSize;
+
+template <>
+struct RecordSize<> {
+	static constexpr size_t value = 0;
+};
+
+template <typename Field, typename... Fields>
+struct RecordSize<Field, Fields...> {
+	static constexpr size_t value = Field::Size + RecordSize<Fields...>::value;
+};
+
+/**
+ * @class RecordLayout
+ * Lists the fields of a record in file order, so they can be decoded in one
+ * go once the record is in memory:
+ *
+ *   using EntranceLayout = RecordLayout<Entrance,
+ *       RECORD_FIELD(Entrance, Name), RECORD_FIELD(Entrance, Pos),
+ *       RECORD_FIELD_AS(ieWord, Entrance, Face), SkipBytes<66>>;
+ *
+ * Whatever needs fixing up after reading still has to be done by the caller.
+ */
+
+template <typename Struct, typename... Fields>
+struct RecordLayout {
+	using Record = Struct;
+	static constexpr size_t Size = RecordSize<Fields...>::value;
+
+	static void Decode(RecordCursor& cursor, Struct& record) noexcept
+	{
+		// braced lists are evaluated in order
+		int order[] = { 0, (Fields::Decode(cursor, record), 0)... };
+		(void) order;
+	}
+
+	/** Reads a record, returns false if the stream ends first */
+	static bool Read(DataStream* stream, Struct& record)
+	{
+		RecordBytes<Size> bytes(stream);
+		if (!bytes) {
+			return false;
+		}
+		RecordCursor cursor = bytes.Cursor();
+		Decode(cursor, record);
+		return true;
+	}
+
+	/** Reads a table of records at once, returns how many of them were there */
+	static size_t ReadTable(DataStream* stream, Struct* records, size_t count)
+	{
+		count = std::min(count, stream->Remains() / Size);
+		if (!count) return 0;
+
+		std::vector<uint8_t> buffer;
+		const void* bytes = stream->ViewBytes(count * Size);
+		if (!bytes) {
+			buffer.resize(count * Size);
+			if (stream->Read(buffer.data(), buffer.size()) != strret_t(buffer.size())) {
+				return 0;
+			}
+			bytes = buffer.data();
+		}
+		RecordCursor cursor(bytes, stream->NeedEndianSwap());
+		for (size_t i = 0; i < count; i++) {
+			Decode(cursor, records[i]);
+		}
+		return count;
+	}
+};
+
+/** Reads a table of plain scalars at once, like the index lists of the CRE inventory */
+template <typename T>
+size_t ReadScalarTable(DataStream* stream, T* values, size_t count)
+{
+	count = std::min(count, stream->Remains() / sizeof(T));
+	if (!count) return 0;
+
+	std::vector<uint8_t> buffer;
+	const void* bytes = stream->ViewBytes(count * sizeof(T));
+	if (!bytes) {
+		buffer.resize(count * sizeof(T));
+		if (stream->Read(buffer.data(), buffer.size()) != strret_t(buffer.size())) {
+			return 0;
+		}
+		bytes = buffer.data();
+	}
+	RecordCursor cursor(bytes, stream->NeedEndianSwap());
+	for (size_t i = 0; i < count; i++) {
+		values[i] = cursor.Take<T>();
+	}
+	return count;
+}
+
+}
+
+#endif
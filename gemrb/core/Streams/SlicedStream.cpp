@@ -69,6 +69,20 @@ strret_t SlicedStream::Read(void* dest, strpos_t length)
 	return c;
 }
 
+const void* SlicedStream::ViewBytes(strpos_t length)
+{
+	if (Encrypted || Pos + length > size) {
+		return nullptr;
+	}
+
+	// the parent is kept at our position
+	const void* view = str->ViewBytes(length);
+	if (view) {
+		Pos += length;
+	}
+	return view;
+}
+
 strret_t SlicedStream::Write(const void* /*src*/, strpos_t /*length*/)
 {
 	error("SlicedStream", "Attempted to use unimplemented SlicedStream::Write method!");
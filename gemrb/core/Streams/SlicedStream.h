@@ -39,6 +39,7 @@ public:
 	DataStream* Clone() const noexcept override;
 
 	strret_t Read(void* dest, strpos_t length) override;
+	const void* ViewBytes(strpos_t length) override;
 	strret_t Write(const void* src, strpos_t length) override;
 	stroff_t Seek(stroff_t pos, strpos_t startpos) override;
 };
@@ -27,19 +27,21 @@
 #include "Animation.h"
 
 #include <array>
+#include <vector>
 
 namespace GemRB {
 
+class TileSetMgr;
+
+// tiles only remember which tileset frames they show; the sprites are
+// decoded when the tile is first drawn and can be dropped again while
+// it's off screen, see TileOverlay
 class GEM_EXPORT Tile {
 public:
 	using Map = std::array<Color, 16>;
 	
-	Tile(Animation a1, Animation a2) noexcept
-	: anim{GemRB::make_unique<Animation>(std::move(a1)), GemRB::make_unique<Animation>(std::move(a2))}
-	{}
-
-	explicit Tile(Animation animation) noexcept
-	: anim{GemRB::make_unique<Animation>(std::move(animation)), nullptr }
+	Tile(std::vector<ieWord> frames, std::vector<ieWord> secondary, unsigned char fps) noexcept
+	: frames{std::move(frames), std::move(secondary)}, fps(fps)
 	{}
 	
 	Tile(const Tile&) noexcept = delete;
@@ -48,6 +50,7 @@ public:
 	Tile(Tile&&) noexcept = default;
 	Tile& operator=(Tile&&) noexcept = default;
 	
+	// both are null until the tile is loaded
 	Animation* GetAnimation() const noexcept {
 		if (anim[tileIndex]) {
 			return anim[tileIndex].get();
@@ -59,8 +62,16 @@ public:
 		return anim[idx].get();
 	}
 
+	bool IsLoaded() const noexcept { return anim[0] != nullptr; }
+	// decodes the frames, returns the amount of pixel data now held
+	size_t Load(TileSetMgr& tileset);
+	// drops the frames, keeping the animation position; returns the amount freed
+	size_t Unload() noexcept;
+
 	unsigned char tileIndex = 0;
 	unsigned char om = 0;
+	// the frame the tile was last drawn in, used for eviction
+	unsigned int lastDrawn = 0;
 	
 	Map SearchMap;
 	Map HeightMap;
@@ -69,6 +80,9 @@ public:
 	
 private:
 	std::unique_ptr<Animation> anim[2];
+	std::vector<ieWord> frames[2];
+	Animation::index_t frameIdx[2] {};
+	unsigned char fps;
 };
 
 }
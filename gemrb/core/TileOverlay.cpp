@@ -21,22 +21,193 @@
 #include "TileOverlay.h"
 
 #include "Game.h" // for GetGlobalTint
+#include "GameData.h"
 #include "GlobalTimer.h"
 #include "Interface.h"
+#include "Plugins/TileSetMgr.h"
+
+#include <algorithm>
 
 namespace GemRB {
 
-TileOverlay::TileOverlay(Size size) noexcept
-: size(size)
-{}
+TileOverlay::CacheStats TileOverlay::cacheStats;
+unsigned int TileOverlay::frame = 0;
+std::vector<TileOverlay*> TileOverlay::allOverlays;
+
+size_t Tile::Load(TileSetMgr& tileset)
+{
+	size_t bytes = 0;
+	for (int i = 0; i < 2; ++i) {
+		if (frames[i].empty()) continue;
+
+		std::vector<Animation::frame_t> sprites;
+		sprites.reserve(frames[i].size());
+		for (ieWord index : frames[i]) {
+			sprites.push_back(tileset.GetTile(index));
+		}
+		bytes += sprites.size() * 64 * 64;
+
+		anim[i] = make_unique<Animation>(std::move(sprites));
+		anim[i]->fps = fps;
+		//pause key stops animation
+		anim[i]->gameAnimation = true;
+		//the turning crystal in ar3202 (bg1) requires animations to be synced
+		anim[i]->frameIdx = frameIdx[i];
+	}
+	return bytes;
+}
+
+size_t Tile::Unload() noexcept
+{
+	size_t bytes = 0;
+	for (int i = 0; i < 2; ++i) {
+		if (!anim[i]) continue;
+
+		frameIdx[i] = anim[i]->frameIdx;
+		bytes += anim[i]->GetFrameCount() * 64 * 64;
+		anim[i] = nullptr;
+	}
+	return bytes;
+}
+
+TileOverlay::TileOverlay(Size size, std::shared_ptr<TileSetMgr> tileset, const ResRef& tisRef) noexcept
+: size(size), tileset(std::move(tileset)), tisRef(tisRef)
+{
+	streamBytes = this->tileset->GetStreamMemory();
+	cacheStats.streamBytes += streamBytes;
+	allOverlays.push_back(this);
+}
+
+TileOverlay::~TileOverlay()
+{
+	cacheStats.residentBytes -= residentBytes;
+	cacheStats.residentTiles -= resident.size();
+	cacheStats.streamBytes -= streamBytes;
+	cacheStats.palettes -= palettes;
+	allOverlays.erase(std::find(allOverlays.begin(), allOverlays.end(), this));
+}
 
 void TileOverlay::AddTile(Tile&& tile)
 {
 	tiles.push_back(std::move(tile));
 }
 
-void TileOverlay::Draw(const Region& viewport, std::vector<TileOverlayPtr> &overlays, BlitFlags flags) const
+void TileOverlay::OpenTileset()
+{
+	DataStream* stream = gamedata->GetResource(tisRef, IE_TIS_CLASS_ID);
+	if (!stream || !tileset->Open(stream)) {
+		Log(ERROR, "TileOverlay", "Cannot reopen tileset {}!", tisRef);
+	}
+	tilesetOpen = true;
+	streamBytes = tileset->GetStreamMemory();
+	cacheStats.streamBytes += streamBytes;
+}
+
+void TileOverlay::CloseTileset()
+{
+	tileset->Close();
+	tilesetOpen = false;
+	cacheStats.streamBytes -= streamBytes;
+	streamBytes = 0;
+}
+
+// decodes the tile if needed and marks it as in use
+const Tile& TileOverlay::DrawableTile(size_t idx)
 {
+	Tile& tile = tiles[idx];
+	tile.lastDrawn = frame;
+	lastDrawn = frame;
+	if (tile.IsLoaded()) {
+		return tile;
+	}
+
+	if (!tilesetOpen) {
+		OpenTileset();
+	}
+	size_t bytes = tile.Load(*tileset);
+	residentBytes += bytes;
+	resident.push_back(idx);
+	cacheStats.residentBytes += bytes;
+	cacheStats.residentTiles++;
+	cacheStats.loads++;
+
+	size_t paletteCount = tileset->GetPaletteCount();
+	cacheStats.palettes += paletteCount - palettes;
+	palettes = paletteCount;
+
+	// nothing left to read, so don't keep the whole file around
+	if (resident.size() == tiles.size()) {
+		CloseTileset();
+	}
+	return tile;
+}
+
+// drops the tileset streams held in memory and then the tiles that have been
+// off screen the longest, until there's some room again, so we don't have to
+// do this every frame
+void TileOverlay::Evict()
+{
+	size_t budget = cacheStats.budget;
+	if (!budget || cacheStats.residentBytes + cacheStats.streamBytes <= budget) {
+		return;
+	}
+
+	struct Candidate {
+		unsigned int lastDrawn;
+		TileOverlay* overlay;
+		size_t idx; // the stream if it's past the tiles
+	};
+	std::vector<Candidate> candidates;
+	for (TileOverlay* overlay : allOverlays) {
+		for (size_t idx : overlay->resident) {
+			unsigned int drawn = overlay->tiles[idx].lastDrawn;
+			if (drawn != frame) {
+				candidates.push_back({ drawn, overlay, idx });
+			}
+		}
+		// even the one on screen: a prefetched tileset is a copy of the whole
+		// file, which would otherwise push out all the other tiles every frame
+		if (overlay->streamBytes) {
+			candidates.push_back({ overlay->lastDrawn, overlay, overlay->tiles.size() });
+		}
+	}
+	// streams go first, they are reopened from the game data on the next miss,
+	// while dropped tiles would have to be decoded again
+	std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+		bool aStream = a.idx == a.overlay->tiles.size();
+		bool bStream = b.idx == b.overlay->tiles.size();
+		if (aStream != bStream) return aStream;
+		return a.lastDrawn < b.lastDrawn;
+	});
+
+	size_t target = budget / 4 * 3;
+	for (const Candidate& candidate : candidates) {
+		if (cacheStats.residentBytes + cacheStats.streamBytes <= target) break;
+
+		TileOverlay* overlay = candidate.overlay;
+		if (candidate.idx == overlay->tiles.size()) {
+			overlay->CloseTileset();
+			continue;
+		}
+		size_t bytes = overlay->tiles[candidate.idx].Unload();
+		overlay->residentBytes -= bytes;
+		cacheStats.residentBytes -= bytes;
+		cacheStats.residentTiles--;
+		cacheStats.evictions++;
+	}
+
+	for (TileOverlay* overlay : allOverlays) {
+		auto& resident = overlay->resident;
+		resident.erase(std::remove_if(resident.begin(), resident.end(), [overlay](size_t idx) {
+			return !overlay->tiles[idx].IsLoaded();
+		}), resident.end());
+	}
+}
+
+void TileOverlay::Draw(const Region& viewport, std::vector<TileOverlayPtr> &overlays, BlitFlags flags)
+{
+	frame++;
+
 	// determine which tiles are visible
 	int sx = std::max(viewport.x / 64, 0);
 	int sy = std::max(viewport.y / 64, 0);
@@ -54,7 +225,7 @@ void TileOverlay::Draw(const Region& viewport, std::vector<TileOverlayPtr> &over
 	Video* vid = core->GetVideoDriver();
 	for (int y = sy; y < dy && y < size.h; y++) {
 		for (int x = sx; x < dx && x < size.w; x++) {
-			const Tile &tile = tiles[(y * size.w) + x];
+			const Tile &tile = DrawableTile((y * size.w) + x);
 
 			//draw door tiles if there are any
 			Animation* anim = tile.GetAnimation();
@@ -72,7 +243,7 @@ void TileOverlay::Draw(const Region& viewport, std::vector<TileOverlayPtr> &over
 			for (size_t z = 1; z < overlays.size(); ++z) {
 				const auto& ov = overlays[z];
 				if (ov && !ov->tiles.empty()) {
-					const Tile &ovtile = ov->tiles[0]; //allow only 1x1 tiles now
+					const Tile &ovtile = ov->DrawableTile(0); //allow only 1x1 tiles now
 					if (tile.om & mask) {
 						//draw overlay tiles, they should be half transparent except for BG1
 						BlitFlags transFlag = (core->HasFeature(GF_LAYERED_WATER_TILES)) ? BlitFlags::HALFTRANS : BlitFlags::NONE;
@@ -97,6 +268,8 @@ void TileOverlay::Draw(const Region& viewport, std::vector<TileOverlayPtr> &over
 			}
 		}
 	}
+
+	Evict();
 }
 
 }
@@ -24,29 +24,65 @@
 #include "exports.h"
 
 #include "Holder.h"
+#include "ie_types.h"
 #include "Tile.h"
 #include "Video/Video.h"
 
+#include <memory>
 #include <vector>
 
 namespace GemRB {
 
+class TileSetMgr;
+
 class GEM_EXPORT TileOverlay : public Held<TileOverlay> {
 public:
+	struct CacheStats {
+		size_t residentBytes = 0; // decoded tile pixels
+		size_t residentTiles = 0;
+		size_t streamBytes = 0; // tilesets read from memory, counted against the budget too
+		size_t palettes = 0; // distinct tile palettes
+		size_t budget = 0; // 0 means tiles are never evicted
+		size_t loads = 0;
+		size_t evictions = 0;
+	};
+
 	Size size;
 	std::vector<Tile> tiles;
 public:
 	using TileOverlayPtr = Holder<TileOverlay>;
 
-	explicit TileOverlay(Size size) noexcept;
+	TileOverlay(Size size, std::shared_ptr<TileSetMgr> tileset, const ResRef& tisRef) noexcept;
 	TileOverlay(const TileOverlay&) noexcept = delete;
 	TileOverlay& operator=(const TileOverlay&) noexcept = delete;
-	
-	TileOverlay(TileOverlay&&) noexcept = default;
-	TileOverlay& operator=(TileOverlay&&) noexcept = default;
+	~TileOverlay() override;
 
 	void AddTile(Tile&& tile);
-	void Draw(const Region& viewport, std::vector<TileOverlayPtr> &overlays, BlitFlags flags) const;
+	void Draw(const Region& viewport, std::vector<TileOverlayPtr> &overlays, BlitFlags flags);
+
+	static const CacheStats& GetCacheStats() { return cacheStats; }
+	// the memory cap for decoded tiles and tilesets of all overlays, in bytes
+	static void SetCacheBudget(size_t budget) { cacheStats.budget = budget; }
+
+private:
+	std::shared_ptr<TileSetMgr> tileset;
+	// the tileset stream is closed once all tiles are decoded, this reopens it
+	ResRef tisRef;
+	bool tilesetOpen = true;
+	std::vector<size_t> resident; // loaded tiles
+	size_t residentBytes = 0;
+	size_t streamBytes = 0;
+	size_t palettes = 0;
+	unsigned int lastDrawn = 0;
+
+	static CacheStats cacheStats;
+	static unsigned int frame;
+	static std::vector<TileOverlay*> allOverlays;
+
+	const Tile& DrawableTile(size_t idx);
+	void OpenTileset();
+	void CloseTileset();
+	static void Evict();
 };
 
 }
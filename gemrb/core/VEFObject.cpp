@@ -202,6 +202,7 @@ void VEFObject::Load2DA(const ResRef &resource)
 	SingleObject = false;
 	ResName = resource;
 	ieDword GameTime = core->GetGame()->GameTime;
+	loadTime = GameTime;
 	int rows = tab->GetRowCount();
 	while(rows--) {
 		Point offset;
@@ -260,6 +261,7 @@ void VEFObject::LoadVEF(DataStream *stream)
 		return;
 	}
 	SingleObject = false;
+	loadTime = core->GetGame()->GameTime;
 	stream->ReadDword(offset1);
 	stream->ReadDword(count1);
 	stream->ReadDword(offset2);
@@ -276,6 +278,25 @@ void VEFObject::LoadVEF(DataStream *stream)
 	}
 }
 
+VEFObject* VEFObject::Clone() const
+{
+	VEFObject* obj = new VEFObject();
+	obj->ResName = ResName;
+	obj->Pos = Pos;
+	obj->SingleObject = SingleObject;
+	// the cells get created on first use, so only the schedule is copied
+	obj->loadTime = core->GetGame()->GameTime;
+	ieDword shift = obj->loadTime - loadTime;
+	obj->entries.reserve(entries.size());
+	for (ScheduleEntry entry : entries) {
+		entry.start += shift;
+		if (entry.length != 0xffffffff) entry.length += shift;
+		entry.ptr = nullptr;
+		obj->entries.push_back(entry);
+	}
+	return obj;
+}
+
 ScriptedAnimation *VEFObject::GetSingleObject() const
 {
 	ScriptedAnimation *sca = NULL;
@@ -63,6 +63,8 @@ private:
 	std::vector<ScheduleEntry> entries;
 	std::vector<ScheduleEntry> drawQueue;
 	bool SingleObject = false;
+	// the game time the schedule is relative to
+	ieDword loadTime = 0;
 public:
 	//adds a new entry (use when loading)
 	void AddEntry(const ResRef &res, ieDword st, ieDword len, Point pos, VEFTypes type, ieDword gtime);
@@ -72,6 +74,8 @@ public:
 	void Load2DA(const ResRef &resource);
 	void LoadVEF(DataStream *stream);
 	ScriptedAnimation *GetSingleObject() const;
+	/** Returns a new copy of a loaded schedule, starting now */
+	VEFObject* Clone() const;
 private:
 	//clears the schedule, used internally
 	void Init();
@@ -23,6 +23,7 @@
 
 #include "Region.h"
 #include "Palette.h"
+#include "SpanBlitters.h"
 
 #define ERROR_UNKNOWN_BPP error("Video", "Invalid bpp.")
 
@@ -177,6 +178,15 @@ struct OneMinusSrcA : RGBBlender {
 			dst.a = mask ? (255 - mask) + (c.a * mask) : c.a; // FIXME: not sure this is 100% correct, but it passes my known tests
 		}
 	}
+
+	// the span blitters only handle the unmasked variants
+	bool GetSpanPipeline(SpanPipeline& pipeline) const {
+		pipeline = SpanPipeline();
+		pipeline.op = SpanPipeline::Op::BLEND;
+		pipeline.blendAlpha = SRCALPHA;
+		pipeline.skipTransparent = false;
+		return !MASKED;
+	}
 };
 
 template <bool MASKED>
@@ -187,6 +197,13 @@ struct TintDst : RGBBlender {
 			dst.a = mask ? (255 - mask) + (c.a * mask) : c.a; // FIXME: not sure this is 100% correct, but it passes my known tests
 		}
 	}
+
+	bool GetSpanPipeline(SpanPipeline& pipeline) const {
+		pipeline = SpanPipeline();
+		pipeline.op = SpanPipeline::Op::MULTIPLY;
+		pipeline.skipTransparent = false;
+		return !MASKED;
+	}
 };
 
 template <bool MASKED>
@@ -197,6 +214,13 @@ struct SrcRGBA : RGBBlender {
 			dst.a = mask ? (255 - mask) + (c.a * mask) : c.a; // FIXME: not sure this is 100% correct, but it passes my known tests
 		}
 	}
+
+	bool GetSpanPipeline(SpanPipeline& pipeline) const {
+		pipeline = SpanPipeline();
+		pipeline.op = SpanPipeline::Op::COPY;
+		pipeline.skipTransparent = false;
+		return !MASKED;
+	}
 };
 
 enum class SHADER {
@@ -276,6 +300,42 @@ public:
 
 		blender(c, dst);
 	}
+
+	// describes this pipeline for the span blitters, false if they can't do it
+	// mask is always 0 for them, since they don't support masked blits
+	bool GetSpanPipeline(SpanPipeline& pipeline) const {
+		pipeline = SpanPipeline();
+		switch (SHADE) {
+			case SHADER::TINT:
+				pipeline.shade = SpanPipeline::Shade::TINT;
+				break;
+			case SHADER::GREYSCALE:
+				pipeline.shade = SpanPipeline::Shade::GREYSCALE;
+				break;
+			case SHADER::SEPIA:
+				pipeline.shade = SpanPipeline::Shade::SEPIA;
+				break;
+			default:
+				break;
+		}
+		pipeline.tint = tint;
+		pipeline.shift = uint8_t(shift);
+		pipeline.skipTransparent = SRCALPHA;
+
+		if (blender == ShaderBlend<true>) {
+			pipeline.op = SpanPipeline::Op::BLEND;
+		} else if (blender == ShaderBlend<false>) {
+			pipeline.op = SpanPipeline::Op::BLEND;
+			pipeline.blendAlpha = false;
+		} else if (blender == ShaderAdditive) {
+			pipeline.op = SpanPipeline::Op::ADD;
+		} else if (blender == ShaderTint) {
+			pipeline.op = SpanPipeline::Op::MULTIPLY;
+		} else {
+			return false;
+		}
+		return true;
+	}
 };
 
 struct GEM_EXPORT IPixelIterator
@@ -0,0 +1,548 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#include "SpanBlitters.h"
+#include "SpanKernels.h"
+
+#include "Pixels.h"
+#include "Logging/Logging.h"
+#include "System/CPU.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SPAN_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define SPAN_NEON
+#include <arm_neon.h>
+#endif
+
+namespace GemRB {
+
+#ifdef HAVE_AVX2_SPANS
+// SpanBlittersAVX2.cpp
+size_t BlendSpanAVX2(const uint32_t* src, uint32_t* dst, size_t count, const SpanPipeline& pipeline, uint32_t outMask);
+#endif
+
+namespace {
+
+#ifdef SPAN_SSE2
+struct SSE2Traits {
+	using V = __m128i;
+	using P = __m128i;
+	static constexpr size_t PIXELS = 4;
+
+	static P Load(const uint32_t* px) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(px)); }
+	static void Store(uint32_t* px, P p) { _mm_storeu_si128(reinterpret_cast<__m128i*>(px), p); }
+	static V Lo(P p) { return _mm_unpacklo_epi8(p, _mm_setzero_si128()); }
+	static V Hi(P p) { return _mm_unpackhi_epi8(p, _mm_setzero_si128()); }
+	static P Pack(V lo, V hi) { return _mm_packus_epi16(lo, hi); }
+	static P Splat(uint32_t mask) { return _mm_set1_epi32(int(mask)); }
+	static P AndP(P a, P b) { return _mm_and_si128(a, b); }
+
+	static V Set4(uint16_t l0, uint16_t l1, uint16_t l2, uint16_t l3)
+	{
+		return _mm_set_epi16(short(l3), short(l2), short(l1), short(l0), short(l3), short(l2), short(l1), short(l0));
+	}
+	static V Add(V a, V b) { return _mm_add_epi16(a, b); }
+	static V Sub(V a, V b) { return _mm_sub_epi16(a, b); }
+	static V SubSat(V a, V b) { return _mm_subs_epu16(a, b); }
+	static V Mul(V a, V b) { return _mm_mullo_epi16(a, b); }
+	static V And(V a, V b) { return _mm_and_si128(a, b); }
+	static V AndNot(V mask, V a) { return _mm_andnot_si128(mask, a); }
+	static V Or(V a, V b) { return _mm_or_si128(a, b); }
+	static V ShiftRight(V a, int n) { return _mm_srl_epi16(a, _mm_cvtsi32_si128(n)); }
+	static V IsZero(V a) { return _mm_cmpeq_epi16(a, _mm_setzero_si128()); }
+
+	template <int LANE>
+	static V Broadcast(V a)
+	{
+		return _mm_shufflehi_epi16(_mm_shufflelo_epi16(a, _MM_SHUFFLE(LANE, LANE, LANE, LANE)), _MM_SHUFFLE(LANE, LANE, LANE, LANE));
+	}
+
+	// lane i of each pixel gets lane (i + N) % 4
+	template <int N>
+	static V Rotate(V a)
+	{
+		return _mm_shufflehi_epi16(_mm_shufflelo_epi16(a, _MM_SHUFFLE((N + 3) % 4, (N + 2) % 4, (N + 1) % 4, N)), _MM_SHUFFLE((N + 3) % 4, (N + 2) % 4, (N + 1) % 4, N));
+	}
+};
+#endif
+
+#ifdef SPAN_NEON
+struct NEONTraits {
+	using V = uint16x8_t;
+	using P = uint8x16_t;
+	static constexpr size_t PIXELS = 4;
+
+	static P Load(const uint32_t* px) { return vreinterpretq_u8_u32(vld1q_u32(px)); }
+	static void Store(uint32_t* px, P p) { vst1q_u32(px, vreinterpretq_u32_u8(p)); }
+	static V Lo(P p) { return vmovl_u8(vget_low_u8(p)); }
+	static V Hi(P p) { return vmovl_u8(vget_high_u8(p)); }
+	static P Pack(V lo, V hi) { return vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)); }
+	static P Splat(uint32_t mask) { return vreinterpretq_u8_u32(vdupq_n_u32(mask)); }
+	static P AndP(P a, P b) { return vandq_u8(a, b); }
+
+	static V Set4(uint16_t l0, uint16_t l1, uint16_t l2, uint16_t l3)
+	{
+		const uint16_t lanes[8] = { l0, l1, l2, l3, l0, l1, l2, l3 };
+		return vld1q_u16(lanes);
+	}
+	static V Add(V a, V b) { return vaddq_u16(a, b); }
+	static V Sub(V a, V b) { return vsubq_u16(a, b); }
+	static V SubSat(V a, V b) { return vqsubq_u16(a, b); }
+	static V Mul(V a, V b) { return vmulq_u16(a, b); }
+	static V And(V a, V b) { return vandq_u16(a, b); }
+	static V AndNot(V mask, V a) { return vbicq_u16(a, mask); }
+	static V Or(V a, V b) { return vorrq_u16(a, b); }
+	static V ShiftRight(V a, int n) { return vshlq_u16(a, vdupq_n_s16(int16_t(-n))); }
+	static V IsZero(V a) { return vceqq_u16(a, vdupq_n_u16(0)); }
+
+	// picks 16 bit lane (lane + N) % 4 of each pixel, or just lane for BROADCAST
+	template <int N, bool BROADCAST>
+	static V Shuffle(V a)
+	{
+		uint8_t idx[16];
+		for (int i = 0; i < 8; ++i) {
+			int lane = BROADCAST ? N : (i % 4 + N) % 4;
+			int byte = (i / 4) * 8 + lane * 2;
+			idx[2 * i] = uint8_t(byte);
+			idx[2 * i + 1] = uint8_t(byte + 1);
+		}
+		return vreinterpretq_u16_u8(vqtbl1q_u8(vreinterpretq_u8_u16(a), vld1q_u8(idx)));
+	}
+
+	template <int LANE>
+	static V Broadcast(V a) { return Shuffle<LANE, true>(a); }
+
+	template <int N>
+	static V Rotate(V a) { return Shuffle<N, false>(a); }
+};
+#endif
+
+using SpanKernelFn = size_t (*)(const uint32_t*, uint32_t*, size_t, const SpanPipeline&, uint32_t);
+
+#ifdef SPAN_SSE2
+size_t BlendSpanSSE2(const uint32_t* src, uint32_t* dst, size_t count, const SpanPipeline& pipeline, uint32_t outMask)
+{
+	return RunSpanKernel<SSE2Traits>(src, dst, count, pipeline, outMask);
+}
+#endif
+
+#ifdef SPAN_NEON
+size_t BlendSpanNEON(const uint32_t* src, uint32_t* dst, size_t count, const SpanPipeline& pipeline, uint32_t outMask)
+{
+	return RunSpanKernel<NEONTraits>(src, dst, count, pipeline, outMask);
+}
+#endif
+
+SpanKernelFn KernelForISA(SpanISA isa)
+{
+	switch (isa) {
+#ifdef HAVE_AVX2_SPANS
+		case SpanISA::AVX2:
+			return CPUHasAVX2() ? BlendSpanAVX2 : nullptr;
+#endif
+#ifdef SPAN_SSE2
+		case SpanISA::SSE2:
+			return BlendSpanSSE2;
+#endif
+#ifdef SPAN_NEON
+		case SpanISA::NEON:
+			return BlendSpanNEON;
+#endif
+		default:
+			return nullptr;
+	}
+}
+
+SpanISA BestSpanISA()
+{
+	for (SpanISA isa : { SpanISA::AVX2, SpanISA::SSE2, SpanISA::NEON }) {
+		if (KernelForISA(isa)) return isa;
+	}
+	return SpanISA::SCALAR;
+}
+
+SpanISA currentISA = BestSpanISA();
+SpanKernelFn currentKernel = KernelForISA(currentISA);
+
+// the dest bytes that are written; a format without alpha gets 0 in the unused one
+uint32_t OutputMask(const SpanLayout& layout)
+{
+	uint8_t bytes[4] = { 0xff, 0xff, 0xff, 0xff };
+	if (!layout.hasAlpha) {
+		bytes[layout.a] = 0;
+	}
+	uint32_t mask;
+	memcpy(&mask, bytes, 4);
+	return mask;
+}
+
+inline uint8_t DIV255(unsigned int x)
+{
+	return uint8_t((x + 1 + (x >> 8)) >> 8);
+}
+
+// the scalar version of SpanKernel, for the tails and as a fallback
+void BlendPixel(const uint8_t* s, uint8_t* d, const SpanPipeline& pipeline)
+{
+	const SpanLayout& l = pipeline.layout;
+	if (pipeline.skipTransparent && s[l.a] == 0) {
+		return;
+	}
+
+	uint8_t r = s[l.r];
+	uint8_t g = s[l.g];
+	uint8_t b = s[l.b];
+	uint8_t a = s[l.a];
+	if (pipeline.shade != SpanPipeline::Shade::NONE) {
+		r = (pipeline.tint.r * r) >> pipeline.shift;
+		g = (pipeline.tint.g * g) >> pipeline.shift;
+		b = (pipeline.tint.b * b) >> pipeline.shift;
+	}
+	if (pipeline.shade == SpanPipeline::Shade::GREYSCALE) {
+		r = g = b = uint8_t(r + g + b);
+	} else if (pipeline.shade == SpanPipeline::Shade::SEPIA) {
+		uint8_t avg = r + g + b;
+		r = avg + 21;
+		g = avg;
+		b = avg < 32 ? 0 : avg - 32;
+	}
+
+	switch (pipeline.op) {
+		case SpanPipeline::Op::BLEND:
+			d[l.r] = DIV255(a * r) + DIV255((255 - a) * d[l.r]);
+			d[l.g] = DIV255(a * g) + DIV255((255 - a) * d[l.g]);
+			d[l.b] = DIV255(a * b) + DIV255((255 - a) * d[l.b]);
+			if (pipeline.blendAlpha) {
+				d[l.a] = a + DIV255((255 - a) * d[l.a]);
+			}
+			break;
+		case SpanPipeline::Op::ADD:
+			d[l.r] += r;
+			d[l.g] += g;
+			d[l.b] += b;
+			break;
+		case SpanPipeline::Op::MULTIPLY:
+			d[l.r] = (r * d[l.r]) >> 8;
+			d[l.g] = (g * d[l.g]) >> 8;
+			d[l.b] = (b * d[l.b]) >> 8;
+			break;
+		default:
+			d[l.r] = r;
+			d[l.g] = g;
+			d[l.b] = b;
+			d[l.a] = a;
+			break;
+	}
+}
+
+void BlendSpanScalar(const uint32_t* src, uint32_t* dst, size_t count, const SpanPipeline& pipeline, uint32_t outMask)
+{
+	for (size_t i = 0; i < count; ++i) {
+		uint8_t s[4];
+		uint8_t d[4];
+		memcpy(s, src + i, 4);
+		memcpy(d, dst + i, 4);
+		BlendPixel(s, d, pipeline);
+		uint32_t px;
+		memcpy(&px, d, 4);
+		dst[i] = px & outMask;
+	}
+}
+
+Color UnpackPixel(uint32_t px, const SpanLayout& layout)
+{
+	uint8_t bytes[4];
+	memcpy(bytes, &px, 4);
+	return Color(bytes[layout.r], bytes[layout.g], bytes[layout.b], layout.hasAlpha ? bytes[layout.a] : 0xff);
+}
+
+}
+
+bool SpanLayoutForFormat(const PixelFormat& format, SpanLayout& layout)
+{
+	if (format.Bpp != 4 || format.RLE || format.Rloss || format.Gloss || format.Bloss) {
+		return false;
+	}
+
+	// shifts are in register terms, the layout is in memory order
+	uint32_t probe = 1;
+	bool littleEndian = *reinterpret_cast<const uint8_t*>(&probe) == 1;
+	auto byteIndex = [littleEndian](uint32_t mask, uint8_t shift, uint8_t& index) {
+		if (shift % 8 || shift > 24 || mask != uint32_t(0xff) << shift) return false;
+		index = littleEndian ? shift / 8 : 3 - shift / 8;
+		return true;
+	};
+
+	SpanLayout l;
+	if (!byteIndex(format.Rmask, format.Rshift, l.r) || !byteIndex(format.Gmask, format.Gshift, l.g) || !byteIndex(format.Bmask, format.Bshift, l.b)) {
+		return false;
+	}
+	if (l.r == l.g || l.r == l.b || l.g == l.b) return false;
+
+	l.hasAlpha = format.Amask != 0;
+	if (l.hasAlpha) {
+		if (format.Aloss || !byteIndex(format.Amask, format.Ashift, l.a)) return false;
+	} else {
+		// the unused byte
+		l.a = uint8_t(6 - l.r - l.g - l.b);
+	}
+	if (l.a == l.r || l.a == l.g || l.a == l.b) return false;
+
+	layout = l;
+	return true;
+}
+
+uint32_t SpanPixel(const Color& c, const SpanLayout& layout)
+{
+	uint8_t bytes[4];
+	bytes[layout.r] = c.r;
+	bytes[layout.g] = c.g;
+	bytes[layout.b] = c.b;
+	bytes[layout.a] = c.a;
+	uint32_t px;
+	memcpy(&px, bytes, 4);
+	return px;
+}
+
+void BlendSpan(const uint32_t* src, uint32_t* dst, size_t count, const SpanPipeline& pipeline)
+{
+	uint32_t outMask = OutputMask(pipeline.layout);
+	size_t done = currentKernel ? currentKernel(src, dst, count, pipeline, outMask) : 0;
+	BlendSpanScalar(src + done, dst + done, count - done, pipeline, outMask);
+}
+
+void ConvertSpan(const uint32_t* src, int step, const SpanLayout& srcLayout, uint32_t* dst, size_t count, const SpanLayout& dstLayout, bool srcColorKey, uint32_t colorKey)
+{
+	bool keyed = srcColorKey && !srcLayout.hasAlpha;
+	for (size_t i = 0; i < count; ++i, src += step) {
+		Color c = UnpackPixel(*src, srcLayout);
+		if (keyed && *src == colorKey) {
+			c.a = 0;
+		}
+		dst[i] = SpanPixel(c, dstLayout);
+	}
+}
+
+void ExpandPaletteSpan(const uint8_t* src, int step, const Color* palette, uint32_t* dst, size_t count, const SpanLayout& dstLayout, bool hasColorKey, uint8_t colorKey)
+{
+	// a row is usually much longer than the palette
+	uint32_t expanded[256];
+	for (int i = 0; i < 256; ++i) {
+		expanded[i] = SpanPixel(palette[i], dstLayout);
+	}
+	if (hasColorKey) {
+		Color key = palette[colorKey];
+		key.a = 0;
+		expanded[colorKey] = SpanPixel(key, dstLayout);
+	}
+
+	for (size_t i = 0; i < count; ++i, src += step) {
+		dst[i] = expanded[*src];
+	}
+}
+
+SpanISA GetSpanISA()
+{
+	return currentISA;
+}
+
+bool SetSpanISA(SpanISA isa)
+{
+	SpanKernelFn kernel = KernelForISA(isa);
+	if (!kernel && isa != SpanISA::SCALAR) {
+		return false;
+	}
+	currentISA = isa;
+	currentKernel = kernel;
+	return true;
+}
+
+const char* SpanISAName(SpanISA isa)
+{
+	switch (isa) {
+		case SpanISA::SSE2:
+			return "SSE2";
+		case SpanISA::AVX2:
+			return "AVX2";
+		case SpanISA::NEON:
+			return "NEON";
+		default:
+			return "scalar";
+	}
+}
+
+namespace {
+
+using BenchClock = std::chrono::steady_clock;
+
+struct BenchBuffers {
+	std::vector<uint32_t> src;
+	std::vector<uint32_t> dst;
+	std::vector<uint32_t> expected;
+	std::vector<uint32_t> result;
+	std::vector<uint32_t> row;
+};
+
+double ElapsedMs(BenchClock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(BenchClock::now() - start).count();
+}
+
+// runs the original per pixel blender, the way SDLPixelIterator used to
+template <class BLENDER>
+void BlendReference(const BLENDER& blender, const SpanLayout& layout, const std::vector<uint32_t>& src, std::vector<uint32_t>& dst)
+{
+	uint32_t outMask = OutputMask(layout);
+	for (size_t i = 0; i < dst.size(); ++i) {
+		Color s = UnpackPixel(src[i], layout);
+		Color d = UnpackPixel(dst[i], layout);
+		blender(s, d, 0);
+		dst[i] = SpanPixel(d, layout) & outMask;
+	}
+}
+
+template <class BLENDER>
+bool CheckBlender(const char* name, const BLENDER& blender, const std::vector<SpanLayout>& layouts, unsigned int rounds, BenchBuffers& buf)
+{
+	SpanPipeline pipeline;
+	if (!blender.GetSpanPipeline(pipeline)) {
+		Log(ERROR, "SpanBlitters", "{}: no span pipeline for this blender!", name);
+		return false;
+	}
+
+	bool exact = true;
+	size_t count = buf.dst.size();
+	for (const SpanLayout& layout : layouts) {
+		pipeline.layout = layout;
+		buf.expected = buf.dst;
+		BlendReference(blender, layout, buf.src, buf.expected);
+
+		for (SpanISA isa : { SpanISA::SCALAR, SpanISA::SSE2, SpanISA::AVX2, SpanISA::NEON }) {
+			if (!SetSpanISA(isa)) continue;
+
+			buf.result = buf.dst;
+			// sources without alpha go through ConvertSpan, like in the blitters
+			ConvertSpan(buf.src.data(), 1, layout, buf.row.data(), count, layout);
+			BlendSpan(buf.row.data(), buf.result.data(), count, pipeline);
+			for (size_t i = 0; i < count; ++i) {
+				if (buf.result[i] == buf.expected[i]) continue;
+				Log(ERROR, "SpanBlitters", "{} ({}, alpha at {}): pixel {} is {:#x} instead of {:#x}",
+					name, SpanISAName(isa), layout.a, i, buf.result[i], buf.expected[i]);
+				exact = false;
+				break;
+			}
+		}
+	}
+
+	if (!rounds) return exact;
+
+	pipeline.layout = layouts[0];
+	buf.result = buf.dst;
+	BenchClock::time_point start = BenchClock::now();
+	for (unsigned int i = 0; i < rounds; ++i) {
+		BlendReference(blender, pipeline.layout, buf.src, buf.result);
+	}
+	double reference = ElapsedMs(start);
+
+	std::string timings;
+	for (SpanISA isa : { SpanISA::SCALAR, SpanISA::SSE2, SpanISA::AVX2, SpanISA::NEON }) {
+		if (!SetSpanISA(isa)) continue;
+
+		buf.result = buf.dst;
+		start = BenchClock::now();
+		for (unsigned int i = 0; i < rounds; ++i) {
+			BlendSpan(buf.src.data(), buf.result.data(), count, pipeline);
+		}
+		double elapsed = ElapsedMs(start);
+		timings += fmt::format(", {} {:.2f}ms ({:.1f}x)", SpanISAName(isa), elapsed, reference / std::max(elapsed, 0.001));
+	}
+	Log(MESSAGE, "SpanBlitters", "{}: per pixel {:.2f}ms{}", name, reference, timings);
+	return exact;
+}
+
+}
+
+bool BenchmarkSpanBlitters(unsigned int rounds)
+{
+	// odd sized, so every kernel has a tail to finish
+	const size_t count = 64 * 1024 + 7;
+	BenchBuffers buf;
+	buf.src.resize(count);
+	buf.dst.resize(count);
+	buf.row.resize(count);
+
+	std::mt19937 rng(0xdeadbeef);
+	std::uniform_int_distribution<uint32_t> dist;
+	for (size_t i = 0; i < count; ++i) {
+		buf.src[i] = dist(rng);
+		buf.dst[i] = dist(rng);
+		// plenty of the edge cases: fully transparent and fully opaque sources
+		uint8_t* bytes = reinterpret_cast<uint8_t*>(&buf.src[i]);
+		if (i % 5 == 0) bytes[3] = bytes[0] = 0;
+		if (i % 7 == 0) bytes[3] = bytes[0] = 0xff;
+	}
+
+	std::vector<SpanLayout> layouts(4);
+	layouts[1].r = 2;
+	layouts[1].b = 0;
+	layouts[2] = layouts[1];
+	layouts[2].hasAlpha = false;
+	layouts[3].r = 1;
+	layouts[3].g = 2;
+	layouts[3].b = 3;
+	layouts[3].a = 0;
+
+	SpanISA isa = GetSpanISA();
+	Log(MESSAGE, "SpanBlitters", "Checking the span blitters on {} pixels, best kernel: {}", count, SpanISAName(isa));
+
+	const Color tint(200, 120, 60, 0xff);
+	bool exact = true;
+	exact &= CheckBlender("blend", RGBBlendingPipeline<SHADER::NONE, true>(), layouts, rounds, buf);
+	exact &= CheckBlender("blend (no alpha)", RGBBlendingPipeline<SHADER::NONE, false>(ShaderBlend<false>), layouts, rounds, buf);
+	exact &= CheckBlender("tint", RGBBlendingPipeline<SHADER::TINT, true>(tint), layouts, rounds, buf);
+	exact &= CheckBlender("greyscale", RGBBlendingPipeline<SHADER::GREYSCALE, true>(), layouts, rounds, buf);
+	exact &= CheckBlender("greyscale (tinted)", RGBBlendingPipeline<SHADER::GREYSCALE, true>(tint), layouts, rounds, buf);
+	exact &= CheckBlender("sepia", RGBBlendingPipeline<SHADER::SEPIA, true>(), layouts, rounds, buf);
+	exact &= CheckBlender("sepia (tinted)", RGBBlendingPipeline<SHADER::SEPIA, true>(tint), layouts, rounds, buf);
+	exact &= CheckBlender("additive", RGBBlendingPipeline<SHADER::NONE, true>(ShaderAdditive), layouts, rounds, buf);
+	exact &= CheckBlender("additive (tinted)", RGBBlendingPipeline<SHADER::TINT, true>(tint, ShaderAdditive), layouts, rounds, buf);
+	exact &= CheckBlender("multiply", RGBBlendingPipeline<SHADER::NONE, true>(ShaderTint), layouts, rounds, buf);
+	exact &= CheckBlender("fill blend", OneMinusSrcA<false, false>(), layouts, rounds, buf);
+	exact &= CheckBlender("fill multiply", TintDst<false>(), layouts, rounds, buf);
+	exact &= CheckBlender("fill copy", SrcRGBA<false>(), layouts, rounds, buf);
+
+	SetSpanISA(isa);
+	if (exact) {
+		Log(MESSAGE, "SpanBlitters", "All span kernels match the per pixel blenders.");
+	} else {
+		Log(ERROR, "SpanBlitters", "Some span kernels don't match the per pixel blenders!");
+	}
+	return exact;
+}
+
+}
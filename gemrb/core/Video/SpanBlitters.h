@@ -0,0 +1,104 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef SPANBLITTERS_H
+#define SPANBLITTERS_H
+
+#include "exports.h"
+#include "RGBAColor.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace GemRB {
+
+struct PixelFormat;
+
+// where the channels of a 32 bit pixel are in memory (byte index 0-3)
+// 'a' may point to an unused byte, for formats without an alpha channel
+struct SpanLayout {
+	uint8_t r = 0;
+	uint8_t g = 1;
+	uint8_t b = 2;
+	uint8_t a = 3;
+	bool hasAlpha = true;
+
+	bool operator==(const SpanLayout& other) const {
+		return r == other.r && g == other.g && b == other.b && a == other.a && hasAlpha == other.hasAlpha;
+	}
+	bool operator!=(const SpanLayout& other) const { return !(*this == other); }
+};
+
+// The span version of the per pixel blenders in Pixels.h: the "shader" is
+// applied to the source first, then the result is combined with the dest.
+// The kernels reproduce the blenders exactly, including their rounding.
+struct SpanPipeline {
+	enum class Shade : uint8_t {
+		NONE,
+		TINT, // rgb * tint >> shift
+		GREYSCALE, // like TINT, followed by the channel sum
+		SEPIA
+	};
+	enum class Op : uint8_t {
+		BLEND, // ShaderBlend
+		ADD, // ShaderAdditive
+		MULTIPLY, // ShaderTint
+		COPY
+	};
+
+	Shade shade = Shade::NONE;
+	Op op = Op::BLEND;
+	Color tint = Color(1, 1, 1, 0xff);
+	uint8_t shift = 0;
+	bool blendAlpha = true; // ShaderBlend<true> or ShaderBlend<false>
+	bool skipTransparent = true; // leave the dest alone where the source alpha is 0
+	SpanLayout layout;
+};
+
+// false if the format can't be handled by the span blitters (not 32 bit 888)
+GEM_EXPORT bool SpanLayoutForFormat(const PixelFormat& format, SpanLayout& layout);
+// packs a color, including its alpha, so it can be used as a BlendSpan source
+GEM_EXPORT uint32_t SpanPixel(const Color& c, const SpanLayout& layout);
+
+// blends count source pixels onto dest, both in pipeline.layout
+GEM_EXPORT void BlendSpan(const uint32_t* src, uint32_t* dst, size_t count, const SpanPipeline& pipeline);
+// converts a row of pixels to BlendSpan sources; step is -1 for mirrored reading
+GEM_EXPORT void ConvertSpan(const uint32_t* src, int step, const SpanLayout& srcLayout, uint32_t* dst, size_t count, const SpanLayout& dstLayout, bool srcColorKey = false, uint32_t colorKey = 0);
+// expands a row of palette indices, the colorkey becomes fully transparent
+GEM_EXPORT void ExpandPaletteSpan(const uint8_t* src, int step, const Color* palette, uint32_t* dst, size_t count, const SpanLayout& dstLayout, bool hasColorKey, uint8_t colorKey);
+
+// the instruction set used by BlendSpan; can be lowered for comparisons
+enum class SpanISA : uint8_t {
+	SCALAR,
+	SSE2,
+	AVX2,
+	NEON
+};
+GEM_EXPORT SpanISA GetSpanISA();
+GEM_EXPORT bool SetSpanISA(SpanISA isa);
+GEM_EXPORT const char* SpanISAName(SpanISA isa);
+
+// runs every kernel on random pixels and compares it to the per pixel
+// blenders, then times them; returns false on any mismatch
+GEM_EXPORT bool BenchmarkSpanBlitters(unsigned int rounds);
+
+}
+
+#endif
@@ -0,0 +1,86 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+// this file is built with AVX2 enabled, nothing in here may run before
+// SpanBlitters.cpp has checked that the cpu supports it
+
+#include "SpanKernels.h"
+
+#include <immintrin.h>
+
+namespace GemRB {
+
+namespace {
+
+struct AVX2Traits {
+	using V = __m256i;
+	using P = __m256i;
+	static constexpr size_t PIXELS = 8;
+
+	static P Load(const uint32_t* px) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(px)); }
+	static void Store(uint32_t* px, P p) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(px), p); }
+	static V Lo(P p) { return _mm256_unpacklo_epi8(p, _mm256_setzero_si256()); }
+	static V Hi(P p) { return _mm256_unpackhi_epi8(p, _mm256_setzero_si256()); }
+	static P Pack(V lo, V hi) { return _mm256_packus_epi16(lo, hi); }
+	static P Splat(uint32_t mask) { return _mm256_set1_epi32(int(mask)); }
+	static P AndP(P a, P b) { return _mm256_and_si256(a, b); }
+
+	static V Set4(uint16_t l0, uint16_t l1, uint16_t l2, uint16_t l3)
+	{
+		return _mm256_set_epi16(short(l3), short(l2), short(l1), short(l0), short(l3), short(l2), short(l1), short(l0),
+					short(l3), short(l2), short(l1), short(l0), short(l3), short(l2), short(l1), short(l0));
+	}
+	static V Add(V a, V b) { return _mm256_add_epi16(a, b); }
+	static V Sub(V a, V b) { return _mm256_sub_epi16(a, b); }
+	static V SubSat(V a, V b) { return _mm256_subs_epu16(a, b); }
+	static V Mul(V a, V b) { return _mm256_mullo_epi16(a, b); }
+	static V And(V a, V b) { return _mm256_and_si256(a, b); }
+	static V AndNot(V mask, V a) { return _mm256_andnot_si256(mask, a); }
+	static V Or(V a, V b) { return _mm256_or_si256(a, b); }
+	static V ShiftRight(V a, int n) { return _mm256_srl_epi16(a, _mm_cvtsi32_si128(n)); }
+	static V IsZero(V a) { return _mm256_cmpeq_epi16(a, _mm256_setzero_si256()); }
+
+	template <int LANE>
+	static V Broadcast(V a)
+	{
+		return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(a, _MM_SHUFFLE(LANE, LANE, LANE, LANE)), _MM_SHUFFLE(LANE, LANE, LANE, LANE));
+	}
+
+	// lane i of each pixel gets lane (i + N) % 4
+	template <int N>
+	static V Rotate(V a)
+	{
+		return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(a, _MM_SHUFFLE((N + 3) % 4, (N + 2) % 4, (N + 1) % 4, N)), _MM_SHUFFLE((N + 3) % 4, (N + 2) % 4, (N + 1) % 4, N));
+	}
+};
+
+}
+
+size_t BlendSpanAVX2(const uint32_t* src, uint32_t* dst, size_t count, const SpanPipeline& pipeline, uint32_t outMask);
+
+size_t BlendSpanAVX2(const uint32_t* src, uint32_t* dst, size_t count, const SpanPipeline& pipeline, uint32_t outMask)
+{
+	size_t done = RunSpanKernel<AVX2Traits>(src, dst, count, pipeline, outMask);
+	// leave the wide registers clean for any SSE code that follows
+	_mm256_zeroupper();
+	return done;
+}
+
+}
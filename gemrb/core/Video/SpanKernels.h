@@ -0,0 +1,170 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+// Internal to the span blitters: the vector kernel, written once against a
+// small traits class per instruction set. Each channel is widened to a 16 bit
+// lane, so the products of the blenders fit and the rounding stays the same.
+// Every translation unit including this gets its own copy (anonymous
+// namespace), since they are built with different instruction set flags.
+
+#ifndef SPANKERNELS_H
+#define SPANKERNELS_H
+
+#include "SpanBlitters.h"
+
+namespace GemRB {
+
+namespace {
+
+// T has to provide:
+// V - 16 bit lanes, 4 per pixel; P - packed 8 bit pixels, T::PIXELS of them
+// Load/Store/Lo/Hi/Pack for moving between the two, Set4 for per channel
+// constants and the usual lane arithmetic
+template <class T, int AI>
+struct SpanKernel {
+	using V = typename T::V;
+	using P = typename T::P;
+
+	const SpanPipeline& pipeline;
+	V rgbLanes, alphaLanes, c255, one, tint, sepiaAdd, sepiaSub;
+
+	V Lanes(uint16_t r, uint16_t g, uint16_t b, uint16_t a) const
+	{
+		uint16_t lane[4];
+		lane[pipeline.layout.r] = r;
+		lane[pipeline.layout.g] = g;
+		lane[pipeline.layout.b] = b;
+		lane[pipeline.layout.a] = a;
+		return T::Set4(lane[0], lane[1], lane[2], lane[3]);
+	}
+
+	explicit SpanKernel(const SpanPipeline& p)
+	: pipeline(p)
+	{
+		rgbLanes = Lanes(0xffff, 0xffff, 0xffff, 0);
+		alphaLanes = Lanes(0, 0, 0, 0xffff);
+		c255 = Lanes(255, 255, 255, 255);
+		one = Lanes(1, 1, 1, 1);
+		tint = Lanes(p.tint.r, p.tint.g, p.tint.b, 0);
+		sepiaAdd = Lanes(21, 0, 0, 0);
+		sepiaSub = Lanes(0, 0, 32, 0);
+	}
+
+	static V Select(V mask, V a, V b)
+	{
+		return T::Or(T::And(mask, a), T::AndNot(mask, b));
+	}
+
+	V Div255(V x) const
+	{
+		return T::ShiftRight(T::Add(T::Add(x, one), T::ShiftRight(x, 8)), 8);
+	}
+
+	V Shade(V s) const
+	{
+		switch (pipeline.shade) {
+			case SpanPipeline::Shade::TINT:
+				return Select(rgbLanes, T::ShiftRight(T::Mul(s, tint), pipeline.shift), s);
+			case SpanPipeline::Shade::GREYSCALE:
+			case SpanPipeline::Shade::SEPIA:
+				{
+					// the alpha lane of tint is 0, so it doesn't add to the sum
+					V t = T::ShiftRight(T::Mul(s, tint), pipeline.shift);
+					V avg = T::Add(T::Add(t, T::template Rotate<1>(t)), T::Add(T::template Rotate<2>(t), T::template Rotate<3>(t)));
+					avg = T::And(avg, c255);
+					if (pipeline.shade == SpanPipeline::Shade::SEPIA) {
+						avg = T::SubSat(T::Add(avg, sepiaAdd), sepiaSub);
+					}
+					return Select(rgbLanes, avg, s);
+				}
+			default:
+				return s;
+		}
+	}
+
+	V Pixels(V s, V d) const
+	{
+		V c = Shade(s);
+		V r;
+		switch (pipeline.op) {
+			case SpanPipeline::Op::BLEND:
+				{
+					V a = T::template Broadcast<AI>(c);
+					V src = Select(alphaLanes, c, Div255(T::Mul(a, c)));
+					V dst = Div255(T::Mul(T::Sub(c255, a), d));
+					r = T::And(T::Add(src, dst), c255);
+					if (!pipeline.blendAlpha) {
+						r = Select(alphaLanes, d, r);
+					}
+				}
+				break;
+			case SpanPipeline::Op::ADD:
+				r = Select(rgbLanes, T::And(T::Add(c, d), c255), d);
+				break;
+			case SpanPipeline::Op::MULTIPLY:
+				r = Select(rgbLanes, T::ShiftRight(T::Mul(c, d), 8), d);
+				break;
+			default:
+				r = c;
+				break;
+		}
+
+		if (pipeline.skipTransparent) {
+			r = Select(T::IsZero(T::template Broadcast<AI>(s)), d, r);
+		}
+		return r;
+	}
+
+	// returns how many pixels were done, the tail is left for the caller
+	size_t Run(const uint32_t* src, uint32_t* dst, size_t count, uint32_t outMask) const
+	{
+		P mask = T::Splat(outMask);
+		size_t i = 0;
+		for (; i + T::PIXELS <= count; i += T::PIXELS) {
+			P s = T::Load(src + i);
+			P d = T::Load(dst + i);
+			V lo = Pixels(T::Lo(s), T::Lo(d));
+			V hi = Pixels(T::Hi(s), T::Hi(d));
+			T::Store(dst + i, T::AndP(T::Pack(lo, hi), mask));
+		}
+		return i;
+	}
+};
+
+template <class T>
+size_t RunSpanKernel(const uint32_t* src, uint32_t* dst, size_t count, const SpanPipeline& pipeline, uint32_t outMask)
+{
+	switch (pipeline.layout.a) {
+		case 0:
+			return SpanKernel<T, 0>(pipeline).Run(src, dst, count, outMask);
+		case 1:
+			return SpanKernel<T, 1>(pipeline).Run(src, dst, count, outMask);
+		case 2:
+			return SpanKernel<T, 2>(pipeline).Run(src, dst, count, outMask);
+		default:
+			return SpanKernel<T, 3>(pipeline).Run(src, dst, count, outMask);
+	}
+}
+
+}
+
+}
+
+#endif
@@ -388,4 +388,10 @@ void Video::DrawLines(const std::vector<Point>& points, const Color& color, Blit
 	DrawLinesImp(points, c, flags);
 }
 
+void Video::DrawLineSegments(const std::vector<Point>& points, const Color& color, BlitFlags flags)
+{
+	Color c = ApplyFlagsForColor(color, flags);
+	DrawLineSegmentsImp(points, c, flags);
+}
+
 }
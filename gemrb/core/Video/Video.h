@@ -130,6 +130,7 @@ private:
 	virtual void DrawPolygonImp(const Gem_Polygon* poly, const Point& origin, const Color& color, bool fill, BlitFlags flags) = 0;
 	virtual void DrawLineImp(const Point& p1, const Point& p2, const Color& color, BlitFlags flags) = 0;
 	virtual void DrawLinesImp(const std::vector<Point>& points, const Color& color, BlitFlags flags)=0;
+	virtual void DrawLineSegmentsImp(const std::vector<Point>& points, const Color& color, BlitFlags flags)=0;
 
 public:
 	Video() noexcept;
@@ -199,6 +200,9 @@ public:
 	/** Draws a line segment */
 	void DrawLine(const Point& p1, const Point& p2, const Color& color, BlitFlags flags = BlitFlags::NONE);
 	void DrawLines(const std::vector<Point>& points, const Color& color, BlitFlags flags = BlitFlags::NONE);
+	/** Draws unconnected line segments, every two points are one of them.
+	 *  Meant for lots of short lines, like raindrops, that are drawn as one batch */
+	void DrawLineSegments(const std::vector<Point>& points, const Color& color, BlitFlags flags = BlitFlags::NONE);
 	/** Sets Event Manager */
 	void SetEventMgr(EventMgr* evnt);
 
@@ -26,12 +26,20 @@
 #include "Plugin.h"
 #include "Plugins/export.h"
 
+#include <atomic>
+
 namespace GemRB {
 
+class Compressor;
+
 class GEM_PLUGIN_EXPORT IndexedArchive : public Plugin {
 public:
 	virtual int OpenArchive(const char* filename) = 0;
 	virtual DataStream* GetStream(unsigned long Resource, unsigned long Type) = 0;
+	/** Inflates a compressed archive into cachePath without opening it.
+	 * Meant for a background thread, so it mustn't use the plugin manager;
+	 * gives up and leaves no cache file behind once stop is set. */
+	virtual int InflateToCache(const char* path, const char* cachePath, const Compressor& comp, const std::atomic<bool>& stop) = 0;
 };
 
 }
@@ -22,6 +22,7 @@
 #define TILESETMGR_H
 
 #include "Plugin.h"
+#include "Sprite2D.h"
 #include "Tile.h"
 #include "Streams/DataStream.h"
 
@@ -32,8 +33,14 @@ namespace GemRB {
 class GEM_PLUGIN_EXPORT TileSetMgr : public Plugin {
 public:
 	virtual bool Open(DataStream* stream) = 0;
-	virtual Tile* GetTile(const std::vector<ieWord>& indexes,
-		unsigned short* secondary = NULL) = 0;
+	/** decodes a single 64x64 tile, reading it from the stream */
+	virtual Holder<Sprite2D> GetTile(int index) = 0;
+	/** the number of distinct palettes decoded so far, they're shared between tiles */
+	virtual size_t GetPaletteCount() const = 0;
+	/** how much memory the stream holds, 0 if it reads from a file or is closed */
+	virtual size_t GetStreamMemory() const = 0;
+	/** drops the stream, tiles can only be decoded again after the next Open */
+	virtual void Close() = 0;
 };
 
 }
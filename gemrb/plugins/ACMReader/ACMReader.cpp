@@ -20,6 +20,8 @@
 
 #include "general.h"
 
+#include <algorithm>
+
 using namespace GemRB;
 
 bool ACMReader::Import(DataStream* str)
@@ -99,11 +101,15 @@ int ACMReader::read_samples(short* buffer, int count)
 			if (!make_new_samples())
 				break;
 		}
-		*buffer = ( short ) ( ( *values ) >> levels );
-		values++;
-		buffer++;
-		res += 1;
-		samples_ready--;
+		// a whole block at a time, so the compiler can vectorize it
+		int chunk = std::min(count - res, samples_ready);
+		for (int i = 0; i < chunk; i++) {
+			buffer[i] = ( short ) ( values[i] >> levels );
+		}
+		values += chunk;
+		buffer += chunk;
+		res += chunk;
+		samples_ready -= chunk;
 	}
 	return res;
 }
@@ -113,4 +119,5 @@ int ACMReader::read_samples(short* buffer, int count)
 GEMRB_PLUGIN(0x10373EE, "ACM File Importer")
 PLUGIN_IE_RESOURCE(ACMReader, "acm", (ieWord)IE_ACM_CLASS_ID)
 PLUGIN_IE_RESOURCE(ACMReader, "wav", (ieWord)IE_WAV_CLASS_ID)
+PLUGIN_INITIALIZER(CSubbandDecoder::SelectKernels)
 END_PLUGIN()
@@ -70,6 +70,12 @@ public:
 
 	bool Import(DataStream* stream) override;
 	int read_samples(short* buffer, int count) override;
+	void UseReferenceDecoder() override
+	{
+		if (decoder) {
+			decoder->UseScalarKernels();
+		}
+	}
 };
 
 }
@@ -0,0 +1,53 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+// this file is built with AVX2 enabled, nothing in here may run before
+// CSubbandDecoder::SelectKernels has checked that the cpu supports it
+
+#include "SubbandKernels.h"
+
+#ifdef __AVX2__
+
+#include <immintrin.h>
+
+namespace {
+
+struct AVX2Traits {
+	using V = __m256i;
+	static constexpr int WIDTH = 8;
+
+	static V Load(const int* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+	static void Store(int* p, V v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+	static V Add(V a, V b) { return _mm256_add_epi32(a, b); }
+	static V Sub(V a, V b) { return _mm256_sub_epi32(a, b); }
+	static V Twice(V a) { return _mm256_slli_epi32(a, 1); }
+};
+
+}
+
+extern const SubbandKernels AVX2SubbandKernels;
+
+const SubbandKernels AVX2SubbandKernels = {
+	[](short* memory, int* buffer, int sb_size, int blocks) { return SubbandColumns<AVX2Traits>(memory, buffer, sb_size, blocks, true); },
+	[](int* memory, int* buffer, int sb_size, int blocks) { return SubbandColumns<AVX2Traits>(memory, buffer, sb_size, blocks, false); },
+	"AVX2"
+};
+
+#endif
@@ -0,0 +1,102 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef _ACM_LAB_SUBBAND_KERNELS_H
+#define _ACM_LAB_SUBBAND_KERNELS_H
+
+// The subband filters run down every column of the block independently,
+// with two values of state per column, so the vector versions filter
+// WIDTH neighbouring columns at once. They return how many columns they
+// did, the scalar filters finish the rest.
+//
+// TRAITS provides:
+//   V, WIDTH
+//   Load(const int*), Store(int*, V) - unaligned
+//   Add(V, V), Sub(V, V), Twice(V)
+// Everything wraps around like the scalar code does in practice.
+
+template <class TRAITS, typename MEM>
+int SubbandColumns(MEM* memory, int* buffer, int sb_size, int blocks, bool firstLevel)
+{
+	using T = TRAITS;
+	using V = typename T::V;
+
+	alignas(32) int state0[T::WIDTH];
+	alignas(32) int state1[T::WIDTH];
+	int sb_size_2 = sb_size * 2;
+	int column = 0;
+
+	for (; column + T::WIDTH <= sb_size; column += T::WIDTH) {
+		MEM* mem = memory + 2 * column;
+		for (int k = 0; k < T::WIDTH; k++) {
+			state0[k] = mem[2 * k];
+			state1[k] = mem[2 * k + 1];
+		}
+		V db_0 = T::Load(state0);
+		V db_1 = T::Load(state1);
+
+		int* buff_ptr = buffer + column;
+		// the first level may have an odd count of row pairs
+		if (firstLevel && ((blocks >> 1) & 1)) {
+			V row_0 = T::Load(buff_ptr);
+			V row_1 = T::Load(buff_ptr + sb_size);
+			T::Store(buff_ptr, T::Add(T::Add(db_0, T::Twice(db_1)), row_0));
+			T::Store(buff_ptr + sb_size, T::Sub(T::Sub(T::Twice(row_0), db_1), row_1));
+			buff_ptr += sb_size_2;
+			db_0 = row_0;
+			db_1 = row_1;
+		}
+
+		for (int j = 0; j < blocks >> 2; j++) {
+			V row_0 = T::Load(buff_ptr);
+			T::Store(buff_ptr, T::Add(T::Add(db_0, T::Twice(db_1)), row_0));
+			buff_ptr += sb_size;
+			V row_1 = T::Load(buff_ptr);
+			T::Store(buff_ptr, T::Sub(T::Sub(T::Twice(row_0), db_1), row_1));
+			buff_ptr += sb_size;
+			V row_2 = T::Load(buff_ptr);
+			T::Store(buff_ptr, T::Add(T::Add(row_0, T::Twice(row_1)), row_2));
+			buff_ptr += sb_size;
+			V row_3 = T::Load(buff_ptr);
+			T::Store(buff_ptr, T::Sub(T::Sub(T::Twice(row_2), row_1), row_3));
+			buff_ptr += sb_size;
+
+			db_0 = row_2;
+			db_1 = row_3;
+		}
+
+		T::Store(state0, db_0);
+		T::Store(state1, db_1);
+		for (int k = 0; k < T::WIDTH; k++) {
+			mem[2 * k] = MEM(state0[k]);
+			mem[2 * k + 1] = MEM(state1[k]);
+		}
+	}
+	return column;
+}
+
+struct SubbandKernels {
+	// the first level keeps its state in shorts, the others in ints
+	int (*firstLevel)(short* memory, int* buffer, int sb_size, int blocks);
+	int (*nextLevel)(int* memory, int* buffer, int sb_size, int blocks);
+	const char* name;
+};
+
+#endif
@@ -20,8 +20,90 @@
 
 #include "decoder.h"
 
+#include "SubbandKernels.h"
+
+#include "Logging/Logging.h"
+#include "System/CPU.h"
+
 #include <cstdlib>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SUBBAND_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define SUBBAND_NEON
+#include <arm_neon.h>
+#endif
+
+using namespace GemRB;
+
+#ifdef HAVE_AVX2_SUBBANDS
+// SubbandAVX2.cpp
+extern const SubbandKernels AVX2SubbandKernels;
+#endif
+
+namespace {
+
+int NoColumns(short*, int*, int, int)
+{
+	return 0;
+}
+
+int NoColumns(int*, int*, int, int)
+{
+	return 0;
+}
+
+const SubbandKernels ScalarKernels = { NoColumns, NoColumns, "scalar" };
+
+#ifdef SUBBAND_SSE2
+struct SSE2Traits {
+	using V = __m128i;
+	static constexpr int WIDTH = 4;
+
+	static V Load(const int* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+	static void Store(int* p, V v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+	static V Add(V a, V b) { return _mm_add_epi32(a, b); }
+	static V Sub(V a, V b) { return _mm_sub_epi32(a, b); }
+	static V Twice(V a) { return _mm_slli_epi32(a, 1); }
+};
+
+const SubbandKernels SSE2Kernels = {
+	[](short* memory, int* buffer, int sb_size, int blocks) { return SubbandColumns<SSE2Traits>(memory, buffer, sb_size, blocks, true); },
+	[](int* memory, int* buffer, int sb_size, int blocks) { return SubbandColumns<SSE2Traits>(memory, buffer, sb_size, blocks, false); },
+	"SSE2"
+};
+#endif
+
+#ifdef SUBBAND_NEON
+struct NEONTraits {
+	using V = int32x4_t;
+	static constexpr int WIDTH = 4;
+
+	static V Load(const int* p) { return vld1q_s32(p); }
+	static void Store(int* p, V v) { vst1q_s32(p, v); }
+	static V Add(V a, V b) { return vaddq_s32(a, b); }
+	static V Sub(V a, V b) { return vsubq_s32(a, b); }
+	static V Twice(V a) { return vshlq_n_s32(a, 1); }
+};
+
+const SubbandKernels NEONKernels = {
+	[](short* memory, int* buffer, int sb_size, int blocks) { return SubbandColumns<NEONTraits>(memory, buffer, sb_size, blocks, true); },
+	[](int* memory, int* buffer, int sb_size, int blocks) { return SubbandColumns<NEONTraits>(memory, buffer, sb_size, blocks, false); },
+	"NEON"
+};
+#endif
+
+const SubbandKernels* selectedKernels = &ScalarKernels;
+
+}
+
+CSubbandDecoder::CSubbandDecoder(int lev_cnt, const SubbandKernels* kernels)
+	: levels( lev_cnt ), block_size( 1 << lev_cnt ), memory_buffer( NULL ),
+	kernels( kernels ? kernels : selectedKernels )
+{
+}
+
 int CSubbandDecoder::init_decoder()
 {
 	int memory_size = ( levels == 0 ) ? 0 : ( 3 * ( block_size >> 1 ) - 2 );
@@ -42,7 +124,9 @@ void CSubbandDecoder::decode_data(int* buffer, int blocks)
 	int sb_size = block_size >> 1; // current subband size
 
 	blocks <<= 1;
-	sub_4d3fcc( ( short * ) mem_ptr, buff_ptr, sb_size, blocks );
+	short* short_mem = ( short * ) mem_ptr;
+	int done = kernels->firstLevel( short_mem, buff_ptr, sb_size, blocks );
+	sub_4d3fcc( short_mem + 2 * done, buff_ptr + done, sb_size, blocks, sb_size - done );
 	mem_ptr += sb_size;
 
 	for (int i = 0; i < blocks; i++)
@@ -52,19 +136,21 @@ void CSubbandDecoder::decode_data(int* buffer, int blocks)
 	blocks <<= 1;
 
 	while (sb_size != 0) {
-		sub_4d420c( mem_ptr, buff_ptr, sb_size, blocks );
+		done = kernels->nextLevel( mem_ptr, buff_ptr, sb_size, blocks );
+		sub_4d420c( mem_ptr + 2 * done, buff_ptr + done, sb_size, blocks, sb_size - done );
 		mem_ptr += sb_size << 1;
 		sb_size >>= 1;
 		blocks <<= 1;
 	}
 }
+// columns is how many of the sb_size columns to filter, starting at buffer
 void CSubbandDecoder::sub_4d3fcc(short* memory, int* buffer, int sb_size,
-	int blocks) const
+	int blocks, int columns) const
 {
 	int row_0, row_1, row_2 = 0, row_3 = 0, db_0, db_1;
 	int sb_size_2 = sb_size * 2, sb_size_3 = sb_size * 3;
 	if (blocks == 2) {
-		for (int i = 0; i < sb_size; i++) {
+		for (int i = 0; i < columns; i++) {
 			row_0 = buffer[0];
 			row_1 = buffer[sb_size];
 			buffer[0] = buffer[0] + memory[0] + 2 * memory[1];
@@ -76,7 +162,7 @@ void CSubbandDecoder::sub_4d3fcc(short* memory, int* buffer, int sb_size,
 			buffer++;
 		}
 	} else if (blocks == 4) {
-		for (int i = 0; i < sb_size; i++) {
+		for (int i = 0; i < columns; i++) {
 			row_0 = buffer[0];
 			row_1 = buffer[sb_size];
 			row_2 = buffer[sb_size_2];
@@ -94,7 +180,7 @@ void CSubbandDecoder::sub_4d3fcc(short* memory, int* buffer, int sb_size,
 			buffer++;
 		}
 	} else {
-		for (int i = 0; i < sb_size; i++) {
+		for (int i = 0; i < columns; i++) {
 			int* buff_ptr = buffer;
 			if (( blocks >> 1 ) & 1) {
 				row_0 = buff_ptr[0];
@@ -129,12 +215,12 @@ void CSubbandDecoder::sub_4d3fcc(short* memory, int* buffer, int sb_size,
 	}
 }
 void CSubbandDecoder::sub_4d420c(int* memory, int* buffer, int sb_size,
-	int blocks) const
+	int blocks, int columns) const
 {
 	int row_0, row_1, row_2 = 0, row_3 = 0, db_0, db_1;
 	int sb_size_2 = sb_size * 2, sb_size_3 = sb_size * 3;
 	if (blocks == 4) {
-		for (int i = 0; i < sb_size; i++) {
+		for (int i = 0; i < columns; i++) {
 			row_0 = buffer[0];
 			row_1 = buffer[sb_size];
 			row_2 = buffer[sb_size_2];
@@ -152,7 +238,7 @@ void CSubbandDecoder::sub_4d420c(int* memory, int* buffer, int sb_size,
 			buffer++;
 		}
 	} else {
-		for (int i = 0; i < sb_size; i++) {
+		for (int i = 0; i < columns; i++) {
 			int* buff_ptr = buffer;
 			db_0 = memory[0]; db_1 = memory[1];
 			for (int j = 0; j < blocks >> 2; j++) {
@@ -173,3 +259,27 @@ void CSubbandDecoder::sub_4d420c(int* memory, int* buffer, int sb_size,
 		}
 	}
 }
+
+// GemRB.CheckSoundDecoding compares the picked filters against the scalar ones
+void CSubbandDecoder::SelectKernels()
+{
+	const SubbandKernels* kernels = &ScalarKernels;
+#ifdef SUBBAND_SSE2
+	kernels = &SSE2Kernels;
+#endif
+#ifdef SUBBAND_NEON
+	kernels = &NEONKernels;
+#endif
+#ifdef HAVE_AVX2_SUBBANDS
+	if (CPUHasAVX2()) {
+		kernels = &AVX2SubbandKernels;
+	}
+#endif
+	selectedKernels = kernels;
+	Log(DEBUG, "ACMReader", "Using the {} subband filters.", kernels->name);
+}
+
+void CSubbandDecoder::UseScalarKernels()
+{
+	kernels = &ScalarKernels;
+}
@@ -23,17 +23,18 @@
 
 #include <cstdlib>
 
+struct SubbandKernels;
+
 class CSubbandDecoder {
 private:
 	int levels, block_size;
 	int* memory_buffer;
-	void sub_4d3fcc(short* memory, int* buffer, int sb_size, int blocks) const;
-	void sub_4d420c(int* memory, int* buffer, int sb_size, int blocks) const;
+	const SubbandKernels* kernels;
+	void sub_4d3fcc(short* memory, int* buffer, int sb_size, int blocks, int columns) const;
+	void sub_4d420c(int* memory, int* buffer, int sb_size, int blocks, int columns) const;
 public:
-	explicit CSubbandDecoder(int lev_cnt)
-		: levels( lev_cnt ), block_size( 1 << lev_cnt ), memory_buffer( NULL )
-	{
-	}
+	// without kernels, the ones picked by SelectKernels are used
+	explicit CSubbandDecoder(int lev_cnt, const SubbandKernels* kernels = NULL);
 	virtual ~CSubbandDecoder()
 	{
 		if (memory_buffer) {
@@ -43,6 +44,12 @@ public:
 
 	int init_decoder();
 	void decode_data(int* buffer, int blocks);
+
+	// the plain filters, that the vector kernels have to match bit for bit
+	void UseScalarKernels();
+
+	// picks the fastest vector kernels the cpu supports
+	static void SelectKernels();
 };
 
 #endif
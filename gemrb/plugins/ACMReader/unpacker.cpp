@@ -84,6 +84,18 @@ const FillerProc Fillers[32] = {
 
 inline void CValueUnpacker::prepare_bits(int bits)
 {
+	if (bits <= avail_bits) {
+		return;
+	}
+	// usually the buffer has enough left to top the reservoir up at once;
+	// the callers mask out what they don't need, so the extra bits are fine
+	if (buffer_bit_offset + 4 <= UNPACKER_BUFFER_SIZE) {
+		while (avail_bits <= 24) {
+			next_bits |= ( unsigned int ) bits_buffer[buffer_bit_offset++] << avail_bits;
+			avail_bits += 8;
+		}
+		return;
+	}
 	while (bits > avail_bits) {
 		unsigned char one_byte;
 		if (buffer_bit_offset == UNPACKER_BUFFER_SIZE) {
@@ -44,6 +44,7 @@
 #include "Scriptable/Door.h"
 #include "Scriptable/InfoPoint.h"
 #include "Streams/FileStream.h"
+#include "Streams/RecordLayout.h"
 #include "Streams/SlicedStream.h"
 
 #include <cstdlib>
@@ -473,6 +474,98 @@ static Ambient* SetupMainAmbients(Map *map, bool day_or_night) {
 	return ambi;
 }
 
+// the fixed size tables, decoded a whole table at a time
+using VertexLayout = RecordLayout<Point, RECORD_FIELD_AS(ieWord, Point, x), RECORD_FIELD_AS(ieWord, Point, y)>;
+
+static std::vector<Point> ReadVertices(DataStream* str, size_t count)
+{
+	std::vector<Point> points(count);
+	points.resize(VertexLayout::ReadTable(str, points.data(), count));
+	return points;
+}
+
+struct ActorRecord {
+	ieVariable defaultName;
+	Point pos;
+	Point des;
+	ieDword flags;
+	ieWord spawned;
+	ieByte difficultyMargin;
+	ieDword orientation;
+	ieDword removalTime;
+	ieWord maxDistance;
+	ieDword schedule;
+	ieDword talkCount;
+	ResRef dialog;
+	ResRef overrideScript;
+	ResRef generalScript;
+	ResRef classScript;
+	ResRef raceScript;
+	ResRef defaultScript;
+	ResRef specificsScript;
+	ResRef creResRef;
+	ieDword creOffset;
+	ieDword creSize;
+	ResRef areaScript; // another iwd2 script slot
+};
+
+using ActorLayout = RecordLayout<ActorRecord,
+	RECORD_FIELD(ActorRecord, defaultName), RECORD_FIELD(ActorRecord, pos),
+	RECORD_FIELD(ActorRecord, des), RECORD_FIELD(ActorRecord, flags),
+	RECORD_FIELD(ActorRecord, spawned), // "type"
+	SkipBytes<1>, // one letter of a ResRef, changed to * at runtime, purpose unknown (portraits?), but not needed either
+	RECORD_FIELD(ActorRecord, difficultyMargin), // iwd2 only, "alignbyte" in bg2 (padding)
+	SkipBytes<4>, //actor animation, unused
+	RECORD_FIELD(ActorRecord, orientation), // was word + padding in bg2
+	RECORD_FIELD(ActorRecord, removalTime),
+	RECORD_FIELD(ActorRecord, maxDistance), // hunting range
+	SkipBytes<2>, // apparently unused https://gibberlings3.net/forums/topic/21724-a (follow range)
+	RECORD_FIELD(ActorRecord, schedule), RECORD_FIELD(ActorRecord, talkCount),
+	RECORD_FIELD(ActorRecord, dialog), RECORD_FIELD(ActorRecord, overrideScript),
+	RECORD_FIELD(ActorRecord, generalScript), RECORD_FIELD(ActorRecord, classScript),
+	RECORD_FIELD(ActorRecord, raceScript), RECORD_FIELD(ActorRecord, defaultScript),
+	RECORD_FIELD(ActorRecord, specificsScript), RECORD_FIELD(ActorRecord, creResRef),
+	RECORD_FIELD(ActorRecord, creOffset), RECORD_FIELD(ActorRecord, creSize),
+	RECORD_FIELD(ActorRecord, areaScript), SkipBytes<120>>;
+static_assert(ActorLayout::Size == 0x110, "ARE actor entries are 0x110 bytes");
+
+using AnimationLayout = RecordLayout<AreaAnimation,
+	RECORD_FIELD(AreaAnimation, Name), RECORD_FIELD(AreaAnimation, Pos),
+	RECORD_FIELD(AreaAnimation, appearance), RECORD_FIELD(AreaAnimation, BAM),
+	RECORD_FIELD(AreaAnimation, sequence), RECORD_FIELD(AreaAnimation, frame),
+	RECORD_FIELD(AreaAnimation, Flags), RECORD_FIELD(AreaAnimation, height),
+	RECORD_FIELD(AreaAnimation, transparency), RECORD_FIELD(AreaAnimation, startFrameRange),
+	RECORD_FIELD(AreaAnimation, startchance),
+	RECORD_FIELD(AreaAnimation, skipcycle), // how many cycles are skipped (100% skippage), "period" in bg2
+	RECORD_FIELD(AreaAnimation, PaletteRef),
+	// TODO: EE: word with anim width for PVRZ/WBM resources (if flag bits are set, see A_ANI_ defines)
+	// 0x4a holds the height
+	RECORD_FIELD(AreaAnimation, unknown48)>;
+static_assert(AnimationLayout::Size == 0x4c, "ARE animations are 0x4c bytes");
+
+struct EntranceRecord {
+	ieVariable Name;
+	Point Pos;
+	ieWord Face;
+};
+
+using EntranceLayout = RecordLayout<EntranceRecord,
+	RECORD_FIELD(EntranceRecord, Name), RECORD_FIELD(EntranceRecord, Pos),
+	RECORD_FIELD(EntranceRecord, Face), SkipBytes<66>>; // just reserved bytes
+static_assert(EntranceLayout::Size == 0x68, "ARE entrances are 0x68 bytes");
+
+struct VariableRecord {
+	ieVariable Name;
+	ieDword Value;
+};
+
+using VariableLayout = RecordLayout<VariableRecord,
+	RECORD_FIELD(VariableRecord, Name),
+	SkipBytes<8>, // type + resreftype, part of the partly implemented type system (uint, int, float, str)
+	RECORD_FIELD(VariableRecord, Value),
+	SkipBytes<40>>; // values as an int32, float64, string
+static_assert(VariableLayout::Size == 0x54, "ARE variables are 0x54 bytes");
+
 Map* AREImporter::GetMap(const ResRef& resRef, bool day_or_night)
 {
 	// if this area does not have extended night, force it to day mode
@@ -728,10 +821,7 @@ Map* AREImporter::GetMap(const ResRef& resRef, bool day_or_night)
 #endif
 #undef MSG
 		} else {
-			std::vector<Point> points(VertexCount);
-			for (int x = 0; x < VertexCount; x++) {
-				str->ReadPoint(points[x]);
-			}
+			std::vector<Point> points = ReadVertices(str, VertexCount);
 			auto poly = std::make_shared<Gem_Polygon>(std::move(points), &bbox);
 			ip = tm->AddInfoPoint( Name, Type, poly );
 		}
@@ -843,10 +933,7 @@ Map* AREImporter::GetMap(const ResRef& resRef, bool day_or_night)
 			c = map->AddContainer( Name, Type, nullptr );
 			c->BBox = bbox;
 		} else {
-			std::vector<Point> points(vertCount);
-			for (int x = 0; x < vertCount; x++) {
-				str->ReadPoint(points[x]);
-			}
+			std::vector<Point> points = ReadVertices(str, vertCount);
 			auto poly = std::make_shared<Gem_Polygon>(std::move(points), &bbox);
 			c = map->AddContainer( Name, Type, poly );
 		}
@@ -979,13 +1066,7 @@ Map* AREImporter::GetMap(const ResRef& resRef, bool day_or_night)
 		std::shared_ptr<Gem_Polygon> open = nullptr;
 		str->Seek( VerticesOffset + ( OpenFirstVertex * 4 ), GEM_STREAM_START );
 		if (OpenVerticesCount) {
-			std::vector<Point> points(OpenVerticesCount);
-			for (int x = 0; x < OpenVerticesCount; x++) {
-				str->ReadWord(minX);
-				points[x].x = minX;
-				str->ReadWord(minY);
-				points[x].y = minY;
-			}
+			std::vector<Point> points = ReadVertices(str, OpenVerticesCount);
 			open = std::make_shared<Gem_Polygon>(std::move(points), &BBOpen );
 		}
 
@@ -994,13 +1075,7 @@ Map* AREImporter::GetMap(const ResRef& resRef, bool day_or_night)
 		str->Seek( VerticesOffset + ( ClosedFirstVertex * 4 ),
 				GEM_STREAM_START );
 		if (ClosedVerticesCount) {
-			std::vector<Point> points(ClosedVerticesCount);
-			for (int x = 0; x < ClosedVerticesCount; x++) {
-				str->ReadWord(minX);
-				points[x].x = minX;
-				str->ReadWord(minY);
-				points[x].y = minY;
-			}
+			std::vector<Point> points = ReadVertices(str, ClosedVerticesCount);
 			closed = std::make_shared<Gem_Polygon>(std::move(points), &BBClosed);
 		}
 
@@ -1147,66 +1222,33 @@ Map* AREImporter::GetMap(const ResRef& resRef, bool day_or_night)
 	str->Seek( ActorOffset, GEM_STREAM_START );
 	assert(core->IsAvailable(IE_CRE_CLASS_ID));
 	auto actmgr = GetImporter<ActorMgr>(IE_CRE_CLASS_ID);
-	for (int i = 0; i < ActorCount; i++) {
-		ieVariable defaultName;
-		ResRef creResRef;
-		ieDword talkCount;
-		ieDword orientation;
-		ieDword schedule;
-		ieDword removalTime;
-		Point pos;
-		Point des;
-		ieWord maxDistance;
-		ieWord spawned;
-		ResRef dialog;
+	std::vector<ActorRecord> actors(ActorCount);
+	actors.resize(ActorLayout::ReadTable(str, actors.data(), actors.size()));
+	for (const ActorRecord& record : actors) {
 		ResRef scripts[8]; //the original order is shown in scrlev.ids
-		ieDword flags;
-		ieByte difficultyMargin;
-
-		str->ReadVariable(defaultName);
-		str->ReadPoint(pos);
-		str->ReadPoint(des);
-		str->ReadDword(flags);
-		str->ReadWord(spawned); // "type"
-		str->Seek(1, GEM_CURRENT_POS); // one letter of a ResRef, changed to * at runtime, purpose unknown (portraits?), but not needed either
-		str->Read(&difficultyMargin, 1); // iwd2 only, "alignbyte" in bg2 (padding)
-		str->Seek(4, GEM_CURRENT_POS); //actor animation, unused
-		str->ReadDword(orientation); // was word + padding in bg2
-		str->ReadDword(removalTime);
-		str->ReadWord(maxDistance); // hunting range
-		str->Seek(2, GEM_CURRENT_POS); // apparently unused https://gibberlings3.net/forums/topic/21724-a (follow range)
-		str->ReadDword(schedule);
-		str->ReadDword(talkCount);
-		str->ReadResRef(dialog);
-
-		str->ReadResRef(scripts[SCR_OVERRIDE]);
-		str->ReadResRef(scripts[SCR_GENERAL]);
-		str->ReadResRef(scripts[SCR_CLASS]);
-		str->ReadResRef(scripts[SCR_RACE]);
-		str->ReadResRef(scripts[SCR_DEFAULT]);
-		str->ReadResRef(scripts[SCR_SPECIFICS]);
-		str->ReadResRef(creResRef);
-		DataStream* creFile;
-		Actor *act;
-		ieDword CreOffset, CreSize;
-		str->ReadDword(CreOffset);
-		str->ReadDword(CreSize);
-		// another iwd2 script slot
-		str->ReadResRef(scripts[SCR_AREA]);
-		str->Seek(120, GEM_CURRENT_POS);
+		scripts[SCR_OVERRIDE] = record.overrideScript;
+		scripts[SCR_GENERAL] = record.generalScript;
+		scripts[SCR_CLASS] = record.classScript;
+		scripts[SCR_RACE] = record.raceScript;
+		scripts[SCR_DEFAULT] = record.defaultScript;
+		scripts[SCR_SPECIFICS] = record.specificsScript;
 		//not iwd2, this field is garbage
-		if (!core->HasFeature(GF_IWD2_SCRIPTNAME)) {
-			scripts[SCR_AREA].Reset();
+		if (core->HasFeature(GF_IWD2_SCRIPTNAME)) {
+			scripts[SCR_AREA] = record.areaScript;
 		}
+		ieDword flags = record.flags;
+		ieByte difficultyMargin = record.difficultyMargin;
+		DataStream* creFile;
+		Actor *act;
 		//actually, Flags&1 signs that the creature
 		//is not loaded yet, so !(Flags&1) means it is embedded
-		if (CreOffset != 0 && !(flags & 1)) {
-			creFile = SliceStream(str, CreOffset, CreSize, true);
+		if (record.creOffset != 0 && !(flags & 1)) {
+			creFile = SliceStream(str, record.creOffset, record.creSize, true);
 		} else {
-			creFile = gamedata->GetResource(creResRef, IE_CRE_CLASS_ID);
+			creFile = gamedata->GetResource(record.creResRef, IE_CRE_CLASS_ID);
 		}
 		if(!actmgr->Open(creFile)) {
-			Log(ERROR, "AREImporter", "Couldn't read actor: {}!", creResRef);
+			Log(ERROR, "AREImporter", "Couldn't read actor: {}!", record.creResRef);
 			continue;
 		}
 		act = actmgr->GetActor(0);
@@ -1220,16 +1262,16 @@ Map* AREImporter::GetMap(const ResRef& resRef, bool day_or_night)
 			continue;
 		}
 		map->AddActor(act, false);
-		act->Pos = pos;
-		act->Destination = des;
-		act->HomeLocation = des;
-		act->maxWalkDistance = maxDistance;
-		act->Spawned = spawned;
-		act->appearance = schedule;
+		act->SetPos(record.pos);
+		act->Destination = record.des;
+		act->HomeLocation = record.des;
+		act->maxWalkDistance = record.maxDistance;
+		act->Spawned = record.spawned;
+		act->appearance = record.schedule;
 		//copying the scripting name into the actor
 		//if the CreatureAreaFlag was set to 8
 		if ((flags & AF_NAME_OVERRIDE) || core->HasFeature(GF_IWD2_SCRIPTNAME)) {
-			act->SetScriptName(defaultName);
+			act->SetScriptName(record.defaultName);
 		}
 		//IWD2 specific hacks
 		if (core->HasFeature(GF_3ED_RULES)) {
@@ -1255,54 +1297,38 @@ Map* AREImporter::GetMap(const ResRef& resRef, bool day_or_night)
 		}
 		act->DifficultyMargin = difficultyMargin;
 
-		if (!dialog.IsEmpty()) {
-			act->SetDialog(dialog);
+		if (!record.dialog.IsEmpty()) {
+			act->SetDialog(record.dialog);
 		}
 		for (int j=0;j<8;j++) {
 			if (!scripts[j].IsEmpty()) {
 				act->SetScript(scripts[j], j);
 			}
 		}
-		act->SetOrientation(ClampToOrientation(orientation), false);
-		act->TalkCount = talkCount;
-		act->RemovalTime = removalTime;
+		act->SetOrientation(ClampToOrientation(record.orientation), false);
+		act->TalkCount = record.talkCount;
+		act->RemovalTime = record.removalTime;
 		act->RefreshEffects();
 	}
 
 	core->LoadProgress(90);
 	Log(DEBUG, "AREImporter", "Loading animations");
 	str->Seek( AnimOffset, GEM_STREAM_START );
-	for (ieDword i = 0; i < AnimCount; i++) {
-		AreaAnimation anim = AreaAnimation();
-		str->ReadVariable(anim.Name);
-		ieWord startFrameRange;
-		str->ReadPoint(anim.Pos);
-		str->ReadDword(anim.appearance);
-		str->ReadResRef(anim.BAM);
-		str->ReadWord(anim.sequence);
-		str->ReadWord(anim.frame);
-		str->ReadDword(anim.Flags);
+	std::vector<AreaAnimation> animations(AnimCount);
+	animations.resize(AnimationLayout::ReadTable(str, animations.data(), animations.size()));
+	for (AreaAnimation& anim : animations) {
 		anim.originalFlags = anim.Flags;
-		str->ReadScalar(anim.height);
 		if (core->HasFeature(GF_IMPLICIT_AREAANIM_BACKGROUND)) {
 			anim.height = ANI_PRI_BACKGROUND;
 			anim.Flags |= A_ANI_NO_WALL;
 		}
-		str->ReadWord(anim.transparency);
-		str->ReadWord(startFrameRange);
-		str->Read(&anim.startchance, 1);
 		if (anim.startchance <= 0) {
 			anim.startchance = 100; // percentage of starting a cycle
 		}
-		if (startFrameRange && (anim.Flags & A_ANI_RANDOM_START)) {
-			anim.frame = RAND(0, startFrameRange - 1);
+		if (anim.startFrameRange && (anim.Flags & A_ANI_RANDOM_START)) {
+			anim.frame = RAND(0, anim.startFrameRange - 1);
 		}
 		anim.startFrameRange = 0; // this will never get resaved (iirc)
-		str->Read(&anim.skipcycle, 1); // how many cycles are skipped (100% skippage), "period" in bg2
-		str->ReadResRef(anim.PaletteRef);
-		// TODO: EE: word with anim width for PVRZ/WBM resources (if flag bits are set, see A_ANI_ defines)
-		// 0x4a holds the height
-		str->ReadDword(anim.unknown48);
 
 		if (pst) {
 			AdjustPSTFlags(anim);
@@ -1315,28 +1341,19 @@ Map* AREImporter::GetMap(const ResRef& resRef, bool day_or_night)
 
 	Log(DEBUG, "AREImporter", "Loading entrances");
 	str->Seek( EntrancesOffset, GEM_STREAM_START );
-	for (ieDword i = 0; i < EntrancesCount; i++) {
-		ieVariable Name;
-		Point Pos;
-		ieWord Face;
-		str->ReadVariable(Name);
-		str->ReadPoint(Pos);
-		str->ReadWord(Face);
-		str->Seek(66, GEM_CURRENT_POS); // just reserved bytes
-		map->AddEntrance(Name, Pos, Face);
+	std::vector<EntranceRecord> entrances(EntrancesCount);
+	entrances.resize(EntranceLayout::ReadTable(str, entrances.data(), entrances.size()));
+	for (const EntranceRecord& entrance : entrances) {
+		map->AddEntrance(entrance.Name, entrance.Pos, entrance.Face);
 	}
 
 	Log(DEBUG, "AREImporter", "Loading variables");
 	map->locals->LoadInitialValues(resRef);
 	str->Seek( VariablesOffset, GEM_STREAM_START );
-	for (ieDword i = 0; i < VariablesCount; i++) {
-		ieVariable Name;
-		ieDword Value;
-		str->ReadVariable(Name);
-		str->Seek(8, GEM_CURRENT_POS); // type + resreftype, part of the partly implemented type system (uint, int, float, str)
-		str->ReadDword(Value);
-		str->Seek(40, GEM_CURRENT_POS); // values as an int32, float64, string
-		map->locals->SetAt( Name, Value );
+	std::vector<VariableRecord> variables(VariablesCount);
+	variables.resize(VariableLayout::ReadTable(str, variables.data(), variables.size()));
+	for (const VariableRecord& variable : variables) {
+		map->locals->SetAt(variable.Name, variable.Value);
 	}
 
 	Log(DEBUG, "AREImporter", "Loading ambients");
@@ -26,10 +26,15 @@
 #include "Streams/SlicedStream.h"
 #include "Streams/FileCache.h"
 #include "Streams/FileStream.h"
+#include "Streams/MemoryStream.h"
 #if defined(SUPPORTS_MEMSTREAM)
 #include "Streams/MappedFileMemoryStream.h"
 #endif
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 using namespace GemRB;
 
 BIFImporter::~BIFImporter(void)
@@ -43,6 +48,106 @@ BIFImporter::~BIFImporter(void)
 	}
 }
 
+namespace {
+
+// an inflated BIFC block, which hands its memory over to the cache writer
+class InflatedBlock : public MemoryStream {
+public:
+	explicit InflatedBlock(strpos_t size)
+	: MemoryStream("bifc", malloc(size), size) {}
+
+	const char* Data() const { return data; }
+};
+
+struct CompressedBlock {
+	DataStream* source = nullptr;
+	InflatedBlock* inflated = nullptr;
+	bool ok = false;
+};
+
+}
+
+// The blocks of a BIFC are compressed independently, so they can be inflated
+// in parallel. This is done in batches, to keep the memory use bounded.
+// A set stop flag gives up between batches, leaving no cache file behind.
+static bool InflateBlocks(const Compressor& comp, DataStream* compressed, DataStream& out, ieDword unCompBifSize,
+			  const std::atomic<bool>* stop = nullptr)
+{
+	static const size_t BATCH_SIZE = 16 * 1024 * 1024;
+	// deflate can't do better than about 1:1032, so anything beyond is a broken header
+	static const size_t MAX_RATIO = 1032;
+	unsigned int workers = std::max(1U, std::thread::hardware_concurrency());
+
+	size_t finalsize = 0;
+	while (finalsize < unCompBifSize) {
+		if (stop && *stop) {
+			return false;
+		}
+
+		std::vector<CompressedBlock> batch;
+		size_t batchSize = 0;
+		bool ok = true;
+		while (finalsize + batchSize < unCompBifSize && batchSize < BATCH_SIZE) {
+			ieDword complen, declen;
+			if (compressed->ReadDword(declen) != 4 || compressed->ReadDword(complen) != 4) {
+				ok = false;
+				break;
+			}
+			if (complen > compressed->Remains() || declen > unCompBifSize - finalsize - batchSize
+				|| declen > size_t(complen) * MAX_RATIO + 64) {
+				Log(ERROR, "BIFImporter", "Bad block in {}: {} bytes inflating to {}.", compressed->filename, complen, declen);
+				ok = false;
+				break;
+			}
+			void* data = malloc(complen);
+			if (compressed->Read(data, complen) != strret_t(complen)) {
+				free(data);
+				ok = false;
+				break;
+			}
+
+			CompressedBlock block;
+			block.source = new MemoryStream(compressed->filename, data, complen);
+			block.inflated = new InflatedBlock(declen);
+			batch.push_back(block);
+			batchSize += declen;
+			if (!declen) break;
+		}
+
+		std::atomic<size_t> next(0);
+		auto inflate = [&]() {
+			size_t i;
+			while ((i = next++) < batch.size()) {
+				CompressedBlock& block = batch[i];
+				block.ok = comp.Decompress(block.inflated, block.source, block.source->Size()) == GEM_OK;
+			}
+		};
+		std::vector<std::thread> threads;
+		for (unsigned int i = 1; i < std::min<size_t>(workers, batch.size()); i++) {
+			threads.emplace_back(inflate);
+		}
+		inflate();
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		for (const CompressedBlock& block : batch) {
+			ok = ok && block.ok;
+			if (ok) {
+				strpos_t len = block.inflated->GetPos();
+				ok = out.Write(block.inflated->Data(), len) == strret_t(len);
+				finalsize += len;
+			}
+			delete block.source;
+			delete block.inflated;
+		}
+		if (!ok || !batchSize) {
+			return false;
+		}
+	}
+	return true;
+}
+
 DataStream* BIFImporter::DecompressBIFC(DataStream* compressed, const char* path)
 {
 	Log(MESSAGE, "BIFImporter", "Decompressing {} ...", compressed->filename);
@@ -51,29 +156,13 @@ DataStream* BIFImporter::DecompressBIFC(DataStream* compressed, const char* path
 	PluginHolder<Compressor> comp = MakePluginHolder<Compressor>(PLUGIN_COMPRESSION_ZLIB);
 	ieDword unCompBifSize;
 	compressed->ReadDword(unCompBifSize);
-#if !defined(SUPPORTS_MEMSTREAM)
-	fflush(stdout);
-#endif
-	FileStream out;
-	if (!out.Create(path)) {
-		Log(ERROR, "BIFImporter", "Cannot write {}.", path);
+	bool ok = FileCache::Get().Ensure(path, [&](DataStream& out) {
+		return InflateBlocks(*comp, compressed, out, unCompBifSize);
+	});
+	if (!ok) {
+		Log(ERROR, "BIFImporter", "Cannot decompress {}.", compressed->filename);
 		return NULL;
 	}
-	size_t finalsize = 0;
-	int laststep = 0;
-	while (finalsize < unCompBifSize) {
-		ieDword complen, declen;
-		compressed->ReadDword(declen);
-		compressed->ReadDword(complen);
-		if (comp->Decompress( &out, compressed, complen ) != GEM_OK) {
-			return NULL;
-		}
-		finalsize = out.GetPos();
-		if (( int ) ( finalsize * ( 10.0 / unCompBifSize ) ) != laststep) {
-			laststep++;
-		}
-	}
-	out.Close(); // This is necesary, since windows won't open the file otherwise.
 #if defined(SUPPORTS_MEMSTREAM)
 	return new MappedFileMemoryStream{path};
 #else
@@ -81,6 +170,39 @@ DataStream* BIFImporter::DecompressBIFC(DataStream* compressed, const char* path
 #endif
 }
 
+// the cache warm-up runs on its own thread, so it gets handed the compressor
+// instead of asking the plugin manager for one
+int BIFImporter::InflateToCache(const char* path, const char* cachePath, const Compressor& comp, const std::atomic<bool>& stop)
+{
+	FileStream* file = FileStream::OpenFile(path);
+	if (!file) {
+		return GEM_ERROR;
+	}
+	char Signature[8];
+	bool ok = false;
+	if (file->Read(Signature, 8) != 8) {
+		// nothing to do
+	} else if (strncmp(Signature, "BIFCV1.0", 8) == 0) {
+		ieDword unCompBifSize;
+		file->ReadDword(unCompBifSize);
+		ok = FileCache::Get().Ensure(cachePath, [&](DataStream& out) {
+			return InflateBlocks(comp, file, out, unCompBifSize, &stop);
+		});
+	} else if (strncmp(Signature, "BIF V1.0", 8) == 0) {
+		// a single zlib stream, which can't be given up on halfway
+		ieDword fnlen, complen, declen;
+		file->ReadDword(fnlen);
+		file->Seek(fnlen, GEM_CURRENT_POS);
+		file->ReadDword(declen);
+		file->ReadDword(complen);
+		ok = FileCache::Get().Ensure(cachePath, [&](DataStream& out) {
+			return comp.Decompress(&out, file, complen) == GEM_OK;
+		});
+	}
+	delete file;
+	return ok ? GEM_OK : GEM_ERROR;
+}
+
 DataStream* BIFImporter::DecompressBIF(DataStream* compressed, const char* /*path*/)
 {
 	ieDword fnlen, complen, declen;
@@ -103,17 +225,19 @@ int BIFImporter::OpenArchive(const char* path)
 	char cachePath[_MAX_PATH];
 	PathJoin(cachePath, core->config.CachePath, filename, nullptr);
 	char Signature[8];
+	// only trust complete cache files, a crash could have left a partial one behind
+	bool cached = FileCache::Get().IsValid(cachePath);
 #if defined(SUPPORTS_MEMSTREAM)
-	auto cacheStream = new MappedFileMemoryStream{cachePath};
+	auto cacheStream = cached ? new MappedFileMemoryStream{cachePath} : nullptr;
 
-	if (!cacheStream->isOk()) {
+	if (!cacheStream || !cacheStream->isOk()) {
 		delete cacheStream;
 
 		auto file = new MappedFileMemoryStream{path};
 		if (!file->isOk()) {
 			delete file;
 #else
-	stream = FileStream::OpenFile(cachePath);
+	stream = cached ? FileStream::OpenFile(cachePath) : nullptr;
 
 	if (!stream) {
 		FileStream *file = FileStream::OpenFile(path);
@@ -160,25 +284,38 @@ int BIFImporter::OpenArchive(const char* path)
 DataStream* BIFImporter::GetStream(unsigned long Resource, unsigned long Type)
 {
 	if (Type == IE_TIS_CLASS_ID) {
-		unsigned int srcResLoc = Resource & 0xFC000;
-		for (unsigned int i = 0; i < tentcount; i++) {
-			if (( tentries[i].resLocator & 0xFC000 ) == srcResLoc) {
-				return SliceStream( stream, tentries[i].dataOffset,
-							tentries[i].tileSize * tentries[i].tilesCount );
-			}
+		ieDword srcResLoc = (Resource & 0xFC000) >> 14;
+		if (srcResLoc < tileIndex.size() && tileIndex[srcResLoc]) {
+			const TileEntry& entry = tentries[tileIndex[srcResLoc] - 1];
+			return SliceStream(stream, entry.dataOffset, entry.tileSize * entry.tilesCount);
 		}
 	} else {
 		ieDword srcResLoc = Resource & 0x3FFF;
-		for (ieDword i = 0; i < fentcount; i++) {
-			if (( fentries[i].resLocator & 0x3FFF ) == srcResLoc) {
-				return SliceStream( stream, fentries[i].dataOffset,
-							fentries[i].fileSize );
-			}
+		if (srcResLoc < fileIndex.size() && fileIndex[srcResLoc]) {
+			const FileEntry& entry = fentries[fileIndex[srcResLoc] - 1];
+			return SliceStream(stream, entry.dataOffset, entry.fileSize);
 		}
 	}
 	return NULL;
 }
 
+// maps the locators to the entries, so lookups don't have to scan the tables
+// the first entry wins in case of duplicates, just like the scan did
+void BIFImporter::IndexEntries()
+{
+	fileIndex.assign(0x3FFF + 1, 0);
+	for (ieDword i = 0; i < fentcount; i++) {
+		ieDword& slot = fileIndex[fentries[i].resLocator & 0x3FFF];
+		if (!slot) slot = i + 1;
+	}
+
+	tileIndex.assign((0xFC000 >> 14) + 1, 0);
+	for (ieDword i = 0; i < tentcount; i++) {
+		ieDword& slot = tileIndex[(tentries[i].resLocator & 0xFC000) >> 14];
+		if (!slot) slot = i + 1;
+	}
+}
+
 int BIFImporter::ReadBIF()
 {
 	ieDword foffset;
@@ -186,6 +323,8 @@ int BIFImporter::ReadBIF()
 	stream->ReadDword(tentcount);
 	stream->ReadDword(foffset);
 	stream->Seek( foffset, GEM_STREAM_START );
+	delete[] fentries;
+	delete[] tentries;
 	fentries = new FileEntry[fentcount];
 	tentries = new TileEntry[tentcount];
 	if (!fentries || !tentries) {
@@ -209,6 +348,7 @@ int BIFImporter::ReadBIF()
 		stream->ReadWord(tentries[i].type);
 		stream->ReadWord(tentries[i].u1);
 	}
+	IndexEntries();
 	return GEM_OK;
 }
 
@@ -27,6 +27,8 @@
 
 #include "Streams/DataStream.h"
 
+#include <vector>
+
 namespace GemRB {
 
 struct FileEntry {
@@ -53,6 +55,9 @@ private:
 	ieDword fentcount = 0;
 	ieDword tentcount = 0;
 	DataStream* stream = nullptr;
+	// entry lookup by the locator bits, holding the entry index + 1 (0 = absent)
+	std::vector<ieDword> fileIndex;
+	std::vector<ieDword> tileIndex;
 public:
 	BIFImporter() noexcept = default;
 	BIFImporter(const BIFImporter&) = delete;
@@ -60,10 +65,12 @@ public:
 	BIFImporter& operator=(const BIFImporter&) = delete;
 	int OpenArchive(const char* filename) override;
 	DataStream* GetStream(unsigned long Resource, unsigned long Type) override;
+	int InflateToCache(const char* path, const char* cachePath, const Compressor& comp, const std::atomic<bool>& stop) override;
 private:
 	static DataStream* DecompressBIF(DataStream* compressed, const char* path);
 	static DataStream* DecompressBIFC(DataStream* compressed, const char* path);
 	int ReadBIF();
+	void IndexEntries();
 };
 
 }
@@ -30,6 +30,7 @@
 #include "RNG.h"
 #include "TableMgr.h"
 #include "GameScript/GameScript.h"
+#include "Streams/RecordLayout.h"
 
 #include <cassert>
 
@@ -737,26 +738,27 @@ bool CREImporter::SeekCreHeader(char *Signature)
 	return true;
 }
 
-CREMemorizedSpell* CREImporter::GetMemorizedSpell()
-{
-	CREMemorizedSpell* spl = new CREMemorizedSpell();
-
-	str->ReadResRef( spl->SpellResRef );
-	str->ReadDword(spl->Flags); // was split into flags word and two alignment bytes
-
-	return spl;
-}
-
-CREKnownSpell* CREImporter::GetKnownSpell()
-{
-	CREKnownSpell* spl = new CREKnownSpell();
-
-	str->ReadResRef(spl->SpellResRef);
-	str->ReadWord(spl->Level);
-	str->ReadWord(spl->Type);
+using MemorizedSpellLayout = RecordLayout<CREMemorizedSpell,
+	RECORD_FIELD(CREMemorizedSpell, SpellResRef),
+	RECORD_FIELD(CREMemorizedSpell, Flags)>; // was split into flags word and two alignment bytes
+using KnownSpellLayout = RecordLayout<CREKnownSpell,
+	RECORD_FIELD(CREKnownSpell, SpellResRef),
+	RECORD_FIELD(CREKnownSpell, Level), RECORD_FIELD(CREKnownSpell, Type)>;
+
+struct SpellMemorizationRecord {
+	ieWord Level;
+	ieWord Number;
+	ieWord Number2;
+	ieWord Type;
+	ieDword MemorizedIndex;
+	ieDword MemorizedCount;
+};
 
-	return spl;
-}
+using SpellMemorizationLayout = RecordLayout<SpellMemorizationRecord,
+	RECORD_FIELD(SpellMemorizationRecord, Level), RECORD_FIELD(SpellMemorizationRecord, Number),
+	RECORD_FIELD(SpellMemorizationRecord, Number2), RECORD_FIELD(SpellMemorizationRecord, Type),
+	RECORD_FIELD(SpellMemorizationRecord, MemorizedIndex),
+	RECORD_FIELD(SpellMemorizationRecord, MemorizedCount)>;
 
 void CREImporter::ReadScript(Actor *act, int ScriptLevel)
 {
@@ -767,19 +769,15 @@ void CREImporter::ReadScript(Actor *act, int ScriptLevel)
 
 CRESpellMemorization* CREImporter::GetSpellMemorization(Actor *act)
 {
-	ieWord Level, Type, Number, Number2;
-
-	str->ReadWord(Level);
-	str->ReadWord(Number);
-	str->ReadWord(Number2);
-	str->ReadWord(Type);
-	str->ReadDword(MemorizedIndex);
-	str->ReadDword(MemorizedCount);
+	SpellMemorizationRecord record {};
+	SpellMemorizationLayout::Read(str, record);
+	MemorizedIndex = record.MemorizedIndex;
+	MemorizedCount = record.MemorizedCount;
 
-	CRESpellMemorization* spl = act->spellbook.GetSpellMemorization(Type, Level);
+	CRESpellMemorization* spl = act->spellbook.GetSpellMemorization(record.Type, record.Level);
 	assert(spl && spl->SlotCount == 0 && spl->SlotCountWithBonus == 0); // unused
-	spl->SlotCount = Number;
-	spl->SlotCountWithBonus = Number; // Number2? Doesn't look like it's different in the data
+	spl->SlotCount = record.Number;
+	spl->SlotCountWithBonus = record.Number; // Number2? Doesn't look like it's different in the data
 
 	return spl;
 }
@@ -1158,10 +1156,8 @@ void CREImporter::ReadInventory(Actor *act, unsigned int Inventory_Size)
 	str->Seek(ItemSlotsOffset + CREOffset, GEM_STREAM_START);
 
 	//first read the indices
-	std::vector<ieWord> indices(Inventory_Size);
-	for (auto& idx : indices) {
-		str->ReadWord(idx);
-	}
+	std::vector<ieWord> indices(Inventory_Size, 0xffff);
+	ReadScalarTable(str, indices.data(), indices.size());
 
 	ieWordSigned eqslot;
 	ieWord eqheader;
@@ -1217,14 +1213,19 @@ void CREImporter::ReadSpellbook(Actor *act)
 	knownSpells.resize(KnownSpellsCount);
 	memorizedSpells.resize(MemorizedSpellsCount);
 
+	// both tables are decoded in one go, then handed out one by one
+	std::vector<CREKnownSpell> knownRecords(KnownSpellsCount);
 	str->Seek(KnownSpellsOffset + CREOffset, GEM_STREAM_START);
-	for (auto& knownSpell : knownSpells) {
-		knownSpell = GetKnownSpell();
+	KnownSpellLayout::ReadTable(str, knownRecords.data(), knownRecords.size());
+	for (size_t i = 0; i < knownSpells.size(); i++) {
+		knownSpells[i] = new CREKnownSpell(knownRecords[i]);
 	}
 
+	std::vector<CREMemorizedSpell> memorizedRecords(MemorizedSpellsCount);
 	str->Seek(MemorizedSpellsOffset + CREOffset, GEM_STREAM_START);
-	for (auto& memorizedSpell : memorizedSpells) {
-		memorizedSpell = GetMemorizedSpell();
+	MemorizedSpellLayout::ReadTable(str, memorizedRecords.data(), memorizedRecords.size());
+	for (size_t i = 0; i < memorizedSpells.size(); i++) {
+		memorizedSpells[i] = new CREMemorizedSpell(memorizedRecords[i]);
 	}
 
 	str->Seek(SpellMemorizationOffset + CREOffset, GEM_STREAM_START);
@@ -96,9 +96,7 @@ private:
 	Effect* GetEffect();
 	void ReadScript(Actor *actor, int ScriptLevel);
 	void ReadDialog(Actor *actor);
-	CREKnownSpell* GetKnownSpell();
 	CRESpellMemorization* GetSpellMemorization(Actor *act);
-	CREMemorizedSpell* GetMemorizedSpell();
 	CREItem* GetItem();
 	void SetupColor(ieDword&) const;
 
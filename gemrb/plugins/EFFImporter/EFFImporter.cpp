@@ -21,6 +21,7 @@
 #include "EFFImporter.h"
 
 #include "Interface.h"
+#include "Streams/RecordLayout.h"
 
 using namespace GemRB;
 
@@ -77,38 +78,62 @@ Effect* EFFImporter::GetEffect()
 	}
 }
 
+// the resources are in a union, so they're taken by hand between the layouts
+using EffectV1Head = RecordLayout<Effect,
+	RECORD_FIELD_AS(ieWord, Effect, Opcode), RECORD_FIELD_AS(ieByte, Effect, Target),
+	RECORD_FIELD_AS(ieByte, Effect, Power), RECORD_FIELD(Effect, Parameter1),
+	RECORD_FIELD(Effect, Parameter2), RECORD_FIELD_AS(ieByte, Effect, TimingMode),
+	RECORD_FIELD_AS(ieByte, Effect, Resistance), RECORD_FIELD(Effect, Duration),
+	RECORD_FIELD_AS(ieByte, Effect, ProbabilityRangeMax), RECORD_FIELD_AS(ieByte, Effect, ProbabilityRangeMin)>;
+
+// the same in both versions
+using EffectDice = RecordLayout<Effect,
+	RECORD_FIELD(Effect, DiceThrown), RECORD_FIELD(Effect, DiceSides),
+	RECORD_FIELD(Effect, SavingThrowType), RECORD_FIELD(Effect, SavingThrowBonus),
+	RECORD_FIELD(Effect, IsVariable), RECORD_FIELD(Effect, IsSaveForHalfDamage)>;
+
+using EffectV2Head = RecordLayout<Effect, SkipBytes<8>,
+	RECORD_FIELD(Effect, Opcode), RECORD_FIELD(Effect, Target),
+	RECORD_FIELD(Effect, Power), RECORD_FIELD(Effect, Parameter1),
+	RECORD_FIELD(Effect, Parameter2), RECORD_FIELD(Effect, TimingMode),
+	RECORD_FIELD(Effect, unknown2), // part of a dword TimingMode (but only true for v2 effects)
+	RECORD_FIELD(Effect, Duration), RECORD_FIELD(Effect, ProbabilityRangeMax),
+	RECORD_FIELD(Effect, ProbabilityRangeMin)>;
+
+using EffectV2Levels = RecordLayout<Effect,
+	RECORD_FIELD(Effect, PrimaryType), SkipBytes<4>, // JeremyIsAnIdiot in the original :D
+	RECORD_FIELD(Effect, MinAffectedLevel), RECORD_FIELD(Effect, MaxAffectedLevel),
+	RECORD_FIELD(Effect, Resistance), RECORD_FIELD(Effect, Parameter3),
+	RECORD_FIELD(Effect, Parameter4), RECORD_FIELD(Effect, Parameter5),
+	RECORD_FIELD(Effect, Parameter6)>;
+
+using EffectV2Source = RecordLayout<Effect,
+	RECORD_FIELD(Effect, SourceType), RECORD_FIELD(Effect, SourceRef),
+	RECORD_FIELD(Effect, SourceFlags), RECORD_FIELD(Effect, Projectile),
+	RECORD_FIELD(Effect, InventorySlot)>;
+
+using EffectV2Tail = RecordLayout<Effect,
+	RECORD_FIELD(Effect, CasterLevel), SkipBytes<4>, // FirstApply
+	RECORD_FIELD(Effect, SecondaryType), SkipBytes<60>>;
+
+static constexpr size_t EffectV1Size = EffectV1Head::Size + 8 + EffectDice::Size;
+static constexpr size_t EffectV2Size = EffectV2Head::Size + 8 + EffectDice::Size + EffectV2Levels::Size
+	+ 16 + 16 + EffectV2Source::Size + 32 + EffectV2Tail::Size;
+static_assert(EffectV1Size == 48, "EFF V1 effects are 48 bytes");
+static_assert(EffectV2Size == 264, "EFF V2 effects are 264 bytes");
+
 Effect* EFFImporter::GetEffectV1()
 {
-	ieByte tmpByte;
-	ieWord tmpWord;
-
 	Effect* fx = new Effect;
 
-	str->ReadWord(tmpWord);
-	fx->Opcode = tmpWord;
-	str->Read( &tmpByte, 1 );
-	fx->Target = tmpByte;
-	str->Read( &tmpByte, 1 );
-	fx->Power = tmpByte;
-	str->ReadDword(fx->Parameter1);
-	str->ReadDword(fx->Parameter2);
-	str->Read( &tmpByte, 1 );
-	fx->TimingMode = tmpByte;
-	str->Read( &tmpByte, 1 );
-	fx->Resistance = tmpByte;
-	str->ReadDword(fx->Duration);
-	str->Read( &tmpByte, 1 );
-	fx->ProbabilityRangeMax = tmpByte;
-	str->Read( &tmpByte, 1 );
-	fx->ProbabilityRangeMin = tmpByte;
-	str->ReadResRef( fx->Resource );
-	str->ReadDword(fx->DiceThrown);
-	str->ReadDword(fx->DiceSides);
-	str->ReadDword(fx->SavingThrowType);
-	str->ReadDword(fx->SavingThrowBonus);
-	str->ReadWord(fx->IsVariable);
-	str->ReadWord(fx->IsSaveForHalfDamage);
-	fixAffectedLevels( fx );
+	RecordBytes<EffectV1Size> bytes(str);
+	if (bytes) {
+		RecordCursor cursor = bytes.Cursor();
+		EffectV1Head::Decode(cursor, *fx);
+		cursor.TakeString(fx->Resource, 8);
+		EffectDice::Decode(cursor, *fx);
+		fixAffectedLevels(fx);
+	}
 
 	fx->Pos = Point(-1, -1);
 	fx->Source = Point(-1, -1);
@@ -117,63 +142,33 @@ Effect* EFFImporter::GetEffectV1()
 
 Effect* EFFImporter::GetEffectV20()
 {
-	ieDword tmp;
 	Effect* fx = new Effect;
 
-	str->Seek(8, GEM_CURRENT_POS);
-	str->ReadDword(fx->Opcode);
-	str->ReadDword(fx->Target);
-	str->ReadDword(fx->Power);
-	str->ReadDword(fx->Parameter1);
-	str->ReadDword(fx->Parameter2);
-	str->ReadWord(fx->TimingMode);
-	str->ReadWord(fx->unknown2); // part of a dword TimingMode (but only true for v2 effects)
-	str->ReadDword(fx->Duration);
-	str->ReadWord(fx->ProbabilityRangeMax);
-	str->ReadWord(fx->ProbabilityRangeMin);
-	str->ReadResRef( fx->Resource );
-	str->ReadDword(fx->DiceThrown);
-	str->ReadDword(fx->DiceSides);
-	str->ReadDword(fx->SavingThrowType);
-	str->ReadDword(fx->SavingThrowBonus);
-	str->ReadWord(fx->IsVariable); //if this field was set to 1, this is a variable
-	str->ReadWord(fx->IsSaveForHalfDamage); //if this field was set to 1, save for half damage; part of Special dword with the preceding field
-	str->ReadDword(fx->PrimaryType);
-	str->Seek(4, GEM_CURRENT_POS); // JeremyIsAnIdiot in the original :D
-	str->ReadDword(fx->MinAffectedLevel);
-	str->ReadDword(fx->MaxAffectedLevel);
-	str->ReadDword(fx->Resistance);
-	str->ReadDword(fx->Parameter3);
-	str->ReadDword(fx->Parameter4);
-	str->ReadDword(fx->Parameter5);
-	str->ReadDword(fx->Parameter6);
-	str->ReadResRef( fx->Resource2 );
-	str->ReadResRef( fx->Resource3 );
-	str->ReadDword(tmp);
-	fx->Source.x = tmp;
-	str->ReadDword(tmp);
-	fx->Source.y = tmp;
-	str->ReadDword(tmp);
-	fx->Pos.x = tmp;
-	str->ReadDword(tmp);
-	fx->Pos.y = tmp;
-	str->ReadDword(fx->SourceType);
-	str->ReadResRef(fx->SourceRef);
-	str->ReadDword(fx->SourceFlags);
-	str->ReadDword(fx->Projectile);
-	str->ReadDword(tmp);
-	fx->InventorySlot=(ieDwordSigned) (tmp);
+	RecordBytes<EffectV2Size> bytes(str);
+	if (!bytes) {
+		return fx;
+	}
+
+	RecordCursor cursor = bytes.Cursor();
+	EffectV2Head::Decode(cursor, *fx);
+	cursor.TakeString(fx->Resource, 8);
+	EffectDice::Decode(cursor, *fx); //IsVariable: if this field was set to 1, this is a variable
+	EffectV2Levels::Decode(cursor, *fx);
+	cursor.TakeString(fx->Resource2, 8);
+	cursor.TakeString(fx->Resource3, 8);
+	fx->Source.x = cursor.Take<ieDword>();
+	fx->Source.y = cursor.Take<ieDword>();
+	fx->Pos.x = cursor.Take<ieDword>();
+	fx->Pos.y = cursor.Take<ieDword>();
+	EffectV2Source::Decode(cursor, *fx);
 	//Variable simply overwrites the resource fields (Keep them grouped)
 	//They have to be continuous
 	if (fx->IsVariable) {
-		str->ReadVariable(fx->VariableName);
+		cursor.TakeString(fx->VariableName, 32);
 	} else {
-		str->Seek( 32, GEM_CURRENT_POS);
+		cursor.Skip(32);
 	}
-	str->ReadDword(fx->CasterLevel);
-	str->Seek(4, GEM_CURRENT_POS); // FirstApply
-	str->ReadDword(fx->SecondaryType);
-	str->Seek(60, GEM_CURRENT_POS); // padding
+	EffectV2Tail::Decode(cursor, *fx);
 
 	return fx;
 }
@@ -518,8 +518,8 @@ Actor* GAMImporter::GetActor(const std::shared_ptr<ActorMgr>& aM, bool is_in_par
 	memcpy(ps->QuickItemSlots, pcInfo.QuickItemSlot, MAX_QUICKITEMSLOT*sizeof(ieWord) );
 	memcpy(ps->QuickItemHeaders, pcInfo.QuickItemHeader, MAX_QUICKITEMSLOT*sizeof(ieWord) );
 	actor->ReinitQuickSlots();
-	actor->Destination.x = actor->Pos.x = pcInfo.XPos;
-	actor->Destination.y = actor->Pos.y = pcInfo.YPos;
+	actor->SetPos(Point(pcInfo.XPos, pcInfo.YPos));
+	actor->Destination = actor->Pos;
 	actor->Area = pcInfo.Area;
 	actor->SetOrientation(ClampToOrientation(pcInfo.Orientation), false);
 	actor->TalkCount = pcInfo.TalkCount;
@@ -24,12 +24,14 @@
 #include "PythonConversions.h"
 #include "PythonErrors.h"
 
+#include "ActorMgr.h"
 #include "Audio.h"
 #include "CharAnimations.h"
 #include "DataFileMgr.h"
 #include "DialogHandler.h"
 #include "DisplayMessage.h"
 #include "EffectQueue.h"
+#include "FrameProfiler.h"
 #include "Game.h"
 #include "GameData.h"
 #include "ImageFactory.h"
@@ -37,17 +39,27 @@
 #include "Item.h"
 #include "KeyMap.h"
 #include "Map.h"
+#include "MapMgr.h"
 #include "MusicMgr.h"
+#include "ObjectPool.h"
 #include "Palette.h"
+#include "Particles.h"
 #include "PalettedImageMgr.h"
+#include "PluginMgr.h"
+#include "Projectile.h"
+#include "ProjectileServer.h"
 #include "ResourceDesc.h"
 #include "RNG.h"
 #include "SaveGameIterator.h"
+#include "ScriptedAnimation.h"
+#include "SoundMgr.h"
 #include "Spell.h"
 #include "TileMap.h"
+#include "Video/SpanBlitters.h"
 #include "Video/Video.h"
 #include "WorldMap.h"
 #include "GameScript/GSUtils.h" //checkvariable
+#include "GameScript/ScriptProfiler.h"
 #include "GUI/Button.h"
 #include "GUI/Console.h"
 #include "GUI/EventMgr.h"
@@ -63,9 +75,11 @@
 #include "Scriptable/Door.h"
 #include "Scriptable/InfoPoint.h"
 #include "Streams/FileStream.h"
+#include "Streams/MemoryStream.h"
 #include "System/FileFilters.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cstdio>
 
 using namespace GemRB;
@@ -4399,6 +4413,569 @@ static PyObject* GemRB_PlayMovie(PyObject * /*self*/, PyObject* args)
 	return PyLong_FromLong(ind);
 }
 
+#ifdef USE_BENCHMARKS
+// developer benchmarks; they build maps, move the party and use up random
+// numbers, so they are left out of normal builds
+PyDoc_STRVAR( GemRB_BenchmarkActorQueries__doc,
+"===== BenchmarkActorQueries =====\n\
+\n\
+**Prototype:** GemRB.BenchmarkActorQueries ([maxActors])\n\
+\n\
+**Description:** Scatters ever larger crowds of dummy actors over the current \n\
+area, starting with 50 and doubling up to maxActors, and logs how long the \n\
+neighbour queries take with the actor grid and with a plain scan.\n\
+\n\
+**Parameters:**\n\
+  * maxActors - the largest crowd to try, defaults to 800\n\
+\n\
+**Return value:** the speedup of the grid over the scan for the largest crowd"
+);
+static PyObject* GemRB_BenchmarkActorQueries(PyObject * /*self*/, PyObject * args)
+{
+	int maxActors = 800;
+	PARSE_ARGS( args,  "|i", &maxActors );
+
+	GET_GAME();
+	GET_MAP();
+
+	return PyFloat_FromDouble(map->BenchmarkActorQueries(std::max(maxActors, 50)));
+}
+
+PyDoc_STRVAR( GemRB_BenchmarkPathfinding__doc,
+"===== BenchmarkPathfinding =====\n\
+\n\
+**Prototype:** GemRB.BenchmarkPathfinding ([rounds])\n\
+\n\
+**Description:** Replays the recent pathfinding queries of the current area \n\
+(or a fixed set of random ones, if there were none yet) with both the flat \n\
+and the hierarchical planner and logs the timings.\n\
+\n\
+**Parameters:**\n\
+  * rounds - how many times to replay the queries, defaults to 10\n\
+\n\
+**Return value:** tuple of the paths searched per second by the flat and the hierarchical planner"
+);
+static PyObject* GemRB_BenchmarkPathfinding(PyObject * /*self*/, PyObject * args)
+{
+	int rounds = 10;
+	PARSE_ARGS( args,  "|i", &rounds );
+
+	GET_GAME();
+	GET_MAP();
+
+	rounds = std::max(rounds, 1);
+	double flat = map->BenchmarkPathfinding(rounds, false);
+	double hierarchical = map->BenchmarkPathfinding(rounds, true);
+	return Py_BuildValue("(dd)", flat, hierarchical);
+}
+
+PyDoc_STRVAR( GemRB_BenchmarkLoaders__doc,
+"===== BenchmarkLoaders =====\n\
+\n\
+**Prototype:** GemRB.BenchmarkLoaders ([rounds])\n\
+\n\
+**Description:** Writes every creature of the current area into memory as a \n\
+CRE file, then logs how long it takes to load them all back, which is mostly \n\
+the decoding of their effects, items and spellbooks. Then does the same with \n\
+the whole area as an ARE file, like a save game holds it, which covers its \n\
+actor, animation, entrance, variable and vertex records (and the rest of \n\
+the area loading, like the WED and search map).\n\
+\n\
+**Parameters:**\n\
+  * rounds - how many times to load the creatures and the area, defaults to 20\n\
+\n\
+**Return value:** dict with the average times of a round in milliseconds:\n\
+  * Creatures - loading all the creatures once\n\
+  * Area - loading the area once"
+);
+static PyObject* GemRB_BenchmarkLoaders(PyObject * /*self*/, PyObject * args)
+{
+	int rounds = 20;
+	PARSE_ARGS( args,  "|i", &rounds );
+
+	GET_GAME();
+	GET_MAP();
+
+	auto actmgr = GetImporter<ActorMgr>(IE_CRE_CLASS_ID);
+	if (!actmgr) {
+		return RuntimeError("No CRE importer available!");
+	}
+
+	// the files are written once, so only the loading is timed
+	std::vector<std::unique_ptr<DataStream>> files;
+	size_t bytes = 0;
+	for (int i = 0; i < map->GetActorCount(false); i++) {
+		const Actor* actor = map->GetActor(i, false);
+		int size = actmgr->GetStoredFileSize(actor);
+		if (size <= 0) continue;
+
+		files.emplace_back(new MemoryStream(actor->GetScriptName().CString(), malloc(size), size));
+		if (actmgr->PutActor(files.back().get(), actor) < 0) {
+			files.pop_back();
+			continue;
+		}
+		bytes += size;
+	}
+
+	using Clock = std::chrono::steady_clock;
+	Clock::duration elapsed {};
+	size_t loaded = 0;
+	rounds = std::max(rounds, 1);
+	for (int round = 0; round < rounds; round++) {
+		for (const auto& file : files) {
+			DataStream* copy = file->Clone();
+			Clock::time_point start = Clock::now();
+			Actor* actor = actmgr->Open(copy) ? actmgr->GetActor(0) : nullptr;
+			elapsed += Clock::now() - start;
+			if (actor) {
+				loaded++;
+				delete actor;
+			}
+		}
+	}
+
+	double ms = std::chrono::duration<double, std::milli>(elapsed).count() / rounds;
+	Log(MESSAGE, "GUIScript", "Loaded {} creatures ({} bytes) in {:.3f}ms per round, {} loads in total",
+		files.size(), bytes, ms, loaded);
+
+	auto mapmgr = GetImporter<MapMgr>(IE_ARE_CLASS_ID);
+	if (!mapmgr) {
+		return RuntimeError("No ARE importer available!");
+	}
+	int areSize = mapmgr->GetStoredFileSize(map);
+	if (areSize <= 0) {
+		return RuntimeError("Cannot store the current area!");
+	}
+	MemoryStream areFile(map->GetScriptRef().CString(), malloc(areSize), areSize);
+	if (mapmgr->PutArea(&areFile, map) < 0) {
+		return RuntimeError("Cannot store the current area!");
+	}
+
+	elapsed = {};
+	loaded = 0;
+	for (int round = 0; round < rounds; round++) {
+		DataStream* copy = areFile.Clone();
+		Clock::time_point start = Clock::now();
+		Map* area = mapmgr->Open(copy) ? mapmgr->GetMap(map->GetScriptRef(), game->IsDay()) : nullptr;
+		elapsed += Clock::now() - start;
+		if (area) {
+			loaded++;
+			delete area;
+		}
+	}
+
+	double areMs = std::chrono::duration<double, std::milli>(elapsed).count() / rounds;
+	Log(MESSAGE, "GUIScript", "Loaded {} ({} bytes, {} actors) in {:.3f}ms per round, {} loads in total",
+		map->GetScriptRef(), areSize, map->GetActorCount(false), areMs, loaded);
+	return Py_BuildValue("{s:d,s:d}", "Creatures", ms, "Area", areMs);
+}
+
+PyDoc_STRVAR( GemRB_BenchmarkParticles__doc,
+"===== BenchmarkParticles =====\n\
+\n\
+**Prototype:** GemRB.BenchmarkParticles ([ticks, volleys, missiles])\n\
+\n\
+**Description:** Logs how long a screen wide storm takes to update and how \n\
+long it takes to create and destroy volleys of missiles, each with its own \n\
+sparkles, together with how much of their memory came from the pools.\n\
+\n\
+**Parameters:**\n\
+  * ticks - how many times to update the storm, defaults to 1000\n\
+  * volleys - how many volleys to fire, defaults to 100\n\
+  * missiles - how many missiles make a volley, defaults to 100\n\
+\n\
+**Return value:** dict with the keys:\n\
+  * Storm - the time of all the storm updates in milliseconds\n\
+  * Volleys - the time of all the volleys in milliseconds\n\
+  * ProjectileReuses - projectiles that reused pooled memory\n\
+  * ParticleReuses - particle systems that reused pooled memory"
+);
+static PyObject* GemRB_BenchmarkParticles(PyObject * /*self*/, PyObject * args)
+{
+	int ticks = 1000;
+	int volleys = 100;
+	int missiles = 100;
+	PARSE_ARGS( args,  "|iii", &ticks, &volleys, &missiles );
+
+	using Clock = std::chrono::steady_clock;
+	auto elapsedMs = [](Clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	};
+
+	// the same rain as Game::StartRainOrSnow
+	Particles storm(200);
+	storm.SetRegion(0, 0, core->config.Width, core->config.Height);
+	storm.SetType(SP_TYPE_LINE, SP_PATH_RAIN, SP_SPAWN_SOME);
+	storm.SetColor(SPARK_COLOR_STONE);
+	storm.SetPhase(P_GROW);
+	Clock::time_point start = Clock::now();
+	for (int tick = 0; tick < ticks; tick++) {
+		storm.Update();
+	}
+	double stormMs = elapsedMs(start);
+
+	ProjectileServer* server = core->GetProjectileServer();
+	size_t kinds = server->GetHighestProjectileNumber();
+	std::vector<Projectile*> projectiles;
+	std::vector<Particles*> sparkles;
+	const auto projectileStats = ObjectPool<Projectile>::Get().GetStats();
+	const auto particleStats = ObjectPool<Particles>::Get().GetStats();
+	start = Clock::now();
+	for (int volley = 0; volley < volleys; volley++) {
+		for (int i = 0; i < missiles; i++) {
+			projectiles.push_back(server->GetProjectileByIndex(kinds ? i % kinds : 0));
+			// like Map::Sparkle does for the default spark path
+			Particles* spark = new Particles(100);
+			spark->SetRegion(0, 0, 40, 100);
+			spark->SetType(SP_TYPE_POINT, SP_PATH_FLIT, SP_SPAWN_SOME);
+			spark->SetPhase(P_GROW);
+			spark->Update();
+			sparkles.push_back(spark);
+		}
+		for (const Projectile* pro : projectiles) {
+			delete pro;
+		}
+		for (const Particles* spark : sparkles) {
+			delete spark;
+		}
+		projectiles.clear();
+		sparkles.clear();
+	}
+	double volleyMs = elapsedMs(start);
+
+	size_t projectileReuses = ObjectPool<Projectile>::Get().GetStats().reuses - projectileStats.reuses;
+	size_t particleReuses = ObjectPool<Particles>::Get().GetStats().reuses - particleStats.reuses;
+	Log(MESSAGE, "GUIScript", "Storm: {} updates in {:.2f}ms; {} volleys of {} missiles in {:.2f}ms, {} projectiles and {} sparkles reused pooled memory",
+		ticks, stormMs, volleys, missiles, volleyMs, projectileReuses, particleReuses);
+	return Py_BuildValue("{s:d,s:d,s:n,s:n}", "Storm", stormMs, "Volleys", volleyMs,
+		"ProjectileReuses", Py_ssize_t(projectileReuses), "ParticleReuses", Py_ssize_t(particleReuses));
+}
+
+PyDoc_STRVAR( GemRB_BenchmarkPartyMove__doc,
+"===== BenchmarkPartyMove =====\n\
+\n\
+**Prototype:** GemRB.BenchmarkPartyMove (x, y[, rounds])\n\
+\n\
+**Description:** Repeatedly orders every party member in the current area \n\
+to walk to the given point and logs how long it takes until they all have \n\
+their paths, searching right away and, if PathfindingThreads is set, through \n\
+the queue solved on the worker threads. Nobody actually moves.\n\
+\n\
+**Parameters:**\n\
+  * x, y - the destination, preferably far away on a large area\n\
+  * rounds - how many orders to give, defaults to 20\n\
+\n\
+**Return value:** the orders handled per second the configured way"
+);
+static PyObject* GemRB_BenchmarkPartyMove(PyObject * /*self*/, PyObject * args)
+{
+	Point dest;
+	int rounds = 20;
+	PARSE_ARGS( args,  "ii|i", &dest.x, &dest.y, &rounds );
+
+	GET_GAME();
+	GET_MAP();
+
+	return PyFloat_FromDouble(map->BenchmarkPartyMove(dest, std::max(rounds, 1)));
+}
+
+PyDoc_STRVAR( GemRB_BenchmarkPartyRefresh__doc,
+"===== BenchmarkPartyRefresh =====\n\
+\n\
+**Prototype:** GemRB.BenchmarkPartyRefresh ([buffs, rounds])\n\
+\n\
+**Description:** Temporarily gives every party member a pile of extra stat \n\
+modifying effects and logs how long their full stat refreshes take. The \n\
+original effects are restored afterwards.\n\
+\n\
+**Parameters:**\n\
+  * buffs - how many effects to add to each party member, defaults to 300\n\
+  * rounds - how many times to refresh the whole party, defaults to 100\n\
+\n\
+**Return value:** the average time of a single refresh in milliseconds"
+);
+static PyObject* GemRB_BenchmarkPartyRefresh(PyObject * /*self*/, PyObject * args)
+{
+	int buffs = 300;
+	int rounds = 100;
+	PARSE_ARGS( args,  "|ii", &buffs, &rounds );
+
+	GET_GAME();
+
+	return PyFloat_FromDouble(game->BenchmarkPartyRefresh(std::max(buffs, 0), std::max(rounds, 1)));
+}
+
+PyDoc_STRVAR( GemRB_BenchmarkBlitters__doc,
+"===== BenchmarkBlitters =====\n\
+\n\
+**Prototype:** GemRB.BenchmarkBlitters ([rounds])\n\
+\n\
+**Description:** Checks that the vectorized span blitters produce exactly \n\
+the same pixels as the per pixel blenders for every supported instruction \n\
+set, then logs how long each of them takes to blend a large span.\n\
+\n\
+**Parameters:**\n\
+  * rounds - how many times to blend the span when timing, defaults to 20; \n\
+    0 only runs the checks\n\
+\n\
+**Return value:** bool, true if all the kernels matched"
+);
+static PyObject* GemRB_BenchmarkBlitters(PyObject * /*self*/, PyObject * args)
+{
+	int rounds = 20;
+	PARSE_ARGS( args,  "|i", &rounds );
+
+	return PyBool_FromLong(BenchmarkSpanBlitters(std::max(rounds, 0)));
+}
+
+namespace {
+
+// the sounds to decode: the ones named in a list, the ACM files of a
+// directory or, without either, the ones the current area would preload
+struct SoundSet {
+	std::vector<std::string> names;
+	ResourceManager directory;
+	bool fromDirectory = false;
+
+	ResourceHolder<SoundMgr> Open(const std::string& name) const
+	{
+		if (fromDirectory) {
+			return GetResourceHolder<SoundMgr>(name.c_str(), directory, true);
+		}
+		return GetResourceHolder<SoundMgr>(name.c_str(), true);
+	}
+};
+
+bool CollectSounds(PyObject* source, SoundSet& sounds)
+{
+	if (!source || source == Py_None) {
+		const Game* game = core->GetGame();
+		const Map* map = game ? game->GetCurrentArea() : nullptr;
+		if (!map) return false;
+		sounds.names = map->GetSoundsToPreload();
+	} else if (PyList_Check(source)) {
+		for (Py_ssize_t i = 0; i < PyList_Size(source); i++) {
+			PyObject* item = PyList_GetItem(source, i);
+			if (!PyUnicode_Check(item)) return false;
+			sounds.names.emplace_back(PyString_AsString(item));
+		}
+	} else if (PyUnicode_Check(source)) {
+		char path[_MAX_PATH];
+		strlcpy(path, PyString_AsString(source), sizeof(path));
+		if (!sounds.directory.AddSource(path, "Sounds", PLUGIN_RESOURCE_DIRECTORY)) return false;
+		sounds.fromDirectory = true;
+
+		DirectoryIterator dir(path);
+		dir.SetFilterPredicate(new ExtFilter("ACM"));
+		for (; dir; ++dir) {
+			std::string name = dir.GetName();
+			sounds.names.push_back(name.substr(0, name.rfind('.')));
+		}
+	} else {
+		return false;
+	}
+	return true;
+}
+
+}
+
+PyDoc_STRVAR( GemRB_BenchmarkSoundDecoding__doc,
+"===== BenchmarkSoundDecoding =====\n\
+\n\
+**Prototype:** GemRB.BenchmarkSoundDecoding ([rounds[, sounds]])\n\
+\n\
+**Description:** Decodes sounds and logs how much faster than realtime the \n\
+decoding runs. By default these are the sounds the current area would \n\
+preload (ambients and the battle cries of its creatures).\n\
+\n\
+**Parameters:**\n\
+  * rounds - how many times to decode the sounds, defaults to 1\n\
+  * sounds - a list of sound resources, or a directory to decode all the ACM files of\n\
+\n\
+**Return value:** the seconds of audio decoded per second\n\
+\n\
+**See also:** [CheckSoundDecoding](CheckSoundDecoding.md)"
+);
+static PyObject* GemRB_BenchmarkSoundDecoding(PyObject * /*self*/, PyObject * args)
+{
+	int rounds = 1;
+	PyObject* source = nullptr;
+	PARSE_ARGS( args,  "|iO", &rounds, &source );
+
+	SoundSet sounds;
+	if (!CollectSounds(source, sounds)) {
+		return RuntimeError("No sounds to decode, pass a list or a directory without a current area.");
+	}
+
+	std::vector<short> samples;
+	double audioSeconds = 0.0;
+	size_t decoded = 0;
+	using Clock = std::chrono::steady_clock;
+	Clock::duration elapsed {};
+	for (int round = 0; round < std::max(rounds, 1); round++) {
+		for (const std::string& name : sounds.names) {
+			Clock::time_point start = Clock::now();
+			ResourceHolder<SoundMgr> sound = sounds.Open(name);
+			if (!sound) continue;
+			samples.resize(sound->get_length());
+			int count = sound->read_samples(samples.data(), sound->get_length());
+			elapsed += Clock::now() - start;
+
+			int rate = sound->get_samplerate() * std::max(sound->get_channels(), 1);
+			if (rate > 0) {
+				audioSeconds += double(count) / rate;
+			}
+			decoded++;
+		}
+	}
+
+	double ms = std::chrono::duration<double, std::milli>(elapsed).count();
+	double speed = ms > 0 ? audioSeconds * 1000.0 / ms : 0.0;
+	Log(MESSAGE, "GUIScript", "Decoded {} sounds, {:.1f}s of audio in {:.2f}ms ({:.0f}x realtime)",
+		decoded, audioSeconds, ms, speed);
+	return PyFloat_FromDouble(speed);
+}
+
+PyDoc_STRVAR( GemRB_CheckSoundDecoding__doc,
+"===== CheckSoundDecoding =====\n\
+\n\
+**Prototype:** GemRB.CheckSoundDecoding ([sounds])\n\
+\n\
+**Description:** Decodes each sound twice, once as usual and once without any \n\
+cpu specific speedups (like the vector filters of the ACM decoder), and \n\
+compares the samples bit for bit. Meant to be run after touching those.\n\
+\n\
+**Parameters:**\n\
+  * sounds - a list of sound resources, or a directory to check all the ACM files of; \n\
+by default the sounds the current area would preload\n\
+\n\
+**Return value:** the list of sounds that decoded differently, empty if all matched\n\
+\n\
+**See also:** [BenchmarkSoundDecoding](BenchmarkSoundDecoding.md)"
+);
+static PyObject* GemRB_CheckSoundDecoding(PyObject * /*self*/, PyObject * args)
+{
+	PyObject* source = nullptr;
+	PARSE_ARGS( args,  "|O", &source );
+
+	SoundSet sounds;
+	if (!CollectSounds(source, sounds)) {
+		return RuntimeError("No sounds to check, pass a list or a directory without a current area.");
+	}
+
+	PyObject* mismatches = PyList_New(0);
+	std::vector<short> expected;
+	std::vector<short> result;
+	size_t checked = 0;
+	for (const std::string& name : sounds.names) {
+		ResourceHolder<SoundMgr> reference = sounds.Open(name);
+		ResourceHolder<SoundMgr> sound = sounds.Open(name);
+		if (!reference || !sound) continue;
+
+		reference->UseReferenceDecoder();
+		expected.resize(reference->get_length());
+		expected.resize(reference->read_samples(expected.data(), reference->get_length()));
+		result.resize(sound->get_length());
+		result.resize(sound->read_samples(result.data(), sound->get_length()));
+		checked++;
+		if (result != expected) {
+			Log(ERROR, "GUIScript", "{} decodes differently from the reference decoder!", name);
+			PyObject* item = PyString_FromString(name.c_str());
+			PyList_Append(mismatches, item);
+			Py_DECREF(item);
+		}
+	}
+
+	Log(MESSAGE, "GUIScript", "Checked {} sounds, {} decoded differently.", checked, PyList_Size(mismatches));
+	return mismatches;
+}
+
+#endif
+
+PyDoc_STRVAR( GemRB_ProfileScripts__doc,
+"===== ProfileScripts =====\n\
+\n\
+**Prototype:** GemRB.ProfileScripts (enable[, limit])\n\
+\n\
+**Description:** Starts or stops timing the scripts. Starting drops any \n\
+previous results, while stopping logs the scripts and triggers that took \n\
+the most time, together with how often the per tick trigger memo was hit.\n\
+\n\
+**Parameters:**\n\
+  * enable - 1 to start profiling, 0 to stop and print the report\n\
+  * limit - how many scripts and triggers to list, defaults to 20\n\
+\n\
+**Return value:** N/A"
+);
+static PyObject* GemRB_ProfileScripts(PyObject * /*self*/, PyObject * args)
+{
+	int enable;
+	int limit = 20;
+	PARSE_ARGS( args,  "i|i", &enable, &limit );
+
+	if (!enable && ScriptProfiler::IsEnabled()) {
+		ScriptProfiler::Dump(std::max(limit, 1));
+	}
+	ScriptProfiler::Enable(enable);
+	Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR( GemRB_ProfileFrames__doc,
+"===== ProfileFrames =====\n\
+\n\
+**Prototype:** GemRB.ProfileFrames (enable[, overlay, budget])\n\
+\n\
+**Description:** Starts or stops timing the parts of each frame (game loop, \n\
+scripts, fog, map and window drawing, pathfinding and python callbacks). \n\
+The last frames are kept for the overlay and SaveFrameTrace. Has no effect \n\
+if GemRB was built without USE_PROFILER.\n\
+\n\
+**Parameters:**\n\
+  * enable - 1 to start profiling, 0 to stop\n\
+  * overlay - 1 to show the averages and a frame time graph on screen\n\
+  * budget - frames taking longer (in ms) are logged with their breakdown, \n\
+    0 disables it; defaults to the FrameBudget setting\n\
+\n\
+**Return value:** N/A\n\
+\n\
+**See also:** [SaveFrameTrace](SaveFrameTrace.md)"
+);
+static PyObject* GemRB_ProfileFrames(PyObject * /*self*/, PyObject * args)
+{
+	int enable;
+	int overlay = 0;
+	int budget = core->config.FrameBudget;
+	PARSE_ARGS( args,  "i|ii", &enable, &overlay, &budget );
+
+	FrameProfiler::Enable(enable);
+	FrameProfiler::SetBudget(budget);
+	core->config.DrawProfile = enable && overlay;
+	Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR( GemRB_SaveFrameTrace__doc,
+"===== SaveFrameTrace =====\n\
+\n\
+**Prototype:** GemRB.SaveFrameTrace (path)\n\
+\n\
+**Description:** Writes the frames kept by the frame profiler to a file in \n\
+the Chrome trace event format, which chrome://tracing and Perfetto can show.\n\
+\n\
+**Parameters:**\n\
+  * path - the file to write\n\
+\n\
+**Return value:** bool, true if the trace was written\n\
+\n\
+**See also:** [ProfileFrames](ProfileFrames.md)"
+);
+static PyObject* GemRB_SaveFrameTrace(PyObject * /*self*/, PyObject * args)
+{
+	const char* path;
+	PARSE_ARGS( args,  "s", &path );
+
+	return PyBool_FromLong(FrameProfiler::ExportTrace(path));
+}
+
 PyDoc_STRVAR( GemRB_DumpActor__doc,
 "===== DumpActor =====\n\
 \n\
@@ -12996,6 +13573,91 @@ static PyObject* GemRB_AddGameTypeHint(PyObject* /*self*/, PyObject* args)
 }
 
 
+#ifdef USE_BENCHMARKS
+PyDoc_STRVAR( GemRB_GetAreaLoadTimes__doc,
+"===== GetAreaLoadTimes =====\n\
+\n\
+**Prototype:** GemRB.GetAreaLoadTimes ()\n\
+\n\
+**Description:** Returns how long each area load took this game, from the \n\
+start of loading until the area was ready to be played. Useful to check \n\
+the effect of the area prefetcher (see AreaPrefetchBudget in GemRB.cfg).\n\
+\n\
+**Return value:** dict, area resrefs mapped to a list of load times in milliseconds"
+);
+
+static PyObject* GemRB_GetAreaLoadTimes(PyObject* /*self*/, PyObject* /*args*/)
+{
+	GET_GAME();
+
+	PyObject* times = PyDict_New();
+	for (const auto& area : game->GetAreaLoadTimes()) {
+		PyObject* list = PyList_New(0);
+		for (double ms : area.second) {
+			PyList_Append(list, DecRef(PyFloat_FromDouble, ms));
+		}
+		PyDict_SetItem(times, DecRef(PyString_FromResRef, area.first), list);
+		Py_DecRef(list);
+	}
+	return times;
+}
+
+PyDoc_STRVAR( GemRB_GetTileCacheStats__doc,
+"===== GetTileCacheStats =====\n\
+\n\
+**Prototype:** GemRB.GetTileCacheStats ()\n\
+\n\
+**Description:** Returns how much memory the decoded area tiles take, to help \n\
+sizing TileCacheBudget in GemRB.cfg. Tiles are only decoded once they're drawn.\n\
+\n\
+**Return value:** dict with the keys:\n\
+  * ResidentBytes - pixel data of all decoded tiles\n\
+  * ResidentTiles - number of decoded tiles\n\
+  * StreamBytes - tileset files held in memory to decode tiles from\n\
+  * Palettes - number of distinct tile palettes, 1kB each\n\
+  * Budget - the configured cap in bytes, 0 if unlimited\n\
+  * Loads - how many times tiles were decoded\n\
+  * Evictions - how many times tiles were dropped again"
+);
+
+static PyObject* GemRB_GetTileCacheStats(PyObject* /*self*/, PyObject* /*args*/)
+{
+	const TileOverlay::CacheStats& stats = TileOverlay::GetCacheStats();
+	return Py_BuildValue("{s:n,s:n,s:n,s:n,s:n,s:n,s:n}",
+		"ResidentBytes", Py_ssize_t(stats.residentBytes), "ResidentTiles", Py_ssize_t(stats.residentTiles),
+		"StreamBytes", Py_ssize_t(stats.streamBytes),
+		"Palettes", Py_ssize_t(stats.palettes), "Budget", Py_ssize_t(stats.budget),
+		"Loads", Py_ssize_t(stats.loads), "Evictions", Py_ssize_t(stats.evictions));
+}
+
+PyDoc_STRVAR( GemRB_GetVisualEffectStats__doc,
+"===== GetVisualEffectStats =====\n\
+\n\
+**Prototype:** GemRB.GetVisualEffectStats ()\n\
+\n\
+**Description:** Returns how often the spell and effect animations (VVC, VEF \n\
+and BAM) could be copied from an already parsed template instead of being read again.\n\
+\n\
+**Return value:** dict with the keys:\n\
+  * Hits - animations copied from a template\n\
+  * Misses - animations that had to be parsed\n\
+  * Templates - number of templates kept\n\
+  * Allocations - animation objects created\n\
+  * Reuses - how many of those reused pooled memory"
+);
+
+static PyObject* GemRB_GetVisualEffectStats(PyObject* /*self*/, PyObject* /*args*/)
+{
+	GameData::VisualEffectStats stats = gamedata->GetVisualEffectStats();
+	const auto& pool = ObjectPool<ScriptedAnimation>::Get().GetStats();
+	return Py_BuildValue("{s:n,s:n,s:n,s:n,s:n}",
+		"Hits", Py_ssize_t(stats.hits), "Misses", Py_ssize_t(stats.misses),
+		"Templates", Py_ssize_t(stats.templates), "Allocations", Py_ssize_t(pool.allocations),
+		"Reuses", Py_ssize_t(pool.reuses));
+}
+
+#endif
+
 PyDoc_STRVAR( GemRB_GetAreaInfo__doc,
 "GetAreaInfo()=>mapping\n\n"
 "Returns important values about the current area.\n");
@@ -13116,12 +13778,25 @@ static PyMethodDef GemRBMethods[] = {
 	METHOD(AddNewArea, METH_VARARGS),
 	METHOD(ApplyEffect, METH_VARARGS),
 	METHOD(ApplySpell, METH_VARARGS),
+#ifdef USE_BENCHMARKS
+	METHOD(BenchmarkActorQueries, METH_VARARGS),
+	METHOD(BenchmarkBlitters, METH_VARARGS),
+	METHOD(BenchmarkLoaders, METH_VARARGS),
+	METHOD(BenchmarkParticles, METH_VARARGS),
+	METHOD(BenchmarkPartyMove, METH_VARARGS),
+	METHOD(BenchmarkPartyRefresh, METH_VARARGS),
+	METHOD(BenchmarkPathfinding, METH_VARARGS),
+	METHOD(BenchmarkSoundDecoding, METH_VARARGS),
+#endif
 	METHOD(CanUseItemType, METH_VARARGS),
 	METHOD(ChangeContainerItem, METH_VARARGS),
 	METHOD(ChangeItemFlag, METH_VARARGS),
 	METHOD(ChangeStoreItem, METH_VARARGS),
 	METHOD(ChargeSpells, METH_VARARGS),
 	METHOD(CheckFeatCondition, METH_VARARGS),
+#ifdef USE_BENCHMARKS
+	METHOD(CheckSoundDecoding, METH_VARARGS),
+#endif
 	METHOD(CheckSpecialSpell, METH_VARARGS),
 	METHOD(CheckVar, METH_VARARGS),
 	METHOD(ClearActions, METH_VARARGS),
@@ -13178,6 +13853,9 @@ static PyMethodDef GemRBMethods[] = {
 	METHOD(GameSetScreenFlags, METH_VARARGS),
 	METHOD(GameSwapPCs, METH_VARARGS),
 	METHOD(GetAreaInfo, METH_NOARGS),
+#ifdef USE_BENCHMARKS
+	METHOD(GetAreaLoadTimes, METH_NOARGS),
+#endif
 	METHOD(GetAvatarsValue, METH_VARARGS),
 	METHOD(GetAbilityBonus, METH_VARARGS),
 	METHOD(GetCombatDetails, METH_VARARGS),
@@ -13236,9 +13914,15 @@ static PyMethodDef GemRBMethods[] = {
 	METHOD(GetSlotItem, METH_VARARGS),
 	METHOD(GetSlots, METH_VARARGS),
 	METHOD(GetSystemVariable, METH_VARARGS),
+#ifdef USE_BENCHMARKS
+	METHOD(GetTileCacheStats, METH_NOARGS),
+#endif
 	METHOD(GetToken, METH_VARARGS),
 	METHOD(GetVar, METH_VARARGS),
 	METHOD(GetView, METH_VARARGS),
+#ifdef USE_BENCHMARKS
+	METHOD(GetVisualEffectStats, METH_NOARGS),
+#endif
 	METHOD(HardEndPL, METH_NOARGS),
 	METHOD(HasFeat, METH_VARARGS),
 	METHOD(HasResource, METH_VARARGS),
@@ -13267,6 +13951,8 @@ static PyMethodDef GemRBMethods[] = {
 	METHOD(PlaySound, METH_VARARGS),
 	METHOD(PlayMovie, METH_VARARGS),
 	METHOD(PrepareSpontaneousCast, METH_VARARGS),
+	METHOD(ProfileFrames, METH_VARARGS),
+	METHOD(ProfileScripts, METH_VARARGS),
 	METHOD(RemoveItem, METH_VARARGS),
 	METHOD(RemoveSpell, METH_VARARGS),
 	METHOD(RemoveEffects, METH_VARARGS),
@@ -13277,6 +13963,7 @@ static PyMethodDef GemRBMethods[] = {
 	METHOD(SaveCharacter, METH_VARARGS),
 	METHOD(SaveGame, METH_VARARGS),
 	METHOD(SaveConfig, METH_NOARGS),
+	METHOD(SaveFrameTrace, METH_VARARGS),
 	METHOD(SetDefaultActions, METH_VARARGS),
 	METHOD(SetEquippedQuickSlot, METH_VARARGS),
 	METHOD(SetFeat, METH_VARARGS),
@@ -13690,7 +14377,11 @@ PyObject *GUIScript::RunFunction(const char* moduleName, const char* functionNam
 		Py_DECREF(pyModule);
 		return NULL;
 	}
-	PyObject *pValue = PyObject_CallObject( pFunc, pArgs );
+	PyObject *pValue;
+	{
+		PROFILE_SCOPE(Python);
+		pValue = PyObject_CallObject( pFunc, pArgs );
+	}
 	if (pValue == NULL) {
 		if (PyErr_Occurred()) {
 			PyErr_Print();
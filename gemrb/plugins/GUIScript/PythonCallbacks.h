@@ -23,6 +23,7 @@
 #include "GUIScript.h"
 
 #include "Callback.h"
+#include "FrameProfiler.h"
 #include "Interface.h"
 
 #include "GUI/Control.h"
@@ -43,7 +44,11 @@ bool CallPython(PyObject* function, PyObject* args = NULL, R* retVal = NULL)
 		return false;
 	}
 
-	PyObject *ret = PyObject_CallObject(function, args);
+	PyObject *ret;
+	{
+		PROFILE_SCOPE(Python);
+		ret = PyObject_CallObject(function, args);
+	}
 	Py_XDECREF( args );
 	if (ret == NULL) {
 		if (PyErr_Occurred()) {
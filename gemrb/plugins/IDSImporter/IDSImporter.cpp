@@ -23,7 +23,9 @@
 #include "IDSImporterDefs.h"
 
 #include "globals.h"
+#include "Strings/StringConversion.h"
 
+#include <algorithm>
 #include <cstring>
 
 using namespace GemRB;
@@ -77,27 +79,44 @@ bool IDSImporter::Open(DataStream* str)
 	}
 
 	delete str;
+	BuildIndex();
 	return true;
 }
 
+// the script compiler looks up symbols all the time, so avoid the scans
+void IDSImporter::BuildIndex()
+{
+	int count = static_cast<int>(pairs.size());
+	sortedPairs.resize(count);
+	for (int i = 0; i < count; i++) {
+		sortedPairs[i] = i;
+		valueByString.emplace(pairs[i].str, pairs[i].val);
+		firstByValue.emplace(pairs[i].val, i);
+		lastByValue[pairs[i].val] = i;
+	}
+	std::stable_sort(sortedPairs.begin(), sortedPairs.end(), [this](int a, int b) {
+		return strcmp(pairs[a].str, pairs[b].str) < 0;
+	});
+}
+
 int IDSImporter::GetValue(const char* txt) const
 {
-	for (const auto pair : pairs) {
-		if (stricmp(pair.str, txt) == 0) {
-			return pair.val;
-		}
+	std::string key(txt);
+	StringToLower(key);
+	auto it = valueByString.find(key);
+	if (it == valueByString.end()) {
+		return -1;
 	}
-	return -1;
+	return it->second;
 }
 
 char* IDSImporter::GetValue(int val) const
 {
-	for (const auto pair : pairs) {
-		if (pair.val == val) {
-			return pair.str;
-		}
+	auto it = firstByValue.find(val);
+	if (it == firstByValue.end()) {
+		return NULL;
 	}
-	return NULL;
+	return pairs[it->second].str;
 }
 
 char* IDSImporter::GetStringIndex(size_t Index) const
@@ -116,26 +135,39 @@ int IDSImporter::GetValueIndex(size_t Index) const
 	return pairs[Index].val;
 }
 
+// returns the last entry starting with the first len characters of str
 int IDSImporter::FindString(const char *str, int len) const
 {
-	int i = static_cast<int>(pairs.size());
-	while(i--) {
-		if (strnicmp(pairs[i].str, str, len) == 0) {
-			return i;
-		}
+	if (len <= 0) {
+		return static_cast<int>(pairs.size()) - 1;
+	}
+
+	std::string key(str, strnlen(str, len));
+	StringToLower(key);
+	// a shorter str has to match the whole entry
+	bool whole = key.length() < size_t(len);
+
+	// all the entries with this prefix are next to each other in sortedPairs
+	auto it = std::lower_bound(sortedPairs.begin(), sortedPairs.end(), key, [this](int idx, const std::string& k) {
+		return strcmp(pairs[idx].str, k.c_str()) < 0;
+	});
+	int found = -1;
+	for (; it != sortedPairs.end(); ++it) {
+		const char* entry = pairs[*it].str;
+		if (strncmp(entry, key.c_str(), key.length()) != 0) break;
+		if (whole && entry[key.length()]) continue;
+		found = std::max(found, *it);
 	}
-	return -1;
+	return found;
 }
 
 int IDSImporter::FindValue(int val) const
 {
-	int i = static_cast<int>(pairs.size());
-	while(i--) {
-		if(pairs[i].val==val) {
-			return i;
-		}
+	auto it = lastByValue.find(val);
+	if (it == lastByValue.end()) {
+		return -1;
 	}
-	return -1;
+	return it->second;
 }
 
 int IDSImporter::GetHighestValue() const
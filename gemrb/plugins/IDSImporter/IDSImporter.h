@@ -23,6 +23,8 @@
 
 #include "SymbolMgr.h"
 
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace GemRB {
@@ -37,6 +39,14 @@ private:
 	std::vector< Pair> pairs;
 	std::vector< char*> ptrs;
 
+	// lookup indices, built once the file is read; the strings are lowercase
+	std::vector<int> sortedPairs; // pair indices in string order, for prefix searches
+	std::unordered_map<std::string, int> valueByString; // first match wins
+	std::unordered_map<int, int> firstByValue;
+	std::unordered_map<int, int> lastByValue;
+
+	void BuildIndex();
+
 public:
 	IDSImporter() noexcept = default;
 	IDSImporter(const IDSImporter&) = delete;
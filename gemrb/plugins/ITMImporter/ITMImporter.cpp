@@ -25,6 +25,7 @@
 #include "PluginMgr.h"
 #include "SymbolMgr.h"
 #include "TableMgr.h" //needed for autotable
+#include "Streams/RecordLayout.h"
 
 #include <map>
 
@@ -277,43 +278,47 @@ Item* ITMImporter::GetItem(Item *s)
 #define IT_DAGGER     0x10
 #define IT_SHORTSWORD 0x13
 
+// the runs of the 56 byte extended header that are read as they are
+using ExtHeaderUseLayout = RecordLayout<ITMExtHeader,
+	RECORD_FIELD(ITMExtHeader, AttackType), RECORD_FIELD(ITMExtHeader, IDReq),
+	RECORD_FIELD(ITMExtHeader, Location), RECORD_FIELD(ITMExtHeader, AltDiceSides),
+	RECORD_FIELD(ITMExtHeader, UseIcon), RECORD_FIELD(ITMExtHeader, Target)>;
+using ExtHeaderDamageLayout = RecordLayout<ITMExtHeader,
+	RECORD_FIELD(ITMExtHeader, AltDiceThrown), RECORD_FIELD(ITMExtHeader, Speed),
+	RECORD_FIELD(ITMExtHeader, AltDamageBonus), RECORD_FIELD(ITMExtHeader, THAC0Bonus),
+	RECORD_FIELD(ITMExtHeader, DiceSides), RECORD_FIELD(ITMExtHeader, DiceThrown),
+	RECORD_FIELD(ITMExtHeader, DamageBonus), RECORD_FIELD(ITMExtHeader, DamageType)>;
+using ExtHeaderChargesLayout = RecordLayout<ITMExtHeader,
+	RECORD_FIELD(ITMExtHeader, FeatureOffset), RECORD_FIELD(ITMExtHeader, Charges),
+	RECORD_FIELD(ITMExtHeader, ChargeDepletion), RECORD_FIELD(ITMExtHeader, RechargeFlags),
+	RECORD_FIELD(ITMExtHeader, ProjectileAnimation), RECORD_FIELD(ITMExtHeader, MeleeAnimation)>;
+static const size_t ExtHeaderSize = ExtHeaderUseLayout::Size + 4 + ExtHeaderDamageLayout::Size + 2 + ExtHeaderChargesLayout::Size + 6;
+static_assert(ExtHeaderSize == 56, "ITM extended headers are 56 bytes");
+
 void ITMImporter::GetExtHeader(const Item *s, ITMExtHeader* eh)
 {
-	ieByte tmpByte;
-	ieWord ProjectileType;
-
-	str->Read( &eh->AttackType,1 );
-	str->Read( &eh->IDReq,1 );
-	str->Read( &eh->Location,1 );
-	str->Read(&eh->AltDiceSides, 1);
-	str->ReadResRef( eh->UseIcon );
-	str->Read( &eh->Target,1 );
-	str->Read( &tmpByte,1 );
+	RecordBytes<ExtHeaderSize> bytes(str);
+	if (!bytes) {
+		Log(ERROR, "ITMImporter", "Truncated extended header in {}!", s->Name);
+		return;
+	}
+	RecordCursor cursor = bytes.Cursor();
+
+	ExtHeaderUseLayout::Decode(cursor, *eh);
+	ieByte tmpByte = cursor.Take<ieByte>();
 	if (!tmpByte) {
 		tmpByte = 1;
 	}
 	eh->TargetNumber = tmpByte;
-	str->ReadWord(eh->Range);
-	str->Read(&ProjectileType, 1);
-	str->Read(&eh->AltDiceThrown, 1);
-	str->Read(&eh->Speed, 1);
-	str->Read(&eh->AltDamageBonus, 1);
-	str->ReadWord(eh->THAC0Bonus);
-	str->ReadWord(eh->DiceSides);
-	str->ReadWord(eh->DiceThrown);
-	str->ReadScalar<ieWordSigned>(eh->DamageBonus);
-	str->ReadWord(eh->DamageType);
-	ieWord featureCount;
-	str->ReadWord(featureCount);
-	str->ReadWord(eh->FeatureOffset);
-	str->ReadWord(eh->Charges);
-	str->ReadWord(eh->ChargeDepletion);
-	str->ReadDword(eh->RechargeFlags);
+	eh->Range = cursor.Take<ieWord>();
+	ieByte ProjectileType = cursor.Take<ieByte>();
+	ExtHeaderDamageLayout::Decode(cursor, *eh);
+	ieWord featureCount = cursor.Take<ieWord>();
+	ExtHeaderChargesLayout::Decode(cursor, *eh);
 
 	//hack for default weapon finesse
 	if (s->ItemType==IT_DAGGER || s->ItemType==IT_SHORTSWORD) eh->RechargeFlags^=IE_ITEM_USEDEXTERITY;
 
-	str->ReadWord(eh->ProjectileAnimation);
 	//for some odd reasons 0 and 1 are the same
 	if (eh->ProjectileAnimation) {
 		eh->ProjectileAnimation--;
@@ -324,18 +329,10 @@ void ITMImporter::GetExtHeader(const Item *s, ITMExtHeader* eh)
 		eh->ProjectileAnimation = 78;
 	}
 
-	for (unsigned short& i : eh->MeleeAnimation) {
-		str->ReadWord(i);
-	}
-
-	ieWord tmp;
 	ieDword pq = 0;
-	str->ReadWord(tmp); //arrow
-	if (tmp) pq |= PROJ_ARROW;
-	str->ReadWord(tmp); //xbow
-	if (tmp) pq |= PROJ_BOLT;
-	str->ReadWord(tmp); //bullet
-	if (tmp) pq |= PROJ_BULLET;
+	if (cursor.Take<ieWord>()) pq |= PROJ_ARROW;
+	if (cursor.Take<ieWord>()) pq |= PROJ_BOLT; // xbow
+	if (cursor.Take<ieWord>()) pq |= PROJ_BULLET;
 	//this hack is required for Nordom's crossbow in PST
 	if (!pq && (eh->AttackType == ITEM_AT_BOW)) {
 		pq |= PROJ_BOLT;
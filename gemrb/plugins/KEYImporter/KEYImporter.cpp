@@ -24,6 +24,7 @@
 
 #include "Interface.h"
 #include "ResourceDesc.h"
+#include "Streams/FileCache.h"
 #include "Streams/FileStream.h"
 
 using namespace GemRB;
@@ -94,6 +95,16 @@ static void FindBIF(BIFEntry *entry)
 	Log(ERROR, "KEYImporter", "Cannot find {}...", entry->name);
 }
 
+KEYImporter::~KEYImporter()
+{
+	stopWarmer = true;
+	if (warmer.joinable()) {
+		warmer.join();
+	}
+	Log(DEBUG, "KEYImporter", "{} BIF archives were open, {} resource lookups reused an open one.",
+		openArchives.load(), archiveHits.load());
+}
+
 bool KEYImporter::Open(const char *resfile, const char *desc)
 {
 	description = desc;
@@ -154,7 +165,7 @@ bool KEYImporter::Open(const char *resfile, const char *desc)
 				be.name[p] = PathDelimiter;
 		}
 		FindBIF(&be);
-		biffiles.push_back( be );
+		biffiles.push_back(std::move(be));
 	}
 	f->Seek( ResOffset, GEM_STREAM_START );
 
@@ -177,9 +188,51 @@ bool KEYImporter::Open(const char *resfile, const char *desc)
 
 	Log(MESSAGE, "KEYImporter", "Resources Loaded...");
 	delete f;
+
+	std::vector<std::string> paths;
+	for (const BIFEntry& bif : biffiles) {
+		if (bif.found) {
+			paths.emplace_back(bif.path);
+		}
+	}
+	// the plugins are created here, so the thread doesn't have to touch the plugin manager
+	if (!core->IsAvailable(PLUGIN_COMPRESSION_ZLIB)) {
+		return true;
+	}
+	PluginHolder<IndexedArchive> archive = MakePluginHolder<IndexedArchive>(IE_BIF_CLASS_ID);
+	PluginHolder<Compressor> comp = MakePluginHolder<Compressor>(PLUGIN_COMPRESSION_ZLIB);
+	warmer = std::thread(&KEYImporter::WarmUpCache, this, std::move(paths), std::move(archive), std::move(comp));
 	return true;
 }
 
+// Compressed archives are inflated into the cache on first use, which can
+// take seconds, so do it for all of them ahead of time. InflateToCache goes
+// through FileCache::Ensure, so archives already cached are skipped and the
+// main thread asking for the same one just waits for it.
+void KEYImporter::WarmUpCache(std::vector<std::string> paths, PluginHolder<IndexedArchive> archive, PluginHolder<Compressor> comp) const
+{
+	unsigned int cached = 0;
+	for (const std::string& path : paths) {
+		if (stopWarmer) break;
+
+		FileStream* file = FileStream::OpenFile(path.c_str());
+		if (!file) continue;
+		char Signature[8];
+		bool compressed = file->Read(Signature, 8) == 8 && strncmp(Signature, "BIFFV1  ", 8) != 0;
+		delete file;
+		if (!compressed) continue;
+
+		char filename[_MAX_PATH];
+		ExtractFileFromPath(filename, path.c_str());
+		char cachePath[_MAX_PATH];
+		PathJoin(cachePath, core->config.CachePath, filename, nullptr);
+		if (archive->InflateToCache(path.c_str(), cachePath, *comp, stopWarmer) == GEM_OK) {
+			cached++;
+		}
+	}
+	Log(MESSAGE, "KEYImporter", "Cache warm-up done, {} compressed archives cached.", cached);
+}
+
 bool KEYImporter::HasResource(const char* resname, SClass_ID type)
 {
 	return resources.has(ResRef(resname), type);
@@ -190,6 +243,24 @@ bool KEYImporter::HasResource(const char* resname, const ResourceDesc &type)
 	return HasResource(resname, type.GetKeyType());
 }
 
+// opening an archive means reading its whole entry table, so do it only once
+IndexedArchive* KEYImporter::GetArchive(BIFEntry& bif)
+{
+	if (bif.archive) {
+		archiveHits++;
+		return bif.archive.get();
+	}
+	PluginHolder<IndexedArchive> ai = MakePluginHolder<IndexedArchive>(IE_BIF_CLASS_ID);
+	if (ai->OpenArchive(bif.path) == GEM_ERROR) {
+		Log(ERROR, "KEYImporter", "Cannot open archive {}", bif.path);
+		return nullptr;
+	}
+
+	bif.archive = std::move(ai);
+	openArchives++;
+	return bif.archive.get();
+}
+
 DataStream* KEYImporter::GetStream(const ResRef& resname, ieWord type)
 {
 	if (type == 0)
@@ -201,15 +272,16 @@ DataStream* KEYImporter::GetStream(const ResRef& resname, ieWord type)
 
 	unsigned int bifnum = ( *ResLocator & 0xFFF00000 ) >> 20;
 
-	if (!biffiles[bifnum].found) {
+	BIFEntry& bif = biffiles[bifnum];
+	if (!bif.found) {
 		Log(ERROR, "KEYImporter", "Cannot find {}... Resource unavailable.",
-				biffiles[bifnum].name.c_str());
+				bif.name.c_str());
 		return NULL;
 	}
 
-	PluginHolder<IndexedArchive> ai = MakePluginHolder<IndexedArchive>(IE_BIF_CLASS_ID);
-	if (ai->OpenArchive( biffiles[bifnum].path ) == GEM_ERROR) {
-		Log(ERROR, "KEYImporter", "Cannot open archive {}", biffiles[bifnum].path);
+	std::lock_guard<std::mutex> lock(*bif.lock);
+	IndexedArchive* ai = GetArchive(bif);
+	if (!ai) {
 		return NULL;
 	}
 
@@ -21,6 +21,7 @@
 #ifndef KEYIMP_H
 #define KEYIMP_H
 
+#include "Compressor.h"
 #include "ResourceSource.h"
 
 #include "Plugins/IndexedArchive.h"
@@ -28,6 +29,11 @@
 #include "Resource.h"
 #include "StringMap.h"
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
 
 namespace GemRB {
@@ -41,13 +47,11 @@ struct BIFEntry {
 	char path[_MAX_PATH];
 	int cd;
 	bool found;
-};
-
-struct KEYCache {
-	KEYCache() { bifnum = 0xffffffff; }
-
-	unsigned int bifnum;
-	PluginHolder<IndexedArchive> plugin;
+	// kept open for the whole session once the first resource was requested
+	PluginHolder<IndexedArchive> archive;
+	// guards opening and reading the archive, which the area prefetcher
+	// does from its own thread; inflating one doesn't hold up the others
+	std::unique_ptr<std::mutex> lock { new std::mutex };
 };
 
 // the key for this specific hashmap
@@ -129,10 +133,22 @@ class KEYImporter : public ResourceSource {
 private:
 	std::vector< BIFEntry> biffiles;
 	KEYImpMap resources;
-
+	// archive handle statistics
+	std::atomic<unsigned int> openArchives { 0 };
+	std::atomic<unsigned int> archiveHits { 0 };
+	// inflates the compressed archives into the cache in the background
+	std::thread warmer;
+	std::atomic<bool> stopWarmer { false };
+
+	IndexedArchive* GetArchive(BIFEntry& bif);
+	void WarmUpCache(std::vector<std::string> paths, PluginHolder<IndexedArchive> archive, PluginHolder<Compressor> comp) const;
 	/** Gets the stream assoicated to a RESKey */
 	DataStream *GetStream(const ResRef&, ieWord type);
 public:
+	KEYImporter() noexcept = default;
+	KEYImporter(const KEYImporter&) = delete;
+	~KEYImporter() override;
+	KEYImporter& operator=(const KEYImporter&) = delete;
 	bool Open(const char *file, const char *desc) override;
 	/* predicts the availability of a resource */
 	bool HasResource(const char* resname, SClass_ID type) override;
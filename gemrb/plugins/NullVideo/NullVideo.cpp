@@ -0,0 +1,61 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#include "NullVideo.h"
+
+using namespace GemRB;
+
+namespace {
+
+class NullVideoBuffer : public VideoBuffer {
+public:
+	explicit NullVideoBuffer(const Region& r) : VideoBuffer(r) {}
+
+	void Clear(const Region&) override {}
+	void CopyPixels(const Region&, const void*, const int*, ...) override {}
+	bool RenderOnDisplay(void*) const override { return false; }
+};
+
+}
+
+Holder<Sprite2D> NullVideoDriver::CreateSprite(const Region& rgn, void* pixels, const PixelFormat& fmt)
+{
+	return MakeHolder<Sprite2D>(rgn, pixels, fmt);
+}
+
+Holder<Sprite2D> NullVideoDriver::GetScreenshot(Region r, const VideoBufferPtr&)
+{
+	// a black one, so saving a game still gets its previews
+	Region rgn(0, 0, r.w ? r.w : screenSize.w, r.h ? r.h : screenSize.h);
+	void* pixels = calloc(rgn.w * rgn.h, 4);
+	static const PixelFormat fmt(4, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000);
+	return MakeHolder<Sprite2D>(rgn, pixels, fmt);
+}
+
+VideoBuffer* NullVideoDriver::NewVideoBuffer(const Region& rgn, BufferFormat)
+{
+	return new NullVideoBuffer(rgn);
+}
+
+#include "plugindef.h"
+
+GEMRB_PLUGIN(0x4A8C3E1, "Null Video Driver")
+PLUGIN_DRIVER(NullVideoDriver, "none")
+END_PLUGIN()
@@ -0,0 +1,74 @@
+/* GemRB - Infinity Engine Emulator
+ * Copyright (C) 2023 The GemRB Project
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef NULLVIDEO_H
+#define NULLVIDEO_H
+
+#include "Video/Video.h"
+
+namespace GemRB {
+
+// A video driver that draws nothing and has no window, for running
+// without a display (benchmarks, automated tests). Sprites are still
+// created in memory, since the rest of the engine reads their pixels.
+class NullVideoDriver : public Video {
+public:
+	int Init() override { return GEM_OK; }
+	void SetWindowTitle(const char*) override {}
+	bool SetFullscreenMode(bool) override { return false; }
+	bool ToggleGrabInput() override { return false; }
+	void CaptureMouse(bool) override {}
+
+	void StartTextInput() override {}
+	void StopTextInput() override {}
+	bool InTextInput() override { return false; }
+	bool TouchInputEnabled() override { return false; }
+
+	Holder<Sprite2D> CreateSprite(const Region&, void* pixels, const PixelFormat&) override;
+	void BlitSprite(const Holder<Sprite2D>&, const Region&, Region, BlitFlags, Color) override {}
+	void BlitGameSprite(const Holder<Sprite2D>&, const Point&, BlitFlags, Color) override {}
+	void BlitVideoBuffer(const VideoBufferPtr&, const Point&, BlitFlags, Color) override {}
+	Holder<Sprite2D> GetScreenshot(Region r, const VideoBufferPtr& buf = nullptr) override;
+	void SetGamma(int, int) override {}
+
+protected:
+	void Wait(uint32_t) override {}
+
+private:
+	VideoBuffer* NewVideoBuffer(const Region&, BufferFormat) override;
+	void SwapBuffers(VideoBuffers&) override {}
+	int PollEvents() override { return GEM_OK; }
+	int CreateDriverDisplay(const char*) override { return GEM_OK; }
+
+	void DrawRectImp(const Region&, const Color&, bool, BlitFlags) override {}
+	void DrawPointImp(const Point&, const Color&, BlitFlags) override {}
+	void DrawPointsImp(const std::vector<Point>&, const Color&, BlitFlags) override {}
+	void DrawCircleImp(const Point&, unsigned short, const Color&, BlitFlags) override {}
+	void DrawEllipseSegmentImp(const Point&, unsigned short, unsigned short, const Color&,
+							   double, double, bool, BlitFlags) override {}
+	void DrawPolygonImp(const Gem_Polygon*, const Point&, const Color&, bool, BlitFlags) override {}
+	void DrawLineImp(const Point&, const Point&, const Color&, BlitFlags) override {}
+	void DrawLinesImp(const std::vector<Point>&, const Color&, BlitFlags) override {}
+	void DrawLineSegmentsImp(const std::vector<Point>&, const Color&, BlitFlags) override {}
+};
+
+}
+
+#endif
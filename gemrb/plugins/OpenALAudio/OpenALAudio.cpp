@@ -22,6 +22,7 @@
 
 #include "GameData.h"
 #include "Interface.h"
+#include "Strings/StringConversion.h"
 
 #include <cassert>
 #include <cstdio>
@@ -243,6 +244,9 @@ bool OpenALAudioDriver::Init(void)
 		Log(MESSAGE, "OpenAL", "EFX not available.");
 	}
 
+	cacheBudget = size_t(std::max(core->config.SoundCacheBudget, 1)) * 1024 * 1024;
+	decoder = make_unique<SoundDecoder>(SOUND_DECODERS);
+
 	ambim = new AmbientMgr;
 	speech.free = true;
 	speech.ambient = false;
@@ -340,6 +344,15 @@ OpenALAudioDriver::~OpenALAudioDriver(void)
 	
 	// AmigaOS4 should be built with -athread=native or this may not work
 	musicThread.join();
+	// the ambient thread can still be loading sounds, so it has to go before the decoder
+	delete ambim;
+	ambim = nullptr;
+	// drop the queued preloads, finishing the ones in progress
+	{
+		std::lock_guard<std::mutex> lock(bufferMutex);
+		preloads.clear();
+	}
+	decoder = nullptr;
 
 	for(int i =0; i<num_streams; i++) {
 		streams[i].ForceClear();
@@ -367,70 +380,180 @@ OpenALAudioDriver::~OpenALAudioDriver(void)
 	alutContext = NULL;
 
 	free(music_memory);
-
-	delete ambim;
 }
 
-ALuint OpenALAudioDriver::loadSound(const char *ResRef, tick_t &time_length)
+SoundDecoder::SoundDecoder(unsigned int workerCount)
 {
-	ALuint Buffer = 0;
-
-	CacheEntry *e;
-	void* p;
+	for (unsigned int i = 0; i < workerCount; ++i) {
+		workers.emplace_back(&SoundDecoder::Run, this);
+	}
+}
 
-	if (!ResRef[0]) {
-		return 0;
+SoundDecoder::~SoundDecoder()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+		tasks.clear();
 	}
-	if(buffercache.Lookup(ResRef, p))
+	wakeUp.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+SoundDecoder::Request SoundDecoder::Decode(const std::string& name)
+{
+	std::promise<DecodedSound> result;
+	Request request = result.get_future().share();
 	{
-		e = (CacheEntry*) p;
-		time_length = e->Length;
-		return e->Buffer;
+		std::lock_guard<std::mutex> lock(mutex);
+		tasks.push_back({ name, std::move(result) });
 	}
+	wakeUp.notify_one();
+	return request;
+}
 
-	//no cache entry...
-	alGenBuffers(1, &Buffer);
-	if (checkALError("Unable to create sound buffer", ERROR)) {
-		return 0;
+void SoundDecoder::Run()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		wakeUp.wait(lock, [this]() { return stopping || !tasks.empty(); });
+		if (stopping) return;
+
+		Task task = std::move(tasks.front());
+		tasks.pop_front();
+		lock.unlock();
+		task.result.set_value(DecodeNow(task.name));
+		lock.lock();
 	}
+}
 
-	ResourceHolder<SoundMgr> acm = GetResourceHolder<SoundMgr>(ResRef);
+DecodedSound SoundDecoder::DecodeNow(const std::string& name)
+{
+	DecodedSound sound;
+	ResourceHolder<SoundMgr> acm = GetResourceHolder<SoundMgr>(name.c_str());
 	if (!acm) {
-		alDeleteBuffers( 1, &Buffer );
-		checkALError("Unable to delete buffer!", ERROR);
-		return 0;
+		return sound;
 	}
+
 	int cnt = acm->get_length();
-	unsigned int riff_chans = acm->get_channels();
-	int samplerate = acm->get_samplerate();
-	//multiply always by 2 because it is in 16 bits
-	int rawsize = cnt * 2;
-	short* memory = (short*) malloc(rawsize);
-	//multiply always with 2 because it is in 16 bits
-	unsigned int cnt1 = acm->read_samples( memory, cnt ) * 2;
-	//Sound Length in milliseconds
-	time_length = ((cnt / riff_chans) * 1000) / samplerate;
+	sound.channels = acm->get_channels();
+	sound.samplerate = acm->get_samplerate();
 	//it is always reading the stuff into 16 bits
-	alBufferData( Buffer, GetFormatEnum( riff_chans, 16 ), memory, cnt1, samplerate );
-	free(memory);
+	sound.samples.resize(cnt);
+	sound.samples.resize(acm->read_samples(sound.samples.data(), cnt));
+	//Sound Length in milliseconds
+	sound.length = ((cnt / sound.channels) * 1000) / sound.samplerate;
+	return sound;
+}
 
+// both expect bufferMutex to be held
+ALuint OpenALAudioDriver::cacheSound(const std::string& key, const DecodedSound& sound, tick_t &time_length)
+{
+	if (sound.samples.empty()) {
+		return 0;
+	}
+
+	ALuint Buffer = 0;
+	alGenBuffers(1, &Buffer);
+	if (checkALError("Unable to create sound buffer", ERROR)) {
+		return 0;
+	}
+
+	size_t size = sound.samples.size() * sizeof(short);
+	alBufferData(Buffer, GetFormatEnum(sound.channels, 16), sound.samples.data(), ALsizei(size), sound.samplerate);
 	if (checkALError("Unable to fill buffer", ERROR)) {
 		alDeleteBuffers( 1, &Buffer );
 		checkALError("Error deleting buffer", WARNING);
 		return 0;
 	}
 
-	e = new CacheEntry;
-	e->Buffer = Buffer;
-	e->Length = time_length;
+	// make room first, so the new buffer is never the one to go
+	while (cachedBytes + size > cacheBudget && evictBuffer()) {}
 
-	buffercache.SetAt(ResRef, (void*)e);
-	//print("LoadSound: added %s to cache: %d. Cache size now %d", ResRef, e->Buffer, buffercache.GetCount());
+	bufferLRU.push_front(key);
+	buffercache[key] = { Buffer, sound.length, size, bufferLRU.begin() };
+	cachedBytes += size;
+	time_length = sound.length;
+	return Buffer;
+}
 
-	if (buffercache.GetCount() > BUFFER_CACHE_SIZE) {
-		evictBuffer();
+void OpenALAudioDriver::uploadPreloads()
+{
+	auto it = preloads.begin();
+	while (it != preloads.end()) {
+		if (it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			++it;
+			continue;
+		}
+		tick_t time_length;
+		if (!buffercache.count(it->first)) {
+			cacheSound(it->first, it->second.get(), time_length);
+		}
+		it = preloads.erase(it);
+	}
+}
+
+ALuint OpenALAudioDriver::loadSound(const char *ResRef, tick_t &time_length)
+{
+	if (!ResRef[0]) {
+		return 0;
+	}
+
+	std::string key = ResRef;
+	StringToLower(key);
+
+	std::unique_lock<std::mutex> lock(bufferMutex);
+	uploadPreloads();
+	auto cached = buffercache.find(key);
+	if (cached != buffercache.end()) {
+		const CacheEntry& e = cached->second;
+		bufferLRU.splice(bufferLRU.begin(), bufferLRU, e.lru);
+		time_length = e.Length;
+		return e.Buffer;
+	}
+
+	// still being preloaded, it's at least partly done already
+	SoundDecoder::Request request;
+	auto preload = preloads.find(key);
+	if (preload != preloads.end()) {
+		request = preload->second;
+		preloads.erase(preload);
+	}
+
+	// don't keep the other threads waiting while decoding
+	lock.unlock();
+	DecodedSound sound = request.valid() ? request.get() : SoundDecoder::DecodeNow(key);
+	lock.lock();
+
+	// somebody else may have been quicker
+	cached = buffercache.find(key);
+	if (cached != buffercache.end()) {
+		time_length = cached->second.Length;
+		return cached->second.Buffer;
+	}
+	return cacheSound(key, sound, time_length);
+}
+
+void OpenALAudioDriver::Preload(const std::vector<std::string>& sounds)
+{
+	if (!decoder) return;
+
+	std::lock_guard<std::mutex> lock(bufferMutex);
+	// the finished ones go into the cache, where they count against the budget
+	uploadPreloads();
+	// the callers rank the sounds, so the cut drops the least likely ones
+	for (std::string key : sounds) {
+		if (preloads.size() >= MAX_PRELOADS) {
+			break;
+		}
+		StringToLower(key);
+		if (key.empty() || buffercache.count(key) || preloads.count(key)) {
+			continue;
+		}
+		preloads[key] = decoder->Decode(key);
 	}
-	return Buffer;
 }
 
 Holder<SoundHandle> OpenALAudioDriver::Play(const char* ResRef, unsigned int channel, const Point& p,
@@ -817,48 +940,36 @@ bool OpenALAudioDriver::evictBuffer()
 {
 	// Note: this function assumes the caller holds bufferMutex
 
-	// Room for optimization: this is O(n^2) in the number of buffers
-	// at the tail that are used. It can be O(n) if LRUCache supports it.
-
-	unsigned int n = 0;
-	void* p;
-	const char* k;
-	bool res;
-
-	while ((res = buffercache.getLRU(n, k, p)) == true) {
-		CacheEntry* e = (CacheEntry*)p;
-		alDeleteBuffers(1, &e->Buffer);
+	// buffers still attached to a source can't be deleted; they're
+	// playing, so they go to the front of the list and are skipped once
+	for (size_t tries = bufferLRU.size(); tries > 0; --tries) {
+		auto e = buffercache.find(bufferLRU.back());
+		alDeleteBuffers(1, &e->second.Buffer);
 		if (alGetError() == AL_NO_ERROR) {
-			// Buffer was unused. An error would have indicated
-			// the buffer was still attached to a source.
-
-			delete e;
-			buffercache.Remove(k);
-
-			//print("Removed buffer %s from ACMImp cache", k);
-			break;
+			cachedBytes -= e->second.Size;
+			buffercache.erase(e);
+			bufferLRU.pop_back();
+			return true;
 		}
-		++n;
+		bufferLRU.splice(bufferLRU.begin(), bufferLRU, std::prev(bufferLRU.end()));
 	}
 
-	return res;
+	return false;
 }
 
 void OpenALAudioDriver::clearBufferCache(bool force)
 {
-	// Room for optimization: any method of iterating over the buffers
-	// would suffice. It doesn't have to be in LRU-order.
-	void* p;
-	const char* k;
-	int n = 0;
-	while (buffercache.getLRU(n, k, p)) {
-		CacheEntry* e = (CacheEntry*)p;
-		alDeleteBuffers(1, &e->Buffer);
+	std::lock_guard<std::mutex> lock(bufferMutex);
+	auto it = buffercache.begin();
+	while (it != buffercache.end()) {
+		alDeleteBuffers(1, &it->second.Buffer);
 		if (force || alGetError() == AL_NO_ERROR) {
-			delete e;
-			buffercache.Remove(k);
-		} else
-			++n;
+			cachedBytes -= it->second.Size;
+			bufferLRU.erase(it->second.lru);
+			it = buffercache.erase(it);
+		} else {
+			++it;
+		}
 	}
 }
 
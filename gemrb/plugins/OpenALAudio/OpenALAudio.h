@@ -27,14 +27,21 @@
 
 #include "ie_types.h"
 
-#include "LRUCache.h"
 #include "MusicMgr.h"
 #include "SoundMgr.h"
 #include "Streams/FileStream.h"
 #include "MapReverb.h"
 
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <list>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 #if __APPLE__
 #include <OpenAL/OpenAL.h> // umbrella include for all the headers we want
@@ -47,7 +54,9 @@
 #endif
 
 #define RETRY 5
-#define BUFFER_CACHE_SIZE 100
+#define SOUND_DECODERS 2
+// decoded preloads wait outside the cache budget until they're uploaded, so only this many at once
+#define MAX_PRELOADS 32
 #define MAX_STREAMS 30
 #define MUSICBUFFERS 10
 #define REFERENCE_DISTANCE 50
@@ -91,6 +100,44 @@ struct AudioStream {
 struct CacheEntry {
 	ALuint Buffer;
 	tick_t Length;
+	size_t Size;
+	std::list<std::string>::iterator lru;
+};
+
+struct DecodedSound {
+	std::vector<short> samples;
+	int channels = 0;
+	int samplerate = 0;
+	tick_t length = 0;
+};
+
+// decodes sounds on worker threads, so preloading them doesn't stall the game
+class SoundDecoder {
+public:
+	using Request = std::shared_future<DecodedSound>;
+
+	explicit SoundDecoder(unsigned int workerCount);
+	SoundDecoder(const SoundDecoder&) = delete;
+	~SoundDecoder();
+	SoundDecoder& operator=(const SoundDecoder&) = delete;
+
+	Request Decode(const std::string& name);
+	// decodes on the calling thread
+	static DecodedSound DecodeNow(const std::string& name);
+
+private:
+	struct Task {
+		std::string name;
+		std::promise<DecodedSound> result;
+	};
+
+	std::deque<Task> tasks;
+	std::mutex mutex;
+	std::condition_variable wakeUp;
+	bool stopping = false;
+	std::vector<std::thread> workers;
+
+	void Run();
 };
 
 class OpenALAudioDriver : public Audio {
@@ -122,6 +169,7 @@ public:
 				int channels, short* memory,
 				int size, int samplerate) override;
 	void UpdateMapAmbient(MapReverb&) override;
+	void Preload(const std::vector<std::string>& sounds) override;
 private:
 	int QueueALBuffer(ALuint source, ALuint buffer) const;
 
@@ -132,7 +180,15 @@ private:
 	std::recursive_mutex musicMutex;
 	ALuint MusicBuffer[MUSICBUFFERS]{};
 	std::shared_ptr<SoundMgr> MusicReader;
-	LRUCache buffercache;
+	// sounds are uploaded to buffers on first use; the ambient thread
+	// plays sounds too, so the cache needs guarding
+	std::mutex bufferMutex;
+	std::unordered_map<std::string, CacheEntry> buffercache;
+	std::list<std::string> bufferLRU; // most recently used first
+	size_t cachedBytes = 0;
+	size_t cacheBudget = 0;
+	std::unordered_map<std::string, SoundDecoder::Request> preloads;
+	std::unique_ptr<SoundDecoder> decoder;
 	AudioStream speech;
 	AudioStream streams[MAX_STREAMS];
 	int num_streams = 0;
@@ -148,6 +204,8 @@ private:
 	MapReverbProperties reverbProperties;
 
 	ALuint loadSound(const char* ResRef, tick_t &time_length);
+	ALuint cacheSound(const std::string& key, const DecodedSound& sound, tick_t &time_length);
+	void uploadPreloads();
 	int CountAvailableSources(int limit);
 	bool evictBuffer();
 	void clearBufferCache(bool force);
@@ -23,6 +23,9 @@
 
 #include "Video/Pixels.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace GemRB {
 
 using SDLPixelIterator = PixelFormatIterator;
@@ -87,11 +90,95 @@ inline SDLPixelIteratorWrapper MakeSDLPixelIterator(SDL_Surface* surf, const Reg
 	return SDLPixelIteratorWrapper(surf, IPixelIterator::Direction::Forward, IPixelIterator::Direction::Forward, clip);
 }
 
+// the first row of the iterator's clip, in its iteration order
+inline uint8_t* SpanRow(const SDLPixelIterator& it, int row)
+{
+	int y = (it.ydir == IPixelIterator::Forward) ? row : it.clip.h - 1 - row;
+	uint8_t* px = static_cast<uint8_t*>(it.pixel) + (it.clip.y + y) * it.pitch + it.clip.x * it.format.Bpp;
+	if (it.xdir == IPixelIterator::Reverse) {
+		px += (it.clip.w - 1) * it.format.Bpp;
+	}
+	return px;
+}
+
+inline bool AtSpanStart(const SDLPixelIterator& it)
+{
+	const Point& pos = it.Position();
+	return pos.x == (it.xdir == IPixelIterator::Forward ? 0 : it.clip.w - 1)
+		&& pos.y == (it.ydir == IPixelIterator::Forward ? 0 : it.clip.h - 1);
+}
+
+// Does the whole blit row by row with the span blitters, either from src or
+// with a fill color. Returns false if the formats or the blender aren't
+// supported and the caller has to go pixel by pixel.
+template<class BLENDER>
+static bool BlitSpans(const SDLPixelIterator* src, const Color* fill,
+				 const SDLPixelIterator& dst, const BLENDER& blender)
+{
+	SpanPipeline pipeline;
+	if (!blender.GetSpanPipeline(pipeline)) return false;
+	if (!SpanLayoutForFormat(dst.format, pipeline.layout)) return false;
+	if (dst.xdir == IPixelIterator::Reverse || !AtSpanStart(dst)) return false;
+
+	int width = dst.clip.w;
+	int height = dst.clip.h;
+	// not worth the setup
+	if (width * height < 16) return false;
+
+	SpanLayout srcLayout;
+	bool direct = false;
+	if (src) {
+		const PixelFormat& fmt = src->format;
+		if (fmt.RLE || src->clip.w != width || src->clip.h != height || !AtSpanStart(*src)) return false;
+		if (fmt.Bpp == 1) {
+			if (!fmt.palette) return false;
+		} else if (!SpanLayoutForFormat(fmt, srcLayout)) {
+			return false;
+		}
+		// blitting onto itself only works if every pixel is read before it's written
+		if (src->pixel == dst.pixel && (src->clip != dst.clip || src->xdir != dst.xdir || src->ydir != dst.ydir)) return false;
+		// without alpha the source has to be converted, since BlendSpan reads it
+		direct = fmt.Bpp == 4 && srcLayout.hasAlpha && srcLayout == pipeline.layout && src->xdir == IPixelIterator::Forward;
+	}
+
+	std::vector<uint32_t> row;
+	if (!direct) {
+		row.resize(width);
+	}
+	if (fill) {
+		std::fill(row.begin(), row.end(), SpanPixel(*fill, pipeline.layout));
+	}
+
+	for (int y = 0; y < height; ++y) {
+		uint32_t* dstRow = reinterpret_cast<uint32_t*>(SpanRow(dst, y));
+		const uint32_t* srcRow = row.data();
+		if (direct) {
+			srcRow = reinterpret_cast<const uint32_t*>(SpanRow(*src, y));
+		} else if (src) {
+			const PixelFormat& fmt = src->format;
+			int step = src->xdir;
+			if (fmt.Bpp == 1) {
+				bool keyed = fmt.HasColorKey && fmt.ColorKey < 256;
+				ExpandPaletteSpan(SpanRow(*src, y), step, fmt.palette->col, row.data(), width, pipeline.layout, keyed, uint8_t(fmt.ColorKey));
+			} else {
+				const uint32_t* px = reinterpret_cast<const uint32_t*>(SpanRow(*src, y));
+				ConvertSpan(px, step, srcLayout, row.data(), width, pipeline.layout, fmt.HasColorKey, fmt.ColorKey);
+			}
+		}
+		BlendSpan(srcRow, dstRow, width, pipeline);
+	}
+	return true;
+}
+
 template<class BLENDER>
 static void ColorFill(const Color& c,
 				 SDLPixelIterator dst, const SDLPixelIterator& dstend,
 				 const BLENDER& blender)
 {
+	if (BlitSpans(nullptr, &c, dst, blender)) {
+		return;
+	}
+
 	for (; dst != dstend; ++dst) {
 		Color dstc;
 		dst.ReadRGBA(dstc.r, dstc.g, dstc.b, dstc.a);
@@ -108,6 +195,12 @@ static void Blit(SDLPixelIterator src,
 				 IAlphaIterator& mask,
 				 const BLENDER& blender)
 {
+	// the span blitters can't apply a mask
+	const StaticAlphaIterator* noMask = dynamic_cast<const StaticAlphaIterator*>(&mask);
+	if (noMask && noMask->alpha == 0 && BlitSpans(&src, nullptr, dst, blender)) {
+		return;
+	}
+
 	for (; dst != dstend; ++dst, ++src, ++mask) {
 		Color srcc, dstc;
 		src.ReadRGBA(srcc.r, srcc.g, srcc.b, srcc.a);
@@ -104,6 +104,10 @@ struct SRTinter_FlagsNoTint {
 	}
 };
 
+// for palettes that were already run through one of the tinters above
+struct SRTinter_Pretinted {
+	void operator()(Uint8&, Uint8&, Uint8&, Uint8&, unsigned int) const {}
+};
 
 struct SRBlender_NoAlpha { };
 struct SRBlender_HalfAlpha { };
@@ -359,14 +363,23 @@ static void BlitSpriteRLE(Holder<Sprite2D> spr, const Region& srect,
 		cover = &nomask;
 	}
 
+	// the tint only depends on the palette entry and the flags,
+	// so do it once per color instead of once per pixel
+	Color pal[256];
+	for (int i = 0; i < 256; ++i) {
+		pal[i] = palette->col[i];
+		tint(pal[i].r, pal[i].g, pal[i].b, pal[i].a, flags);
+	}
+	const SRTinter_Pretinted pretinted;
+
 	switch (dstit.format.Bpp) {
 		case 4:
 		{
 			SRBlender<Uint32, Blender> blend(dstit.format);
 			if (partial) {
-				BlitSpriteRLE_Partial<Uint32>(rledata, spr->Frame.w, srect, palette->col, ck, dstit, *cover, flags, tint, blend);
+				BlitSpriteRLE_Partial<Uint32>(rledata, spr->Frame.w, srect, pal, ck, dstit, *cover, flags, pretinted, blend);
 			} else {
-				BlitSpriteRLE_Total<Uint32>(rledata, palette->col, ck, dstit, *cover, flags, tint, blend);
+				BlitSpriteRLE_Total<Uint32>(rledata, pal, ck, dstit, *cover, flags, pretinted, blend);
 			}
 			break;
 		}
@@ -374,9 +387,9 @@ static void BlitSpriteRLE(Holder<Sprite2D> spr, const Region& srect,
 		{
 			SRBlender<Uint16, Blender> blend(dstit.format);
 			if (partial) {
-				BlitSpriteRLE_Partial<Uint16>(rledata, spr->Frame.w, srect, palette->col, ck, dstit, *cover, flags, tint, blend);
+				BlitSpriteRLE_Partial<Uint16>(rledata, spr->Frame.w, srect, pal, ck, dstit, *cover, flags, pretinted, blend);
 			} else {
-				BlitSpriteRLE_Total<Uint16>(rledata, palette->col, ck, dstit, *cover, flags, tint, blend);
+				BlitSpriteRLE_Total<Uint16>(rledata, pal, ck, dstit, *cover, flags, pretinted, blend);
 			}
 			break;
 		}
@@ -24,6 +24,9 @@
 #include "Video/RLE.h"
 #include "SDLPixelIterator.h"
 
+#include <algorithm>
+#include <cstdlib>
+
 using namespace GemRB;
 
 SDLVideoDriver::~SDLVideoDriver(void)
@@ -319,6 +322,30 @@ void SDLVideoDriver::DrawCircleImp(const Point& c, unsigned short r, const Color
 	DrawSDLPoints(points, reinterpret_cast<const SDL_Color&>(color), flags);
 }
 
+/** Draws unconnected line segments as one batch of points */
+void SDLVideoDriver::DrawLineSegmentsImp(const std::vector<Point>& segments, const Color& color, BlitFlags flags)
+{
+	// SDL can only batch connected lines, but the segments are short, so all their
+	// pixels go out in a single call instead of a call per segment
+	static std::vector<SDL_Point> points;
+	points.clear();
+
+	for (size_t i = 0; i + 1 < segments.size(); i += 2) {
+		const Point& start = segments[i];
+		const Point& end = segments[i + 1];
+		int dx = end.x - start.x;
+		int dy = end.y - start.y;
+		int steps = std::max(std::abs(dx), std::abs(dy));
+		for (int step = 0; step <= steps; step++) {
+			int x = start.x + (steps ? dx * step / steps : 0);
+			int y = start.y + (steps ? dy * step / steps : 0);
+			SetPixel( drawingBuffer, x, y );
+		}
+	}
+
+	DrawSDLPoints(points, reinterpret_cast<const SDL_Color&>(color), flags);
+}
+
 static double ellipseradius(unsigned short xr, unsigned short yr, double angle) {
 	double one = (xr * sin(angle));
 	double two = (yr * cos(angle));
@@ -107,6 +107,7 @@ private:
 	virtual void DrawSDLPoints(const std::vector<SDL_Point>& points, const SDL_Color& color, BlitFlags flags = BlitFlags::NONE)=0;
 
 	void DrawCircleImp(const Point& origin, unsigned short r, const Color& color, BlitFlags flags) override;
+	void DrawLineSegmentsImp(const std::vector<Point>& points, const Color& color, BlitFlags flags) override;
 	void DrawEllipseSegmentImp(const Point& origin, unsigned short xr, unsigned short yr, const Color& color,
 							   double anglefrom, double angleto, bool drawlines, BlitFlags flags) override;
 public:
@@ -24,6 +24,7 @@
 #include "Interface.h"
 #include "PluginMgr.h"
 #include "TableMgr.h" //needed for autotable
+#include "Streams/RecordLayout.h"
 
 using namespace GemRB;
 
@@ -185,17 +186,33 @@ Spell* SPLImporter::GetSpell(Spell *s, bool /*silent*/)
 	return s;
 }
 
+// the runs of the 40 byte extended header that are read as they are
+using ExtHeaderFormLayout = RecordLayout<SPLExtHeader,
+	RECORD_FIELD(SPLExtHeader, SpellForm),
+	RECORD_FIELD(SPLExtHeader, Hostile), //this byte is used in PST
+	RECORD_FIELD(SPLExtHeader, Location), RECORD_FIELD(SPLExtHeader, unknown2),
+	RECORD_FIELD(SPLExtHeader, memorisedIcon), RECORD_FIELD(SPLExtHeader, Target)>;
+using ExtHeaderDamageLayout = RecordLayout<SPLExtHeader,
+	RECORD_FIELD(SPLExtHeader, Range), RECORD_FIELD(SPLExtHeader, RequiredLevel),
+	RECORD_FIELD(SPLExtHeader, CastingTime), RECORD_FIELD(SPLExtHeader, DiceSides),
+	RECORD_FIELD(SPLExtHeader, DiceThrown), RECORD_FIELD(SPLExtHeader, DamageBonus),
+	RECORD_FIELD(SPLExtHeader, DamageType)>;
+using ExtHeaderChargesLayout = RecordLayout<SPLExtHeader,
+	RECORD_FIELD(SPLExtHeader, FeatureOffset), RECORD_FIELD(SPLExtHeader, Charges),
+	RECORD_FIELD(SPLExtHeader, ChargeDepletion), RECORD_FIELD(SPLExtHeader, ProjectileAnimation)>;
+static const size_t ExtHeaderSize = ExtHeaderFormLayout::Size + 1 + ExtHeaderDamageLayout::Size + 2 + ExtHeaderChargesLayout::Size;
+static_assert(ExtHeaderSize == 40, "SPL extended headers are 40 bytes");
+
 void SPLImporter::GetExtHeader(const Spell *s, SPLExtHeader* eh)
 {
-	ieByte tmpByte;
+	RecordBytes<ExtHeaderSize> bytes(str);
+	if (!bytes) {
+		Log(ERROR, "SPLImporter", "Truncated extended header in {}!", s->Name);
+		return;
+	}
+	RecordCursor cursor = bytes.Cursor();
 
-	str->Read( &eh->SpellForm, 1 );
-	//this byte is used in PST
-	str->Read( &eh->Hostile, 1 );
-	str->Read( &eh->Location, 1 );
-	str->Read( &eh->unknown2, 1 );
-	str->ReadResRef(eh->memorisedIcon);
-	str->Read( &eh->Target, 1 );
+	ExtHeaderFormLayout::Decode(cursor, *eh);
 
 	//this hack is to let gemrb target dead actors by some spells
 	if (eh->Target == 1) {
@@ -203,24 +220,14 @@ void SPLImporter::GetExtHeader(const Spell *s, SPLExtHeader* eh)
 			eh->Target = 3;
 		}
 	}
-	str->Read( &tmpByte,1 );
+	ieByte tmpByte = cursor.Take<ieByte>();
 	if (!tmpByte) {
 		tmpByte = 1;
 	}
 	eh->TargetNumber = tmpByte;
-	str->ReadWord(eh->Range);
-	str->ReadWord(eh->RequiredLevel);
-	str->ReadDword(eh->CastingTime);
-	str->ReadWord(eh->DiceSides);
-	str->ReadWord(eh->DiceThrown);
-	str->ReadWord(eh->DamageBonus);
-	str->ReadWord(eh->DamageType);
-	ieWord featureCount;
-	str->ReadWord(featureCount);
-	str->ReadWord(eh->FeatureOffset);
-	str->ReadWord(eh->Charges);
-	str->ReadWord(eh->ChargeDepletion);
-	str->ReadWord(eh->ProjectileAnimation);
+	ExtHeaderDamageLayout::Decode(cursor, *eh);
+	ieWord featureCount = cursor.Take<ieWord>();
+	ExtHeaderChargesLayout::Decode(cursor, *eh);
 
 	//for some odd reasons 0 and 1 are the same
 	if (eh->ProjectileAnimation) {
@@ -24,6 +24,7 @@
 
 #include "Interface.h"
 #include "Sprite2D.h"
+#include "Streams/MemoryStream.h"
 #include "Video/Video.h"
 
 using namespace GemRB;
@@ -58,37 +59,46 @@ bool TISImporter::Open(DataStream* stream)
 	return true;
 }
 
-Tile* TISImporter::GetTile(const std::vector<ieWord>& indexes,
-						   unsigned short* secondary)
+// memory streams hold the whole file, like the ones of the area prefetcher,
+// while the archive slices read from the (mapped) BIF
+size_t TISImporter::GetStreamMemory() const
 {
-	size_t count = indexes.size();
-	std::vector<Animation::frame_t> frames;
-	frames.reserve(count);
-	for (size_t i = 0; i < count; i++) {
-		frames.push_back(GetTile(indexes[i]));
+	return dynamic_cast<const MemoryStream*>(str) ? str->Size() : 0;
+}
+
+void TISImporter::Close()
+{
+	delete str;
+	str = nullptr;
+}
+
+const TISImporter::SharedPalette& TISImporter::GetPalette(const Color (&colors)[256], colorkey_t colorKey)
+{
+	// FNV-1a
+	size_t hash = 2166136261U;
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(colors);
+	for (size_t i = 0; i < sizeof(colors); ++i) {
+		hash = (hash ^ bytes[i]) * 16777619U;
 	}
-	
-	Animation ani = Animation(std::move(frames));
-	//pause key stops animation
-	ani.gameAnimation = true;
-	//the turning crystal in ar3202 (bg1) requires animations to be synced
-	ani.frameIdx = 0;
-	
-	if (secondary) {
-		frames.clear();
-		for (size_t i = 0; i < count; i++) {
-			frames.push_back(GetTile(secondary[i]));
+
+	std::vector<SharedPalette>& bucket = palettes[hash];
+	for (const SharedPalette& shared : bucket) {
+		if (shared.colorKey == colorKey && memcmp(shared.pal->col, colors, sizeof(colors)) == 0) {
+			return shared;
 		}
-		Animation sec = Animation(frames);
-		return new Tile(ani, sec);
 	}
-	return new Tile(ani);
+
+	PaletteHolder pal = MakeHolder<Palette>();
+	std::copy(std::begin(colors), std::end(colors), pal->col);
+	bucket.push_back({ pal, colorKey });
+	paletteCount++;
+	return bucket.back();
 }
 
 Holder<Sprite2D> TISImporter::GetTile(int index)
 {
 	strpos_t pos = index *(1024+4096) + headerShift;
-	if (str->Size() < pos + 1024 + 4096) {
+	if (!str || str->Size() < pos + 1024 + 4096) {
 		// original PS:T AR0609 and AR0612 report far more tiles than are actually present :(
 		
 		if (badTile == nullptr) {
@@ -108,8 +118,7 @@ Holder<Sprite2D> TISImporter::GetTile(int index)
 		return badTile;
 	}
 	
-	PaletteHolder pal = MakeHolder<Palette>();
-	PixelFormat fmt = PixelFormat::Paletted8Bit(pal);
+	Color colors[256];
 	colorkey_t ck = 0;
 	
 	auto ckTest = [](const Color& c) {
@@ -118,16 +127,18 @@ Holder<Sprite2D> TISImporter::GetTile(int index)
 	};
 
 	str->Seek( pos, GEM_STREAM_START );
-	str->Read(pal->col, 1024);
-	for (Color& c : pal->col) {
+	str->Read(colors, 1024);
+	for (Color& c : colors) {
 		std::swap(c.b, c.r); // argb format
 		c.a = c.a ? c.a : 255; // alpha is unused by the originals but SDL will happily use it
 		if (ck == 0 && ckTest(c)) {
 			c = ColorGreen;
-			ck = colorkey_t(&c - pal->col);
+			ck = colorkey_t(&c - colors);
 		}
 	}
 	
+	const PaletteHolder& pal = GetPalette(colors, ck).pal;
+	PixelFormat fmt = PixelFormat::Paletted8Bit(pal);
 	fmt.ColorKey = ck;
 	fmt.HasColorKey = pal->col[ck] == ColorGreen;
 
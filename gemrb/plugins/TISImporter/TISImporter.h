@@ -21,8 +21,12 @@
 #ifndef TISIMPORTER_H
 #define TISIMPORTER_H
 
+#include "Palette.h"
 #include "Plugins/TileSetMgr.h"
 
+#include <unordered_map>
+#include <vector>
+
 namespace GemRB {
 
 class TISImporter : public TileSetMgr {
@@ -34,16 +38,27 @@ private:
 	ieDword TileSize = 0;
 	
 	Holder<Sprite2D> badTile; // blank tile to use to fill in bad data
+
+	struct SharedPalette {
+		PaletteHolder pal;
+		colorkey_t colorKey;
+	};
+	// most tiles of a tileset use one of a handful of palettes, so they're
+	// shared; keyed by a hash of the (fixed up) colors
+	std::unordered_map<size_t, std::vector<SharedPalette>> palettes;
+	size_t paletteCount = 0;
+
+	const SharedPalette& GetPalette(const Color (&colors)[256], colorkey_t colorKey);
 public:
 	TISImporter() noexcept = default;
 	TISImporter(const TISImporter&) = delete;
 	~TISImporter() override;
 	TISImporter& operator=(const TISImporter&) = delete;
 	bool Open(DataStream* stream) override;
-	Tile* GetTile(const std::vector<ieWord>& indexes,
-		unsigned short* secondary = NULL) override;
-	Holder<Sprite2D> GetTile(int index);
-public:
+	Holder<Sprite2D> GetTile(int index) override;
+	size_t GetPaletteCount() const override { return paletteCount; }
+	size_t GetStreamMemory() const override;
+	void Close() override;
 };
 
 }
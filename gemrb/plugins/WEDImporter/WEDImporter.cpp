@@ -116,7 +116,8 @@ int WEDImporter::AddOverlay(TileMap* tm, const Overlay* newOverlays, bool rain)
 	}
 	PluginHolder<TileSetMgr> tis = MakePluginHolder<TileSetMgr>(IE_TIS_CLASS_ID);
 	tis->Open( tisfile );
-	auto over = MakeHolder<TileOverlay>(Size(newOverlays->Width, newOverlays->Height));
+	// the tiles are only decoded once they're drawn
+	auto over = MakeHolder<TileOverlay>(Size(newOverlays->Width, newOverlays->Height), std::move(tis), res);
 	for (int y = 0; y < newOverlays->Height; y++) {
 		for (int x = 0; x < newOverlays->Width; x++) {
 			str->Seek(newOverlays->TilemapOffset + (y * newOverlays->Width + x) * 10, GEM_STREAM_START);
@@ -136,18 +137,15 @@ int WEDImporter::AddOverlay(TileMap* tm, const Overlay* newOverlays, bool rain)
 			std::vector<ieWord> indices(count);
 			str->Read(&indices[0], count * sizeof(ieWord));
 
-			Tile* tile;
-			if (secondary == 0xffff) {
-				tile = tis->GetTile(indices);
-			} else {
-				tile = tis->GetTile(indices, &secondary);
-				tile->GetAnimation(1)->fps = animspeed;
+			// the secondary (door or blending mask) tile is never animated
+			std::vector<ieWord> secondaries;
+			if (secondary != 0xffff) {
+				secondaries.push_back(secondary);
 			}
-			tile->GetAnimation(0)->fps = animspeed;
-			tile->om = overlaymask;
+			Tile tile(std::move(indices), std::move(secondaries), animspeed);
+			tile.om = overlaymask;
 			usedoverlays |= overlaymask;
-			over->AddTile(std::move(*tile));
-			delete tile;
+			over->AddTile(std::move(tile));
 		}
 	}
 	